@@ -0,0 +1,18 @@
+# 合成设备群数据生成工具：生成可复现的大数据量数据库
+QT = core sql concurrent
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = FleetGenerator
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(databasecore.pri)
+
+SOURCES += \
+    src/fleetgen_main.cpp \
+    src/fleetgenerator.cpp
+
+HEADERS += \
+    include/fleetgenerator.h
@@ -0,0 +1,28 @@
+# 无界面的传感器数据采集服务
+QT = core sql network
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = IngestServer
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(databasecore.pri)
+
+SOURCES += \
+    src/ingest_main.cpp \
+    src/ingestserver.cpp \
+    src/sensorprotocol.cpp \
+    src/metricsserver.cpp \
+    src/loginmanager.cpp
+
+HEADERS += \
+    include/ingestserver.h \
+    include/sensorprotocol.h \
+    include/metricsserver.h \
+    include/loginmanager.h
+
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
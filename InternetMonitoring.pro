@@ -1,4 +1,4 @@
-QT       += core gui sql charts
+QT       += core gui sql charts concurrent network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -17,7 +17,6 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
     src/adminwindow.cpp \
-    src/databasemanager.cpp \
     src/databaseviewer.cpp \
     src/forgetpasswordwindow.cpp \
     src/loginmanager.cpp \
@@ -33,12 +32,19 @@ SOURCES += \
     src/AlarmDisplayWindow.cpp \
     src/DataAnalysisWindow.cpp \
     src/UserEditDialog.cpp \
-    src/alarmruleeditdialog.cpp
+    src/alarmruleeditdialog.cpp \
+    src/asyncqueryexecutor.cpp \
+    src/keysettablemodel.cpp \
+    src/sampletablemodel.cpp \
+    src/chartdownsampler.cpp \
+    src/realtimechart.cpp \
+    src/csvexporter.cpp \
+    src/performancepage.cpp \
+    src/metricsserver.cpp
 
 
 HEADERS += \
     include/adminwindow.h \
-    include/databasemanager.h \
     include/databaseviewer.h \
     include/forgetpasswordwindow.h \
     include/loginmanager.h \
@@ -53,7 +59,15 @@ HEADERS += \
     include/AlarmDisplayWindow.h \
     include/DataAnalysisWindow.h \
     include/UserEditDialog.h \
-    include/alarmruleeditdialog.h
+    include/alarmruleeditdialog.h \
+    include/asyncqueryexecutor.h \
+    include/keysettablemodel.h \
+    include/sampletablemodel.h \
+    include/chartdownsampler.h \
+    include/realtimechart.h \
+    include/csvexporter.h \
+    include/performancepage.h \
+    include/metricsserver.h
 
 FORMS += \
     ui/AlarmDisplayPage.ui \
@@ -83,5 +97,19 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 RESOURCES += \
     resources/img/img.qrc
 
+# 导出压缩：gzip 使用系统 zlib（Windows 下需自备，或 CONFIG+=no_zlib 关闭），
+# zstd 需 CONFIG+=zstd 并安装 libzstd
+!no_zlib {
+    DEFINES += HAVE_ZLIB
+    LIBS += -lz
+}
+zstd {
+    DEFINES += HAVE_ZSTD
+    LIBS += -lzstd
+}
+
 # 包含目录
 INCLUDEPATH += include/
+
+# 数据库层（与 IngestServer 共用）
+include(databasecore.pri)
@@ -0,0 +1,20 @@
+# IngestServer 压测工具：模拟多台设备发送数据
+QT = core sql network
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = LoadGenerator
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += include/
+
+SOURCES += \
+    src/loadgen_main.cpp \
+    src/loadgenerator.cpp \
+    src/sensorprotocol.cpp
+
+HEADERS += \
+    include/loadgenerator.h \
+    include/sensorprotocol.h
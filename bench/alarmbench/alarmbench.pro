@@ -0,0 +1,7 @@
+# 告警规则评估压测工具：测量 AlarmRuleEngine::evaluate 每秒的条件求值次数
+include(../bench.pri)
+
+TARGET = AlarmBench
+
+SOURCES += \
+    alarmbench_main.cpp
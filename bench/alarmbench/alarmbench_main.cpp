@@ -0,0 +1,96 @@
+#include "alarmruleengine.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QDebug>
+
+// 告警规则评估压测：不访问数据库，直接对内存中的样本批量调用 AlarmRuleEngine::evaluate，
+// 吞吐按 counters() 统计的条件求值次数计算
+namespace {
+
+struct RuleKind {
+    const char* name;
+    const char* condition;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AlarmBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("测量 AlarmRuleEngine::evaluate 每秒的条件求值次数");
+    parser.addHelpOption();
+    QCommandLineOption devicesOption("devices", "设备数", "n", "1000");
+    QCommandLineOption rulesOption("rules", "每台设备的规则数", "n", "5");
+    QCommandLineOption batchOption("batch", "每次 evaluate 的样本数", "n", "1000");
+    QCommandLineOption durationOption("duration", "每种条件的运行秒数", "sec", "3");
+    parser.addOptions({devicesOption, rulesOption, batchOption, durationOption});
+    parser.process(app);
+
+    const int devices = qMax(1, parser.value(devicesOption).toInt());
+    const int rulesPerDevice = qMax(1, parser.value(rulesOption).toInt());
+    const int batchSize = qMax(1, parser.value(batchOption).toInt());
+    const qint64 durationMs = qMax(1, parser.value(durationOption).toInt()) * 1000LL;
+
+    // 样本在阈值附近波动，规则会反复进入和退出满足状态
+    QVector<MonitorSample> batch;
+    batch.reserve(batchSize);
+    for (int i = 0; i < batchSize; ++i) {
+        MonitorSample sample;
+        sample.device_id = i % devices + 1;
+        sample.timestamp = i * 1000LL;
+        sample.temperature = 25 + (i * 7 % 11) - 5;
+        sample.humidity = 40 + (i * 13 % 41);
+        sample.light = 200 + (i * 31 % 401);
+        batch.append(sample);
+    }
+
+    const RuleKind kinds[] = {
+        { "简单比较", "temperature > 28" },
+        { "复合条件", "temperature > 28 AND humidity < 60 OR NOT (light >= 500)" },
+        { "算术表达式", "(temperature - 20) * 2 + humidity / 10 > light / 50" }
+    };
+    QTextStream out(stdout);
+    out << QString("%1 台设备，每台 %2 条规则，每批 %3 个样本").arg(devices).arg(rulesPerDevice).arg(batchSize) << endl;
+    out << BenchCommon::tableHeader({"条件", "求值 次/秒", "样本 条/秒", "ns/次", "告警数"}, "lrrrr") << endl;
+    for (const RuleKind& kind : kinds) {
+        QVector<CompiledAlarmRule> rules;
+        for (int device = 1; device <= devices; ++device) {
+            for (int r = 0; r < rulesPerDevice; ++r) {
+                CompiledAlarmRule rule;
+                rule.rule_id = rules.size() + 1;
+                rule.device_id = device;
+                rule.description = kind.name;
+                rule.condition = kind.condition;
+                rules.append(rule);
+            }
+        }
+        AlarmRuleEngine engine;
+        QStringList errors;
+        engine.setRules(rules, &errors);
+        if (!errors.isEmpty()) {
+            qCritical() << "规则编译失败:" << errors;
+            return -1;
+        }
+
+        QElapsedTimer clock;
+        clock.start();
+        while (clock.elapsed() < durationMs) {
+            engine.evaluate(batch);
+        }
+        const double seconds = clock.nsecsElapsed() / 1e9;
+        const AlarmRuleEngine::Counters counters = engine.counters();
+        out << QString("| %1 | %2 | %3 | %4 | %5 |")
+               .arg(kind.name)
+               .arg(counters.evaluations / seconds, 0, 'f', 0)
+               .arg(counters.samples / seconds, 0, 'f', 0)
+               .arg(counters.evaluations > 0 ? seconds * 1e9 / counters.evaluations : 0, 0, 'f', 1)
+               .arg(counters.hits) << endl;
+    }
+    return 0;
+}
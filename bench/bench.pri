@@ -0,0 +1,17 @@
+# 压测工具共用：控制台程序设置、数据库层和 common/ 中的辅助函数
+QT = core sql
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include($$PWD/../databasecore.pri)
+
+INCLUDEPATH += $$PWD/common
+
+SOURCES += \
+    $$PWD/common/benchcommon.cpp
+
+HEADERS += \
+    $$PWD/common/benchcommon.h
@@ -0,0 +1,13 @@
+# 压测和检查工具：cd bench && qmake && make，各工具生成在对应的子目录中
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    insertbench \
+    queryplancheck \
+    cursorbench \
+    rollupbench \
+    alarmbench \
+    chunkcodecbench \
+    lttbbench \
+    statementbench \
+    tuningbench
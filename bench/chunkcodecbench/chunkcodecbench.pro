@@ -0,0 +1,7 @@
+# 分块编码压测工具：测量 ChunkCodec 的字节/条和编解码吞吐
+include(../bench.pri)
+
+TARGET = ChunkCodecBench
+
+SOURCES += \
+    chunkcodecbench_main.cpp
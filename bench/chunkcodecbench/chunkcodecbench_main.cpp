@@ -0,0 +1,146 @@
+#include "chunkcodec.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// 分块编码压测：不访问数据库，对几种典型的传感器序列按块编码、解码，
+// 输出每条样本的字节数（原始为 8 字节时间戳 + 3 × 8 字节数值）和编解码吞吐，并校验解码结果与原始数据逐位一致
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+struct Series {
+    const char* name;
+    QVector<MonitorSample> samples;
+};
+
+bool sameBits(double a, double b)
+{
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ChunkCodecBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("测量 ChunkCodec 的压缩率（字节/条）和编解码吞吐");
+    parser.addHelpOption();
+    QCommandLineOption samplesOption("samples", "每种序列的样本数", "n", "1000000");
+    QCommandLineOption chunkOption("chunk", "每块的样本数（每秒一条时一小时为 3600）", "n", "3600");
+    QCommandLineOption intervalOption("interval-ms", "采样间隔（毫秒）", "ms", "1000");
+    QCommandLineOption roundsOption("rounds", "轮数，耗时取中位数", "n", "5");
+    parser.addOptions({samplesOption, chunkOption, intervalOption, roundsOption});
+    parser.process(app);
+
+    const int count = qMax(1, parser.value(samplesOption).toInt());
+    const int chunkSize = qMax(1, parser.value(chunkOption).toInt());
+    const qint64 interval = qMax(1, parser.value(intervalOption).toInt());
+    const int rounds = qMax(1, parser.value(roundsOption).toInt());
+
+    // 平稳：缓慢变化并保留两位小数（常见的传感器精度）；抖动：时间戳有最多 ±20ms 抖动、数值为未取整的噪声；
+    // 恒定：数值长时间不变
+    QVector<Series> series = { { "平稳（两位小数）", {} }, { "抖动 + 噪声", {} }, { "恒定", {} } };
+    QRandomGenerator random(7);
+    // 抖动不超过间隔的一半，时间戳仍保持递增
+    const int jitter = int(qMin<qint64>(20, (interval - 1) / 2));
+    const qint64 firstTs = 1700000000000LL;
+    for (int i = 0; i < count; ++i) {
+        const double phase = i * 2 * pi / 86400.0 * interval / 1000.0;
+        MonitorSample smooth;
+        smooth.device_id = 1;
+        smooth.timestamp = firstTs + i * interval;
+        smooth.temperature = std::round((22 + 5 * std::sin(phase)) * 100) / 100;
+        smooth.humidity = std::round((55 + 10 * std::cos(phase)) * 100) / 100;
+        smooth.light = std::round(std::max(0.0, 800 * std::sin(phase)));
+        series[0].samples.append(smooth);
+
+        MonitorSample noisy = smooth;
+        noisy.timestamp += random.bounded(2 * jitter + 1) - jitter;
+        noisy.temperature = 22 + 5 * std::sin(phase) + random.generateDouble() - 0.5;
+        noisy.humidity = 55 + 10 * std::cos(phase) + random.generateDouble() * 2 - 1;
+        noisy.light = std::max(0.0, 800 * std::sin(phase)) + random.generateDouble() * 10;
+        series[1].samples.append(noisy);
+
+        MonitorSample constant = smooth;
+        constant.temperature = 25;
+        constant.humidity = 50;
+        constant.light = 300;
+        series[2].samples.append(constant);
+    }
+
+    QTextStream out(stdout);
+    out << QString("每种序列 %1 条，每块 %2 条，间隔 %3ms").arg(count).arg(chunkSize).arg(interval) << endl;
+    out << BenchCommon::tableHeader({"序列", "字节/条", "压缩比", "编码 条/秒", "解码 条/秒"}, "lrrrr") << endl;
+    const double rawBytes = 8 + 3 * 8;
+    for (const Series& s : series) {
+        QVector<QByteArray> chunks;
+        QVector<double> encodeMs, decodeMs;
+        for (int round = 0; round < rounds; ++round) {
+            chunks.clear();
+            QElapsedTimer timer;
+            timer.start();
+            for (int offset = 0; offset < count; offset += chunkSize) {
+                chunks.append(ChunkCodec::encode(s.samples.constData() + offset, qMin(chunkSize, count - offset)));
+            }
+            encodeMs.append(timer.nsecsElapsed() / 1e6);
+        }
+        qint64 bytes = 0;
+        for (const QByteArray& chunk : chunks) {
+            bytes += chunk.size();
+        }
+
+        QVector<MonitorSample> decoded;
+        decoded.reserve(chunkSize);
+        for (int round = 0; round < rounds; ++round) {
+            QElapsedTimer timer;
+            timer.start();
+            for (const QByteArray& chunk : chunks) {
+                decoded.clear();
+                if (!ChunkCodec::decode(chunk, 1, decoded)) {
+                    qCritical() << s.name << "解码失败";
+                    return -1;
+                }
+            }
+            decodeMs.append(timer.nsecsElapsed() / 1e6);
+        }
+
+        // 校验：逐块解码并与原始样本逐位比较
+        int index = 0;
+        for (const QByteArray& chunk : chunks) {
+            decoded.clear();
+            ChunkCodec::decode(chunk, 1, decoded);
+            for (const MonitorSample& sample : decoded) {
+                const MonitorSample& original = s.samples.at(index++);
+                if (sample.timestamp != original.timestamp || !sameBits(sample.temperature, original.temperature)
+                    || !sameBits(sample.humidity, original.humidity) || !sameBits(sample.light, original.light)) {
+                    qCritical() << s.name << "第" << index << "条解码结果与原始数据不一致";
+                    return -1;
+                }
+            }
+        }
+        if (index != count) {
+            qCritical() << s.name << "解码条数不符:" << index;
+            return -1;
+        }
+
+        const double perSample = double(bytes) / count;
+        out << QString("| %1 | %2 | %3 | %4 | %5 |")
+               .arg(s.name)
+               .arg(perSample, 0, 'f', 2)
+               .arg(rawBytes / perSample, 0, 'f', 1)
+               .arg(BenchCommon::perSecond(count, BenchCommon::median(encodeMs)), 0, 'f', 0)
+               .arg(BenchCommon::perSecond(count, BenchCommon::median(decodeMs)), 0, 'f', 0) << endl;
+    }
+    return 0;
+}
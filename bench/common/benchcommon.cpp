@@ -0,0 +1,83 @@
+#include "benchcommon.h"
+#include "databasemanager.h"
+#include <QFile>
+#include <algorithm>
+
+namespace BenchCommon
+{
+
+double median(QVector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values.isEmpty() ? 0 : values.at(values.size() / 2);
+}
+
+double perSecond(double count, double ms)
+{
+    return count / qMax(1e-6, ms / 1000);
+}
+
+QVector<int> parseIntList(const QString& text, int minimum)
+{
+    QVector<int> values;
+    for (const QString& value : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const int number = value.trimmed().toInt(&ok);
+        if (ok && number >= minimum) values.append(number);
+    }
+    return values;
+}
+
+QString tableHeader(const QStringList& columns, const QString& alignment)
+{
+    QString separator = "|";
+    for (int i = 0; i < columns.size(); ++i) {
+        separator += alignment.value(i) == 'r' ? "---:|" : "---|";
+    }
+    return "| " + columns.join(" | ") + " |\n" + separator;
+}
+
+void removeDatabase(const QString& path)
+{
+    for (const QString& suffix : {QString(), QString("-wal"), QString("-shm")}) {
+        QFile::remove(path + suffix);
+    }
+}
+
+QCommandLineOption profileOption(const QString& defaultName)
+{
+    return QCommandLineOption("profile", "SQLite 运行参数：" + DatabaseManager::tuningProfileNames().join('/'),
+                              "name", defaultName);
+}
+
+bool openDatabase(const QString& path, const QString& profileName, QString& error)
+{
+    DatabaseManager& database = DatabaseManager::instance();
+    if (!profileName.isEmpty()) {
+        DatabaseManager::TuningProfile profile;
+        if (!DatabaseManager::findTuningProfile(profileName, profile)) {
+            error = "未知的运行参数配置: " + profileName;
+            return false;
+        }
+        database.setTuningProfile(profile);
+    }
+    if (!database.initDatabase(path)) {
+        error = "数据库初始化失败: " + database.lastError();
+        return false;
+    }
+    return true;
+}
+
+bool addDevices(int count, QString& error)
+{
+    DatabaseManager& database = DatabaseManager::instance();
+    for (int i = 0; i < count; ++i) {
+        if (!database.addDevice(QString("bench-%1").arg(i + 1), "传感器", "压测", "", "", "")) {
+            error = "创建设备失败: " + database.lastError();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace BenchCommon
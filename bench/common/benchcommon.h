@@ -0,0 +1,31 @@
+#ifndef BENCHCOMMON_H
+#define BENCHCOMMON_H
+
+#include <QCommandLineOption>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 压测工具共用的辅助函数：结果统计、Markdown 表格和压测数据库的准备
+namespace BenchCommon
+{
+    // 中位数（偶数个时取靠后的一个），空时返回 0
+    double median(QVector<double> values);
+    // 每秒处理的条数，耗时不足 1 微秒时按 1 微秒计
+    double perSecond(double count, double ms);
+    // 逗号分隔的整数列表，小于 minimum 的值被忽略
+    QVector<int> parseIntList(const QString& text, int minimum);
+    // Markdown 表头及分隔行；alignment 每列一个字符，'r' 右对齐，其余左对齐
+    QString tableHeader(const QStringList& columns, const QString& alignment);
+
+    // 删除数据库文件及其 -wal、-shm 文件
+    void removeDatabase(const QString& path);
+    // --profile 选项，说明中列出全部预置的运行参数配置
+    QCommandLineOption profileOption(const QString& defaultName);
+    // 按名称选择运行参数后打开数据库，profileName 为空时使用默认配置；失败时 error 为原因
+    bool openDatabase(const QString& path, const QString& profileName, QString& error);
+    // 创建名为 bench-1 ~ bench-<count> 的设备
+    bool addDevices(int count, QString& error);
+}
+
+#endif // BENCHCOMMON_H
@@ -0,0 +1,7 @@
+# 历史数据读取压测工具：比较 forEachDeviceSample 与 getDeviceData（QVariantList）的耗时和内存增长
+include(../bench.pri)
+
+TARGET = CursorBench
+
+SOURCES += \
+    cursorbench_main.cpp
@@ -0,0 +1,141 @@
+#include "databasemanager.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+#include <QDebug>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+// 历史数据读取压测：forEachDeviceSample 流式回调与 getDeviceData 返回 QVariantList 的耗时和内存占用
+namespace {
+
+// 当前常驻内存（字节），不支持的平台返回 -1
+qint64 residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/statm");
+    if (!file.open(QIODevice::ReadOnly)) return -1;
+    const QList<QByteArray> fields = file.readAll().split(' ');
+    if (fields.size() < 2) return -1;
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+QString megabytes(qint64 bytes)
+{
+    return bytes < 0 ? QString("-") : QString::number(bytes / (1024.0 * 1024.0), 'f', 1);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("CursorBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("比较 forEachDeviceSample 与 getDeviceData 读取同一段原始数据的耗时和内存增长");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "压测使用的数据库文件（运行前删除）", "path", "cursorbench.db");
+    QCommandLineOption rowsOption("rows", "写入并读取的样本数（一台设备）", "n", "1000000");
+    QCommandLineOption roundsOption("rounds", "轮数，耗时取中位数", "n", "5");
+    parser.addOptions({dbOption, rowsOption, roundsOption});
+    parser.process(app);
+
+    const QString path = parser.value(dbOption);
+    const int rows = qMax(1, parser.value(rowsOption).toInt());
+    const int rounds = qMax(1, parser.value(roundsOption).toInt());
+    BenchCommon::removeDatabase(path);
+
+    QString error;
+    if (!BenchCommon::openDatabase(path, "bulk", error) || !BenchCommon::addDevices(1, error)) {
+        qCritical() << error;
+        return -1;
+    }
+    DatabaseManager& database = DatabaseManager::instance();
+    int device_id = -1;
+    if (!database.getDeviceIdByName("bench-1", device_id)) {
+        qCritical() << "找不到压测设备:" << database.lastError();
+        return -1;
+    }
+
+    // 每秒一条，按批写入
+    const qint64 firstTs = QDateTime::currentMSecsSinceEpoch() - qint64(rows) * 1000;
+    QVector<MonitorSample> batch;
+    for (int i = 0; i < rows; ++i) {
+        MonitorSample sample;
+        sample.device_id = device_id;
+        sample.timestamp = firstTs + qint64(i) * 1000;
+        sample.temperature = 20 + i % 100 / 10.0;
+        sample.humidity = 50;
+        sample.light = i % 1000;
+        batch.append(sample);
+        if (batch.size() == 10000 || i == rows - 1) {
+            if (!database.addMonitorDataBatch(batch)) {
+                qCritical() << "写入失败:" << database.lastError();
+                return -1;
+            }
+            batch.clear();
+        }
+    }
+    const QDateTime start = QDateTime::fromMSecsSinceEpoch(firstTs);
+    const QDateTime end = QDateTime::fromMSecsSinceEpoch(firstTs + qint64(rows) * 1000);
+
+    // 先完整读一遍，使两种方式的内存增长都不含 SQLite 页缓存的填充
+    database.forEachDeviceSample(device_id, start, end, [](const MonitorSample&) { return true; });
+
+    // 释放的内存通常留在进程的分配器中，内存增长只在第一轮测量：先流式读取，再构造 QVariantList
+    QVector<double> cursorMs, listMs;
+    qint64 cursorGrowth = -1, listGrowth = -1;
+    for (int round = 0; round < rounds; ++round) {
+        const qint64 before = residentBytes();
+        qint64 peak = before;
+        quint64 count = 0;
+        double sum = 0;
+        QElapsedTimer timer;
+        timer.start();
+        database.forEachDeviceSample(device_id, start, end, [&](const MonitorSample& sample) -> bool {
+            sum += sample.temperature;
+            if (++count % 100000 == 0) {
+                peak = qMax(peak, residentBytes());
+            }
+            return true;
+        });
+        cursorMs.append(timer.nsecsElapsed() / 1e6);
+        peak = qMax(peak, residentBytes());
+        if (round == 0 && before >= 0) cursorGrowth = peak - before;
+        if (count != quint64(rows)) {
+            qCritical() << "forEachDeviceSample 读取条数不符:" << count << sum;
+            return -1;
+        }
+    }
+    for (int round = 0; round < rounds; ++round) {
+        const qint64 before = residentBytes();
+        QElapsedTimer timer;
+        timer.start();
+        const QVariantList data = database.getDeviceData(device_id, start, end);
+        listMs.append(timer.nsecsElapsed() / 1e6);
+        if (round == 0 && before >= 0) listGrowth = residentBytes() - before;
+        if (data.size() != rows) {
+            qCritical() << "getDeviceData 读取条数不符:" << data.size();
+            return -1;
+        }
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 条样本，%2 轮").arg(rows).arg(rounds) << endl;
+    out << BenchCommon::tableHeader({"方式", "耗时 ms", "条/秒", "内存增长 MB"}, "lrrr") << endl;
+    const double cursor = BenchCommon::median(cursorMs);
+    const double list = BenchCommon::median(listMs);
+    out << QString("| forEachDeviceSample | %1 | %2 | %3 |").arg(cursor, 0, 'f', 1)
+           .arg(BenchCommon::perSecond(rows, cursor), 0, 'f', 0).arg(megabytes(cursorGrowth)) << endl;
+    out << QString("| getDeviceData (QVariantList) | %1 | %2 | %3 |").arg(list, 0, 'f', 1)
+           .arg(BenchCommon::perSecond(rows, list), 0, 'f', 0).arg(megabytes(listGrowth)) << endl;
+    return 0;
+}
@@ -0,0 +1,7 @@
+# 写入方式压测工具：逐条写入和批量写入 1k/10k/100k 条样本，比较耗时和每秒写入条数
+include(../bench.pri)
+
+TARGET = InsertBench
+
+SOURCES += \
+    insertbench_main.cpp
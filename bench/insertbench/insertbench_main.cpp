@@ -0,0 +1,92 @@
+#include "databasemanager.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QDebug>
+
+// 写入方式压测：分别写入固定条数的样本，比较逐条 addMonitorData（每条一个事务）和按批 addMonitorDataBatch 的耗时
+namespace {
+
+// 尽快写入 rows 条样本，返回耗时（毫秒），失败返回 -1
+double run(DatabaseManager& database, bool batched, int rows, int batchSize, int devices, qint64& timestamp)
+{
+    QVector<MonitorSample> batch;
+    batch.reserve(batched ? batchSize : 1);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < rows; ++i) {
+        MonitorSample sample;
+        sample.device_id = i % devices + 1;
+        sample.timestamp = timestamp++;
+        sample.temperature = 20 + i % 100 / 10.0;
+        sample.humidity = 50;
+        sample.light = 300;
+        if (!batched) {
+            if (!database.addMonitorData(sample.device_id, QDateTime::fromMSecsSinceEpoch(sample.timestamp),
+                                         sample.temperature, sample.humidity, sample.light)) {
+                return -1;
+            }
+            continue;
+        }
+        batch.append(sample);
+        if (batch.size() == batchSize || i == rows - 1) {
+            if (!database.addMonitorDataBatch(batch)) return -1;
+            batch.clear();
+        }
+    }
+    return timer.nsecsElapsed() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("InsertBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("比较逐条写入和批量写入固定条数样本的耗时和吞吐");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "压测使用的数据库文件（运行前删除）", "path", "insertbench.db");
+    QCommandLineOption rowsOption("rows", "每种方式写入的样本数，逗号分隔", "list", "1000,10000,100000");
+    QCommandLineOption batchOption("batch", "批量写入时每次 addMonitorDataBatch 的样本数", "n", "1000");
+    QCommandLineOption devicesOption("devices", "设备数", "n", "100");
+    QCommandLineOption profileOption = BenchCommon::profileOption("interactive");
+    parser.addOptions({dbOption, rowsOption, batchOption, devicesOption, profileOption});
+    parser.process(app);
+
+    const QString path = parser.value(dbOption);
+    const int batchSize = qMax(1, parser.value(batchOption).toInt());
+    const int devices = qMax(1, parser.value(devicesOption).toInt());
+    const QVector<int> rowCounts = BenchCommon::parseIntList(parser.value(rowsOption), 1);
+    BenchCommon::removeDatabase(path);
+
+    QString error;
+    if (!BenchCommon::openDatabase(path, parser.value(profileOption), error) || !BenchCommon::addDevices(devices, error)) {
+        qCritical() << error;
+        return -1;
+    }
+    DatabaseManager& database = DatabaseManager::instance();
+
+    // 样本时间从一周前开始连续递增，各组合写入不同的时间段
+    qint64 timestamp = QDateTime::currentMSecsSinceEpoch() - 7 * 24 * 60 * 60 * 1000LL;
+    QTextStream out(stdout);
+    out << BenchCommon::tableHeader({"条数", "方式", "耗时 ms", "条/秒"}, "rlrr") << endl;
+    for (int rows : rowCounts) {
+        for (int batched = 0; batched < 2; ++batched) {
+            const double ms = run(database, batched, rows, batchSize, devices, timestamp);
+            if (ms < 0) {
+                qCritical() << "写入失败:" << database.lastError();
+                return -1;
+            }
+            out << QString("| %1 | %2 | %3 | %4 |")
+                   .arg(rows)
+                   .arg(batched ? QString("批量（每批 %1 条）").arg(batchSize) : QString("逐条"))
+                   .arg(ms, 0, 'f', 1)
+                   .arg(BenchCommon::perSecond(rows, ms), 0, 'f', 0) << endl;
+        }
+    }
+    return 0;
+}
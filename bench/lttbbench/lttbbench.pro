@@ -0,0 +1,11 @@
+# LTTB 降采样检查工具：注入尖峰后降采样，尖峰丢失时返回非 0，并输出降采样耗时
+include(../bench.pri)
+
+TARGET = LttbBench
+
+SOURCES += \
+    lttbbench_main.cpp \
+    ../../src/chartdownsampler.cpp
+
+HEADERS += \
+    ../../include/chartdownsampler.h
@@ -0,0 +1,96 @@
+#include "chartdownsampler.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QSet>
+#include <QDebug>
+#include <cmath>
+
+// LTTB 降采样检查：在带噪声的平滑曲线上注入孤立尖峰，降采样后每个尖峰都必须保留；
+// 任何尖峰丢失时返回非 0，同时输出各目标点数下的耗时
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("LttbBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("检查 ChartDownsampler::lttb 是否保留尖峰，并测量降采样耗时");
+    parser.addHelpOption();
+    QCommandLineOption pointsOption("points", "原始点数", "n", "1000000");
+    QCommandLineOption thresholdsOption("thresholds", "目标点数，逗号分隔", "list", "500,1000,2000");
+    QCommandLineOption spikesOption("spikes", "注入的尖峰数", "n", "50");
+    QCommandLineOption roundsOption("rounds", "轮数，耗时取中位数", "n", "5");
+    parser.addOptions({pointsOption, thresholdsOption, spikesOption, roundsOption});
+    parser.process(app);
+
+    const int count = qMax(3, parser.value(pointsOption).toInt());
+    const int spikes = qMax(1, parser.value(spikesOption).toInt());
+    const int rounds = qMax(1, parser.value(roundsOption).toInt());
+    const QVector<int> thresholds = BenchCommon::parseIntList(parser.value(thresholdsOption), 3);
+
+    // 温度曲线（每秒一点）叠加 ±0.2 的噪声；尖峰高出或低于曲线 10 度，正负交替
+    QRandomGenerator random(7);
+    QVector<QPointF> points;
+    points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const double value = 22 + 5 * std::sin(i * 2 * pi / 86400.0) + (random.generateDouble() - 0.5) * 0.4;
+        points.append(QPointF(i * 1000.0, value));
+    }
+    QVector<int> spikeIndexes;
+    for (int s = 0; s < spikes; ++s) {
+        const int index = int((s + 0.5) * count / spikes);
+        points[index].setY(points.at(index).y() + (s % 2 == 0 ? 10 : -10));
+        spikeIndexes.append(index);
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 个点，%2 个尖峰").arg(count).arg(spikes) << endl;
+    out << BenchCommon::tableHeader({"目标点数", "耗时 ms", "点/秒", "保留的尖峰"}, "rrrr") << endl;
+    int failed = 0;
+    for (int threshold : thresholds) {
+        QVector<double> elapsedMs;
+        QVector<QPointF> sampled;
+        for (int round = 0; round < rounds; ++round) {
+            QElapsedTimer timer;
+            timer.start();
+            sampled = ChartDownsampler::lttb(points, threshold);
+            elapsedMs.append(timer.nsecsElapsed() / 1e6);
+        }
+        // 两个尖峰落在同一个桶里时只能保留一个，这种组合不作检查
+        const double bucketWidth = double(count - 2) / qMax(1, threshold - 2);
+        const bool checkable = count / spikes > 2 * bucketWidth;
+        QSet<qint64> kept;
+        for (const QPointF& point : sampled) {
+            kept.insert(qint64(point.x()));
+        }
+        int preserved = 0;
+        for (int index : spikeIndexes) {
+            if (kept.contains(qint64(points.at(index).x()))) ++preserved;
+        }
+        const double ms = BenchCommon::median(elapsedMs);
+        out << QString("| %1 | %2 | %3 | %4/%5%6 |")
+               .arg(threshold)
+               .arg(ms, 0, 'f', 2)
+               .arg(BenchCommon::perSecond(count, ms), 0, 'f', 0)
+               .arg(preserved)
+               .arg(spikes)
+               .arg(checkable ? QString() : QString("（尖峰间距小于两个桶，未检查）")) << endl;
+        if (checkable && preserved != spikes) {
+            ++failed;
+        }
+    }
+    if (failed > 0) {
+        qCritical() << failed << "种目标点数下有尖峰丢失";
+        return 1;
+    }
+    return 0;
+}
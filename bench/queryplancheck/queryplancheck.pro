@@ -0,0 +1,7 @@
+# 查询计划检查：monitor_data 的设备/时间范围查询未使用 idx_monitor_data_device_ts 时返回非 0
+include(../bench.pri)
+
+TARGET = QueryPlanCheck
+
+SOURCES += \
+    queryplancheck_main.cpp
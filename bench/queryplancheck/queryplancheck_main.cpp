@@ -0,0 +1,84 @@
+#include "databasemanager.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QDebug>
+
+// 查询计划检查：按设备和时间范围读取 monitor_data 的语句必须走 idx_monitor_data_device_ts，
+// 带 ORDER BY 的还不能额外排序；任何一条不满足时返回非 0，可放在构建后的检查步骤中
+namespace {
+
+struct PlanCheck {
+    const char* source;   // 语句所在的接口
+    QString sql;
+    bool ordered;         // 排序应由索引完成
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QueryPlanCheck");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("检查 monitor_data 的设备/时间范围查询是否使用 idx_monitor_data_device_ts");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "检查使用的数据库文件（运行前删除）", "path", "queryplancheck.db");
+    parser.addOption(dbOption);
+    parser.process(app);
+
+    const QString path = parser.value(dbOption);
+    BenchCommon::removeDatabase(path);
+    QString error;
+    if (!BenchCommon::openDatabase(path, QString(), error)) {
+        qCritical() << error;
+        return -1;
+    }
+    DatabaseManager& database = DatabaseManager::instance();
+
+    // 与 DatabaseManager 中的语句保持一致（分区表的索引名带 _pYYYYMMDD 后缀，结构相同）
+    const QString statistics = "SELECT d.device_id, d.name, COUNT(m.temperature), MIN(m.temperature), MAX(m.temperature), "
+                               "AVG(m.temperature), AVG(m.temperature * m.temperature) "
+                               "FROM devices d JOIN monitor_data m ON m.device_id = d.device_id "
+                               "WHERE m.timestamp BETWEEN ? AND ?%1 GROUP BY d.device_id ORDER BY d.device_id";
+    const QVector<PlanCheck> checks = {
+        { "forEachDeviceSample（升序）",
+          "SELECT timestamp, temperature, humidity, light FROM monitor_data "
+          "WHERE device_id=? AND timestamp BETWEEN ? AND ? ORDER BY timestamp ASC", true },
+        { "forEachDeviceSample（降序）",
+          "SELECT timestamp, temperature, humidity, light FROM monitor_data "
+          "WHERE device_id=? AND timestamp BETWEEN ? AND ? ORDER BY timestamp DESC", true },
+        { "getMetricStatistics（单台设备）", statistics.arg(" AND d.device_id = ?"), false },
+        { "getMetricStatistics（全部设备）", statistics.arg(""), false },
+        { "compactMonitorData",
+          "SELECT MIN(timestamp) FROM monitor_data WHERE device_id=? AND timestamp >= ? AND timestamp < ?", false }
+    };
+
+    QTextStream out(stdout);
+    int failed = 0;
+    for (const PlanCheck& check : checks) {
+        // 参数只影响估算，不影响能否使用索引；按参数个数全部绑定 0
+        QVariantList bindValues;
+        for (int i = check.sql.count('?'); i > 0; --i) {
+            bindValues << 0;
+        }
+        const QStringList plan = database.explainQueryPlan(check.sql, bindValues);
+        const QString detail = plan.join("; ");
+        QString problem;
+        if (plan.isEmpty()) {
+            problem = "无法获取查询计划: " + database.lastError();
+        } else if (!detail.contains("idx_monitor_data_device_ts")) {
+            problem = "未使用 idx_monitor_data_device_ts";
+        } else if (check.ordered && detail.contains("TEMP B-TREE")) {
+            problem = "结果需要额外排序";
+        }
+        out << (problem.isEmpty() ? "通过 " : "失败 ") << check.source << ": " << detail << endl;
+        if (!problem.isEmpty()) {
+            out << "    " << problem << endl;
+            ++failed;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
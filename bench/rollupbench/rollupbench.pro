@@ -0,0 +1,7 @@
+# 汇总表读取压测工具：在 FleetGenerator 生成的数据库上比较原始数据与各级汇总表的历史读取延迟
+include(../bench.pri)
+
+TARGET = RollupBench
+
+SOURCES += \
+    rollupbench_main.cpp
@@ -0,0 +1,109 @@
+#include "databasemanager.h"
+#include "querystats.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFileInfo>
+#include <QDebug>
+
+// 汇总表读取压测：在 FleetGenerator 生成的数据库上，按设备读取最近 N 天的历史数据，
+// 比较直接读原始数据与读 1 分钟/1 小时/1 天汇总表的延迟
+namespace {
+
+struct Level {
+    const char* name;
+    int maxPoints;   // 传给 forEachDeviceSample，使 pickResolution 选中该粒度
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("RollupBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("比较读取最近 N 天历史数据时原始数据与各级汇总表的延迟");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "FleetGenerator 生成的数据库文件（只读取，不修改数据）", "path", "fleet.db");
+    QCommandLineOption daysOption("days", "读取的天数", "n", "30");
+    QCommandLineOption devicesOption("devices", "参与测试的设备数（按编号取前 n 台）", "n", "50");
+    QCommandLineOption roundsOption("rounds", "每台设备每种粒度读取的次数", "n", "3");
+    QCommandLineOption profileOption = BenchCommon::profileOption("interactive");
+    parser.addOptions({dbOption, daysOption, devicesOption, roundsOption, profileOption});
+    parser.process(app);
+
+    const QString path = parser.value(dbOption);
+    const int days = qMax(1, parser.value(daysOption).toInt());
+    const int deviceLimit = qMax(1, parser.value(devicesOption).toInt());
+    const int rounds = qMax(1, parser.value(roundsOption).toInt());
+    if (!QFileInfo::exists(path)) {
+        qCritical() << "数据库不存在，请先用 FleetGenerator 生成:" << path;
+        return -1;
+    }
+    QString error;
+    if (!BenchCommon::openDatabase(path, parser.value(profileOption), error)) {
+        qCritical() << error;
+        return -1;
+    }
+    DatabaseManager& database = DatabaseManager::instance();
+    // 每台设备以自己最新一条数据为结束时间
+    QVector<QPair<int, qint64>> devices;
+    const QHash<int, MonitorSample> latest = database.latestSamplesSnapshot();
+    for (const QVariant& device : database.getDevices()) {
+        const int device_id = device.toMap().value("device_id").toInt();
+        auto found = latest.constFind(device_id);
+        if (found == latest.constEnd()) continue;
+        devices.append(qMakePair(device_id, found.value().timestamp));
+        if (devices.size() == deviceLimit) break;
+    }
+    if (devices.isEmpty()) {
+        qCritical() << "数据库中没有监控数据";
+        return -1;
+    }
+
+    const qint64 spanMs = days * 24 * 60 * 60 * 1000LL;
+    const Level levels[] = {
+        { "原始数据", 0 },
+        { "1 分钟汇总", int(spanMs / (60 * 1000LL)) },
+        { "1 小时汇总", int(spanMs / (60 * 60 * 1000LL)) },
+        { "1 天汇总", days }
+    };
+    QTextStream out(stdout);
+    out << QString("%1 台设备，最近 %2 天，每台每种粒度 %3 次").arg(devices.size()).arg(days).arg(rounds) << endl;
+    out << BenchCommon::tableHeader({"粒度", "平均行数", "P50 ms", "P99 ms", "最大 ms"}, "lrrrr") << endl;
+    for (const Level& level : levels) {
+        LatencyHistogram latency;
+        quint64 rows = 0;
+        quint64 reads = 0;
+        qint64 maxMicros = 0;
+        for (int round = 0; round < rounds; ++round) {
+            for (const QPair<int, qint64>& device : devices) {
+                QElapsedTimer timer;
+                timer.start();
+                const bool ok = database.forEachDeviceSample(device.first,
+                                                             QDateTime::fromMSecsSinceEpoch(device.second - spanMs),
+                                                             QDateTime::fromMSecsSinceEpoch(device.second),
+                                                             [&rows](const MonitorSample&) -> bool { ++rows; return true; },
+                                                             Qt::AscendingOrder, level.maxPoints);
+                const qint64 micros = timer.nsecsElapsed() / 1000;
+                if (!ok) {
+                    qCritical() << "读取失败:" << database.lastError();
+                    return -1;
+                }
+                latency.record(quint64(micros));
+                maxMicros = qMax(maxMicros, micros);
+                ++reads;
+            }
+        }
+        out << QString("| %1 | %2 | %3 | %4 | %5 |")
+               .arg(level.name)
+               .arg(rows / reads)
+               .arg(latency.percentile(50) / 1000.0, 0, 'f', 2)
+               .arg(latency.percentile(99) / 1000.0, 0, 'f', 2)
+               .arg(maxMicros / 1000.0, 0, 'f', 2) << endl;
+    }
+    return 0;
+}
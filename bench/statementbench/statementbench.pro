@@ -0,0 +1,7 @@
+# 语句缓存压测工具：比较关闭和开启 StatementCache 时常用接口的单次调用耗时
+include(../bench.pri)
+
+TARGET = StatementBench
+
+SOURCES += \
+    statementbench_main.cpp
@@ -0,0 +1,132 @@
+#include "databasemanager.h"
+#include "statementcache.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QDebug>
+#include <functional>
+
+// 语句缓存压测：关闭和开启 StatementCache 时常用接口的单次调用耗时
+namespace {
+
+struct Operation {
+    QString name;
+    std::function<bool(int)> call;
+    bool transaction;   // 写入类接口按每 1000 次一个事务执行，只比较语句本身的开销
+    bool flushLogs;     // 系统日志由后台线程批量写入，每 1000 次等待写完
+};
+
+// 返回每次调用的微秒数，失败返回 -1
+double measure(DatabaseManager& database, const Operation& operation, int calls)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (operation.transaction) database.beginTransaction();
+    for (int i = 0; i < calls; ++i) {
+        if (!operation.call(i)) {
+            if (operation.transaction) database.rollbackTransaction();
+            return -1;
+        }
+        if (i % 1000 == 999) {
+            if (operation.transaction) {
+                database.commitTransaction();
+                database.beginTransaction();
+            } else if (operation.flushLogs) {
+                // 日志缓冲有上限，分段等待写完，写入时间计入调用耗时
+                database.flushLogs();
+            }
+        }
+    }
+    if (operation.transaction) database.commitTransaction();
+    if (operation.flushLogs) database.flushLogs();
+    return timer.nsecsElapsed() / 1000.0 / calls;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("StatementBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("比较关闭和开启语句缓存时 DatabaseManager 接口的单次调用耗时");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "压测使用的数据库文件（运行前删除）", "path", "statementbench.db");
+    QCommandLineOption callsOption("calls", "每轮每个接口的调用次数", "n", "20000");
+    QCommandLineOption roundsOption("rounds", "轮数，结果取中位数", "n", "5");
+    QCommandLineOption capacityOption("capacity", "开启时每个连接缓存的语句数", "n",
+                                      QString::number(StatementCache::DefaultCapacity));
+    QCommandLineOption profileOption = BenchCommon::profileOption("bulk");
+    parser.addOptions({dbOption, callsOption, roundsOption, capacityOption, profileOption});
+    parser.process(app);
+
+    const QString path = parser.value(dbOption);
+    const int calls = qMax(1, parser.value(callsOption).toInt());
+    const int rounds = qMax(1, parser.value(roundsOption).toInt());
+    const int capacity = qMax(1, parser.value(capacityOption).toInt());
+    BenchCommon::removeDatabase(path);
+
+    const int deviceCount = 100;
+    QString error;
+    if (!BenchCommon::openDatabase(path, parser.value(profileOption), error) || !BenchCommon::addDevices(deviceCount, error)) {
+        qCritical() << error;
+        return -1;
+    }
+    DatabaseManager& database = DatabaseManager::instance();
+    int userId = -1;
+    if (!database.addUser("bench", "bench123", "", "", "压测", "user") || !database.getUserIdByUsername("bench", userId)) {
+        qCritical() << "创建用户失败:" << database.lastError();
+        return -1;
+    }
+
+    qint64 timestamp = QDateTime::currentMSecsSinceEpoch() - 24 * 60 * 60 * 1000LL;
+    QVariantMap device;
+    QString username, email, phone, nickname, role;
+    const QVector<Operation> operations = {
+        { "addMonitorData", [&](int i) {
+              return database.addMonitorData(i % deviceCount + 1, QDateTime::fromMSecsSinceEpoch(timestamp++),
+                                             20 + i % 10, 50, 300);
+          }, true, false },
+        // 设备信息由 DatabaseManager 的设备缓存提供，不执行 SQL
+        { "getDeviceById", [&](int i) { return database.getDeviceById(i % deviceCount + 1, device); }, false, false },
+        // 按主键读取一行的 SQL 接口，作为 getDeviceById 的对照
+        { "getUserInfo", [&](int) {
+              return database.getUserInfo(userId, username, email, phone, nickname, role);
+          }, false, false },
+        { "addLog", [&](int i) { return database.addLog("压测", "INFO", "语句缓存压测", userId, i % deviceCount + 1); }, false, true }
+    };
+
+    // 两种设置交替运行，避免页缓存预热等因素只影响其中一种
+    QVector<QVector<double>> uncached(operations.size()), cached(operations.size());
+    for (int round = 0; round < rounds; ++round) {
+        for (int enabled = 0; enabled < 2; ++enabled) {
+            database.setStatementCacheCapacity(enabled ? capacity : 0);
+            for (int i = 0; i < operations.size(); ++i) {
+                const double micros = measure(database, operations.at(i), calls);
+                if (micros < 0) {
+                    qCritical() << operations.at(i).name << "失败:" << database.lastError();
+                    return -1;
+                }
+                (enabled ? cached : uncached)[i].append(micros);
+            }
+        }
+    }
+
+    QTextStream out(stdout);
+    out << BenchCommon::tableHeader({"接口", "无缓存 µs/次", "缓存 µs/次", "变化"}, "lrrr") << endl;
+    for (int i = 0; i < operations.size(); ++i) {
+        const double before = BenchCommon::median(uncached.at(i));
+        const double after = BenchCommon::median(cached.at(i));
+        out << QString("| %1 | %2 | %3 | %4% |")
+               .arg(operations.at(i).name)
+               .arg(before, 0, 'f', 2)
+               .arg(after, 0, 'f', 2)
+               .arg(before > 0 ? (after - before) * 100 / before : 0, 0, 'f', 1) << endl;
+    }
+    const StatementCache::Stats stats = StatementCache::stats();
+    out << QString("语句缓存：命中 %1 次，未命中 %2 次，淘汰 %3 次").arg(stats.hits).arg(stats.misses).arg(stats.evictions) << endl;
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "tuningbench.h"
+#include "benchcommon.h"
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QFileInfo>
+#include <QElapsedTimer>
+
+TuningBench::TuningBench(const Options& options)
+    : options(options)
+{
+}
+
+bool TuningBench::run(const QString& path)
+{
+    stats = Result();
+    stats.profile = options.profile;
+    BenchCommon::removeDatabase(path);
+    if (!BenchCommon::openDatabase(path, options.profile, error) || !BenchCommon::addDevices(options.devices, error)) {
+        return false;
+    }
+    DatabaseManager& database = DatabaseManager::instance();
+    QVector<int> devices;
+    for (const QVariant& device : database.getDevices()) {
+        devices.append(device.toMap().value("device_id").toInt());
+    }
+    if (devices.isEmpty()) {
+        error = "没有可用的设备";
+        return false;
+    }
+
+    database.resetQueryStatistics();
+    database.setWriteBehind(true, options.batch, 50);
+
+    // 样本时间从一周前开始，每轮所有设备各一条、间隔 1 秒；读线程查询最近 readWindowSec 秒
+    const qint64 firstTs = QDateTime::currentMSecsSinceEpoch() - 7 * 24 * 60 * 60 * 1000LL;
+    QAtomicInteger<qint64> latestTs(firstTs);
+    QAtomicInt stop(0);
+    QAtomicInteger<quint64> reads(0);
+    LatencyHistogram readLatency;
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, options.readers));
+    QVector<QFuture<void>> readers;
+    for (int r = 0; r < options.readers; ++r) {
+        readers.append(QtConcurrent::run(&pool, [&, r]() {
+            int next = r;
+            while (!stop.loadAcquire()) {
+                const int device = devices.at(next++ % devices.size());
+                const qint64 end = latestTs.loadAcquire();
+                QElapsedTimer timer;
+                timer.start();
+                database.forEachDeviceSample(device, QDateTime::fromMSecsSinceEpoch(end - options.readWindowSec * 1000LL),
+                                             QDateTime::fromMSecsSinceEpoch(end),
+                                             [](const MonitorSample&) { return true; });
+                readLatency.record(quint64(timer.nsecsElapsed() / 1000));
+                reads.fetchAndAddRelaxed(1);
+            }
+        }));
+    }
+
+    const QString walPath = path + "-wal";
+    const qint64 durationMs = qint64(options.durationSec) * 1000;
+    QVector<MonitorSample> batch;
+    batch.reserve(options.batch);
+    qint64 timestamp = firstTs;
+    int device = 0;
+    qint64 nextWalCheckMs = 0;
+    QElapsedTimer clock;
+    clock.start();
+    while (clock.elapsed() < durationMs) {
+        batch.clear();
+        for (int i = 0; i < options.batch; ++i) {
+            MonitorSample sample;
+            sample.device_id = devices.at(device);
+            sample.timestamp = timestamp;
+            sample.temperature = 20 + (timestamp / 1000 + device) % 100 / 10.0;
+            sample.humidity = 40 + device % 30;
+            sample.light = (timestamp / 1000) % 1000;
+            batch.append(sample);
+            if (++device == devices.size()) {
+                device = 0;
+                timestamp += 1000;
+            }
+        }
+        database.addMonitorDataBatch(batch);
+        latestTs.storeRelease(timestamp);
+        // 写线程跟不上时等待，不让队列积压到丢弃，吞吐即写线程的提交速度
+        while (database.writeBehindStats().pending > options.batch * 8 && clock.elapsed() < durationMs) {
+            QThread::usleep(200);
+        }
+        if (clock.elapsed() >= nextWalCheckMs) {
+            stats.peakWalBytes = qMax(stats.peakWalBytes, QFileInfo(walPath).size());
+            nextWalCheckMs = clock.elapsed() + 100;
+        }
+    }
+    database.flushWrites();
+    stats.seconds = clock.elapsed() / 1000.0;
+    stop.storeRelease(1);
+    for (QFuture<void>& reader : readers) {
+        reader.waitForFinished();
+    }
+
+    const DatabaseManager::WriteBehindStats writes = database.writeBehindStats();
+    stats.committed = writes.committed;
+    stats.reads = reads.loadRelaxed();
+    stats.readP50Ms = readLatency.percentile(50) / 1000.0;
+    stats.readP99Ms = readLatency.percentile(99) / 1000.0;
+    for (const QueryStatsEntry& entry : database.queryStatistics()) {
+        if (entry.statement.startsWith("INSERT INTO monitor_data ")) {
+            stats.insertP99Ms = qMax(stats.insertP99Ms, entry.p99Ms);
+        }
+    }
+    const DatabaseManager::CheckpointStats checkpoints = database.checkpointStats();
+    stats.checkpoints = checkpoints.passive + checkpoints.truncate;
+    stats.truncations = checkpoints.truncate;
+    stats.peakWalBytes = qMax(stats.peakWalBytes, checkpoints.peakWalBytes);
+    stats.finalWalBytes = QFileInfo(walPath).size();
+    database.setWriteBehind(false);
+
+    if (writes.failed > 0 || writes.dropped > 0) {
+        error = QString("%1 条写入失败，%2 条被丢弃").arg(writes.failed).arg(writes.dropped);
+        return false;
+    }
+    return true;
+}
+
+QString TuningBench::tableHeader()
+{
+    return BenchCommon::tableHeader({"配置", "写入 条/秒", "读取 次/秒", "写入 P99 ms", "读取 P50 ms", "读取 P99 ms",
+                                     "WAL 峰值 MB", "WAL 结束 MB", "检查点（TRUNCATE）"}, "lrrrrrrrr");
+}
+
+QString TuningBench::tableRow(const Result& result)
+{
+    const double seconds = qMax(0.001, result.seconds);
+    const double mb = 1024.0 * 1024.0;
+    return QString("| %1 | %2 | %3 | %4 | %5 | %6 | %7 | %8 | %9（%10） |")
+        .arg(result.profile)
+        .arg(result.committed / seconds, 0, 'f', 0)
+        .arg(result.reads / seconds, 0, 'f', 0)
+        .arg(result.insertP99Ms, 0, 'f', 2)
+        .arg(result.readP50Ms, 0, 'f', 2)
+        .arg(result.readP99Ms, 0, 'f', 2)
+        .arg(result.peakWalBytes / mb, 0, 'f', 1)
+        .arg(result.finalWalBytes / mb, 0, 'f', 1)
+        .arg(result.checkpoints)
+        .arg(result.truncations);
+}
+
+QString TuningBench::serialize(const Result& result)
+{
+    QStringList fields;
+    fields << "row" << result.profile << QString::number(result.committed) << QString::number(result.reads)
+           << QString::number(result.seconds, 'f', 3) << QString::number(result.insertP99Ms, 'f', 3)
+           << QString::number(result.readP50Ms, 'f', 3) << QString::number(result.readP99Ms, 'f', 3)
+           << QString::number(result.peakWalBytes) << QString::number(result.finalWalBytes)
+           << QString::number(result.checkpoints) << QString::number(result.truncations);
+    return fields.join('\t');
+}
+
+bool TuningBench::parse(const QString& line, Result& result)
+{
+    const QStringList fields = line.trimmed().split('\t');
+    if (fields.size() != 12 || fields.at(0) != "row") {
+        return false;
+    }
+    result.profile = fields.at(1);
+    result.committed = fields.at(2).toULongLong();
+    result.reads = fields.at(3).toULongLong();
+    result.seconds = fields.at(4).toDouble();
+    result.insertP99Ms = fields.at(5).toDouble();
+    result.readP50Ms = fields.at(6).toDouble();
+    result.readP99Ms = fields.at(7).toDouble();
+    result.peakWalBytes = fields.at(8).toLongLong();
+    result.finalWalBytes = fields.at(9).toLongLong();
+    result.checkpoints = fields.at(10).toULongLong();
+    result.truncations = fields.at(11).toULongLong();
+    return true;
+}
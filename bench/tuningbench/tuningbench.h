@@ -0,0 +1,54 @@
+#ifndef TUNINGBENCH_H
+#define TUNINGBENCH_H
+
+#include <QString>
+#include <QStringList>
+#include "databasemanager.h"
+
+// SQLite 运行参数压测：用指定的 TuningProfile 在新建的数据库上模拟采集服务的持续写入（延迟写入队列），
+// 同时由若干读线程反复查询最近的数据，统计写入吞吐、读取延迟和 WAL 文件大小
+class TuningBench
+{
+public:
+    struct Options {
+        QString profile = "default";
+        int devices = 200;
+        int durationSec = 20;
+        int batch = 1000;        // 写线程每个事务的条数
+        int readers = 2;         // 并发读线程数
+        int readWindowSec = 300; // 每次读取的时间范围（按样本时间）
+    };
+
+    struct Result {
+        QString profile;
+        quint64 committed = 0;
+        quint64 reads = 0;
+        double seconds = 0;          // 从开始写入到队列全部提交
+        double insertP99Ms = 0;      // 写入语句（execBatch）的 P99
+        double readP50Ms = 0;
+        double readP99Ms = 0;
+        qint64 peakWalBytes = 0;
+        qint64 finalWalBytes = 0;
+        quint64 checkpoints = 0;     // 检查点线程执行的次数（PASSIVE + TRUNCATE）
+        quint64 truncations = 0;
+    };
+
+    explicit TuningBench(const Options& options);
+    // 删除 path 及其 WAL 后重新建库并运行；DatabaseManager 是进程内单例，每个进程只运行一次
+    bool run(const QString& path);
+    const Result& result() const { return stats; }
+    QString lastError() const { return error; }
+
+    // 结果矩阵（Markdown 表格），子进程以一行 "row<TAB>..." 输出结果，由父进程汇总
+    static QString tableHeader();
+    static QString tableRow(const Result& result);
+    static QString serialize(const Result& result);
+    static bool parse(const QString& line, Result& result);
+
+private:
+    Options options;
+    Result stats;
+    QString error;
+};
+
+#endif // TUNINGBENCH_H
@@ -0,0 +1,13 @@
+# SQLite 运行参数压测工具：比较各 TuningProfile 的写入吞吐、读取延迟和 WAL 大小
+include(../bench.pri)
+
+QT += concurrent
+
+TARGET = TuningBench
+
+SOURCES += \
+    tuningbench_main.cpp \
+    tuningbench.cpp
+
+HEADERS += \
+    tuningbench.h
@@ -0,0 +1,70 @@
+#include "tuningbench.h"
+#include "benchcommon.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QProcess>
+#include <QTextStream>
+#include <QDebug>
+
+// SQLite 运行参数压测：不指定 --profile 时依次运行全部配置，输出 Markdown 格式的结果矩阵
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("TuningBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("比较不同 SQLite 运行参数配置下的写入吞吐、读取延迟和 WAL 大小");
+    parser.addHelpOption();
+    QCommandLineOption profileOption("profile", "只运行一种配置：" + DatabaseManager::tuningProfileNames().join('/'), "name");
+    QCommandLineOption dbOption("db", "压测使用的数据库文件（运行前删除）", "path", "tuningbench.db");
+    QCommandLineOption devicesOption("devices", "设备数", "n", "200");
+    QCommandLineOption durationOption("duration", "每种配置的写入秒数", "sec", "20");
+    QCommandLineOption batchOption("batch", "每个事务的条数", "n", "1000");
+    QCommandLineOption readersOption("readers", "并发读线程数", "n", "2");
+    QCommandLineOption windowOption("read-window", "每次读取的时间范围（秒）", "sec", "300");
+    parser.addOptions({profileOption, dbOption, devicesOption, durationOption, batchOption, readersOption, windowOption});
+    parser.process(app);
+
+    const QString path = parser.value(dbOption);
+    QTextStream out(stdout);
+    if (parser.isSet(profileOption)) {
+        TuningBench::Options options;
+        options.profile = parser.value(profileOption);
+        options.devices = qMax(1, parser.value(devicesOption).toInt());
+        options.durationSec = qMax(1, parser.value(durationOption).toInt());
+        options.batch = qMax(1, parser.value(batchOption).toInt());
+        options.readers = qMax(0, parser.value(readersOption).toInt());
+        options.readWindowSec = qMax(1, parser.value(windowOption).toInt());
+        TuningBench bench(options);
+        if (!bench.run(path)) {
+            qCritical() << bench.lastError();
+            return -1;
+        }
+        out << TuningBench::serialize(bench.result()) << endl;
+        return 0;
+    }
+
+    // 每种配置在独立进程中运行：DatabaseManager 是单例，上一种配置的连接、页缓存和线程不会影响下一种
+    out << TuningBench::tableHeader() << endl;
+    int failed = 0;
+    for (const QString& name : DatabaseManager::tuningProfileNames()) {
+        QProcess process;
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(QCoreApplication::applicationFilePath(),
+                      QCoreApplication::arguments().mid(1) << "--profile" << name);
+        process.waitForFinished(-1);
+        TuningBench::Result result;
+        bool found = false;
+        for (const QString& line : QString::fromUtf8(process.readAllStandardOutput()).split('\n')) {
+            found = TuningBench::parse(line, result) || found;
+        }
+        if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0 || !found) {
+            qCritical() << "配置" << name << "运行失败";
+            ++failed;
+            continue;
+        }
+        out << TuningBench::tableRow(result) << endl;
+    }
+    BenchCommon::removeDatabase(path);
+    return failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,22 @@
+# 数据库层：界面程序和采集服务共用
+QT += sql
+
+INCLUDEPATH += $$PWD/include
+
+SOURCES += \
+    $$PWD/src/databasemanager.cpp \
+    $$PWD/src/alarmruleengine.cpp \
+    $$PWD/src/writebehindqueue.cpp \
+    $$PWD/src/logwriter.cpp \
+    $$PWD/src/chunkcodec.cpp \
+    $$PWD/src/querystats.cpp \
+    $$PWD/src/statementcache.cpp
+
+HEADERS += \
+    $$PWD/include/databasemanager.h \
+    $$PWD/include/alarmruleengine.h \
+    $$PWD/include/writebehindqueue.h \
+    $$PWD/include/logwriter.h \
+    $$PWD/include/chunkcodec.h \
+    $$PWD/include/querystats.h \
+    $$PWD/include/statementcache.h
@@ -26,7 +26,7 @@ CREATE TABLE IF NOT EXISTS devices (
 CREATE TABLE IF NOT EXISTS monitor_data (
     data_id INTEGER PRIMARY KEY AUTOINCREMENT,
     device_id INTEGER NOT NULL,
-    timestamp DATETIME NOT NULL,
+    timestamp INTEGER NOT NULL, -- 毫秒时间戳（epoch ms）
     temperature REAL,
     humidity REAL,
     light REAL,
@@ -48,7 +48,7 @@ CREATE TABLE IF NOT EXISTS alarm_rules (
 CREATE TABLE IF NOT EXISTS alarm_records (
     alarm_id INTEGER PRIMARY KEY AUTOINCREMENT,
     device_id INTEGER NOT NULL,
-    timestamp DATETIME NOT NULL,
+    timestamp INTEGER NOT NULL, -- 毫秒时间戳（epoch ms）
     content TEXT NOT NULL,
     status TEXT NOT NULL,
     note TEXT,
@@ -58,7 +58,7 @@ CREATE TABLE IF NOT EXISTS alarm_records (
 -- 系统日志表
 CREATE TABLE IF NOT EXISTS system_logs (
     log_id INTEGER PRIMARY KEY AUTOINCREMENT,
-    timestamp DATETIME NOT NULL,
+    timestamp INTEGER NOT NULL, -- 毫秒时间戳（epoch ms）
     log_type TEXT NOT NULL,
     log_level TEXT NOT NULL,
     content TEXT NOT NULL,
@@ -68,6 +68,82 @@ CREATE TABLE IF NOT EXISTS system_logs (
     FOREIGN KEY(device_id) REFERENCES devices(device_id)
 );
 
+-- 监控数据汇总表（1分钟/1小时/1天），写入监控数据时由程序增量维护
+CREATE TABLE IF NOT EXISTS monitor_rollup_1m (
+    device_id INTEGER NOT NULL,
+    bucket INTEGER NOT NULL,     -- 桶起始毫秒时间戳（UTC 对齐）
+    count INTEGER NOT NULL,
+    first_ts INTEGER NOT NULL,
+    last_ts INTEGER NOT NULL,
+    temperature_min REAL, temperature_max REAL, temperature_sum REAL, temperature_first REAL, temperature_last REAL,
+    humidity_min REAL, humidity_max REAL, humidity_sum REAL, humidity_first REAL, humidity_last REAL,
+    light_min REAL, light_max REAL, light_sum REAL, light_first REAL, light_last REAL,
+    PRIMARY KEY(device_id, bucket)
+) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS monitor_rollup_1h (
+    device_id INTEGER NOT NULL,
+    bucket INTEGER NOT NULL,     -- 桶起始毫秒时间戳（UTC 对齐）
+    count INTEGER NOT NULL,
+    first_ts INTEGER NOT NULL,
+    last_ts INTEGER NOT NULL,
+    temperature_min REAL, temperature_max REAL, temperature_sum REAL, temperature_first REAL, temperature_last REAL,
+    humidity_min REAL, humidity_max REAL, humidity_sum REAL, humidity_first REAL, humidity_last REAL,
+    light_min REAL, light_max REAL, light_sum REAL, light_first REAL, light_last REAL,
+    PRIMARY KEY(device_id, bucket)
+) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS monitor_rollup_1d (
+    device_id INTEGER NOT NULL,
+    bucket INTEGER NOT NULL,     -- 桶起始毫秒时间戳（UTC 对齐）
+    count INTEGER NOT NULL,
+    first_ts INTEGER NOT NULL,
+    last_ts INTEGER NOT NULL,
+    temperature_min REAL, temperature_max REAL, temperature_sum REAL, temperature_first REAL, temperature_last REAL,
+    humidity_min REAL, humidity_max REAL, humidity_sum REAL, humidity_first REAL, humidity_last REAL,
+    light_min REAL, light_max REAL, light_sum REAL, light_first REAL, light_last REAL,
+    PRIMARY KEY(device_id, bucket)
+) WITHOUT ROWID;
+
+-- 分块压缩存储：每台设备每小时内的数据压缩为若干块（Gorilla 编码，见 include/chunkcodec.h）
+-- 开启分块存储后由程序把一小时前的原始数据从 monitor_data 移入此表
+CREATE TABLE IF NOT EXISTS monitor_chunks (
+    device_id INTEGER NOT NULL,
+    start_ts INTEGER NOT NULL,   -- 块内第一条的毫秒时间戳
+    end_ts INTEGER NOT NULL,     -- 块内最后一条的毫秒时间戳
+    count INTEGER NOT NULL,
+    temperature_min REAL, temperature_max REAL,
+    humidity_min REAL, humidity_max REAL,
+    light_min REAL, light_max REAL,
+    data BLOB NOT NULL,
+    PRIMARY KEY(device_id, start_ts)
+);
+
+-- 按天分区：开启分区维护后，monitor_data/system_logs 每天结束时改名封存为 <表名>_pYYYYMMDD 并在此登记
+-- name = base_table 的一行表示当前写入的表（min_ts 为其起始日），max_ts 为 NULL
+CREATE TABLE IF NOT EXISTS table_partitions (
+    name TEXT PRIMARY KEY,
+    base_table TEXT NOT NULL,
+    min_ts INTEGER,
+    max_ts INTEGER
+);
+
+-- 保留策略执行位置：table_name 中早于 retained_from 的数据可能已被删除，统计时该时段改用汇总表
+CREATE TABLE IF NOT EXISTS retention_cutoffs (
+    table_name TEXT PRIMARY KEY,
+    retained_from INTEGER NOT NULL
+);
+
+-- 时间范围查询索引（程序内以 PRAGMA user_version 管理表结构版本，当前为 5）
+CREATE INDEX IF NOT EXISTS idx_monitor_data_device_ts ON monitor_data(device_id, timestamp, temperature, humidity, light);
+CREATE INDEX IF NOT EXISTS idx_alarm_records_device_ts ON alarm_records(device_id, timestamp);
+CREATE INDEX IF NOT EXISTS idx_alarm_records_ts ON alarm_records(timestamp);
+CREATE INDEX IF NOT EXISTS idx_system_logs_ts ON system_logs(timestamp);
+-- 全部分区的合并视图，封存或删除分区时由程序重建
+CREATE VIEW IF NOT EXISTS monitor_data_all AS SELECT * FROM monitor_data;
+CREATE VIEW IF NOT EXISTS system_logs_all AS SELECT * FROM system_logs;
+PRAGMA user_version = 5;
+
 -- 插入默认管理员账户 (密码: admin123)
 INSERT OR IGNORE INTO users (username, password, email, phone, nickname, role) 
 VALUES ('admin', '240be518fabd2724ddb6f04eeb1da5967448d7e831c08c8fa822809f74c720a9', 'admin@example.com', '13800138000', '系统管理员', 'admin');
@@ -2,6 +2,8 @@
 #define ALARMDISPLAYWINDOW_H
 
 #include <QMainWindow>
+#include <QVariantList>
+#include "asyncqueryexecutor.h"
 
 namespace Ui { class AlarmDisplayWindow; }
 
@@ -12,12 +14,24 @@ public:
     explicit AlarmDisplayWindow(QWidget *parent = nullptr);
     ~AlarmDisplayWindow();
 
+protected:
+    void showEvent(QShowEvent *event) override;
+
 private slots:
     void onFilterChanged();
+    void onTimeRangeChanged();
     void loadAlarms();
 
 private:
     Ui::AlarmDisplayWindow *ui;
+    QueryChannel alarmQueries;
+    QueryCoalescer alarmFilter;  // 时间范围连续变化时合并查询
+    bool alarmsStale = false;   // 隐藏期间有新告警
+
+    // 表格最多显示的告警条数（最新的），超出时提示缩小筛选范围
+    static const int MaxAlarmRows = 1000;
+
+    void showAlarms(const QVariantList &records);
 };
 
 #endif // ALARMDISPLAYWINDOW_H 
\ No newline at end of file
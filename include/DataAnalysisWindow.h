@@ -5,6 +5,7 @@
 #include <QtCharts/QChartView>
 #include <QtCharts/QBarSeries>
 #include <QtCharts/QBarSet>
+#include "asyncqueryexecutor.h"
 
 QT_CHARTS_USE_NAMESPACE
 
@@ -34,6 +35,7 @@ private:
     QChartView* chartView;
     QChart* chart;
     QBarSeries* series;
+    QueryChannel analysisQueries;
 };
 
 #endif // DATAANALYSISWINDOW_H 
\ No newline at end of file
@@ -2,13 +2,17 @@
 #define NETWORKMONITORWINDOW_H
 
 #include <QWidget>
-#include <QTimer>
 #include <QDateTime>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include "databasemanager.h"
+#include "asyncqueryexecutor.h"
 
 QT_CHARTS_USE_NAMESPACE
 
+class RealtimeChart;
+class SampleTableModel;
+
 namespace Ui { class NetworkMonitorWindow; }
 
 class NetworkMonitorWindow : public QWidget
@@ -18,23 +22,29 @@ public:
     explicit NetworkMonitorWindow(QWidget *parent = nullptr);
     ~NetworkMonitorWindow();
 
+protected:
+    // 隐藏时取消实时数据订阅，重新显示时补上最新一条
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
 private slots:
     void onDeviceChanged(int index);
     void onTimeRangeChanged();
     void onExportClicked();
     void refreshRealtimeData();
+    void onLatestSampleChanged(int deviceId, const MonitorSample &sample);
     void queryHistoryData();
 
 private:
     Ui::NetworkMonitorWindow *ui;
-    QTimer *realtimeTimer;
+    qint64 lastRealtimeTimestamp; // 实时图表中最后一个点的时间戳
+    QueryChannel historyQueries;  // 历史查询通道，新请求使旧结果失效
+    QueryCoalescer historyFilter;  // 时间范围连续变化时合并查询
+    QMetaObject::Connection latestConnection;  // 页面可见时有效
+    SampleTableModel *historyModel;            // 历史数据表格：原始数据，滚动时分页读取
     
     // 实时图表
-    QChartView *realtimeChartView;
-    QChart *realtimeChart;
-    QLineSeries *tempSeriesRealtime;
-    QLineSeries *humiditySeriesRealtime;
-    QLineSeries *lightSeriesRealtime;
+    RealtimeChart *realtimeChartView;
 
     // 历史图表
     QChartView *historyChartView;
@@ -43,11 +53,25 @@ private:
     QLineSeries *humiditySeriesHistory;
     QLineSeries *lightSeriesHistory;
 
+    // 后台线程准备好的历史图表数据：降采样后的点（升序）和坐标轴范围
+    struct HistoryData {
+        DatabaseManager::Resolution resolution = DatabaseManager::RawResolution;
+        qint64 firstTimestamp = 0;
+        qint64 lastTimestamp = 0;
+        QVector<QPointF> tempPoints;
+        QVector<QPointF> humidityPoints;
+        QVector<QPointF> lightPoints;
+        double minValue = 0;
+        double maxValue = 0;
+    };
+
     void setupUiElements();
     void setupCharts();
     void loadDeviceList();
-    void updateRealtimeChart(const QVariantMap &data);
-    void updateHistoryUi(const QVariantList &data);
+    void updateRealtimeChart(const MonitorSample &sample);
+    void clearHistoryUi();
+    void updateHistoryUi(int deviceId, const QDateTime &startTime, const QDateTime &endTime);
+    void applyHistoryData(const HistoryData &data);
 };
 
 #endif // NETWORKMONITORWINDOW_H 
\ No newline at end of file
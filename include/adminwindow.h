@@ -11,6 +11,8 @@
 #include <QStackedWidget>
 #include <QToolButton>
 #include <QCloseEvent>
+#include <QVector>
+#include <functional>
 
 // 前向声明
 class DatabaseViewer;
@@ -49,6 +51,7 @@ private slots:
     void onLogoutClicked();
     void onExitClicked();
     void smoothSwitchToPage(int pageIndex);
+    void ensurePage(int pageIndex);
 
 private:
     Ui::AdminWindow *ui;
@@ -60,6 +63,9 @@ private:
     DataAnalysisWindow *dataAnalysisWindow;
     QString currentUsername;
     QButtonGroup* sideBarGroup;
+    QVector<std::function<QWidget*()>> pageFactories;  // 尚未创建的页面，创建后置空
+
+    void addLazyPage(const std::function<QWidget*()>& factory);
 };
 
 #endif // ADMINWINDOW_H 
@@ -0,0 +1,94 @@
+#ifndef ALARMRULEENGINE_H
+#define ALARMRULEENGINE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include "databasemanager.h"
+
+// 编译后的告警条件，例如 "temperature > 30 AND (humidity - 10) * 2 < light"
+// 支持 AND/OR/NOT（及 && || !）、比较运算和对 temperature/humidity/light 的四则运算
+// 条件先解析为带类型检查的语法树，再展开为后缀字节码，求值时不做任何内存分配
+class AlarmCondition
+{
+public:
+    AlarmCondition() : stackDepth(0) {}
+
+    // 编译失败时返回 false，error 中给出出错位置
+    bool compile(const QString& text, QString* error = nullptr);
+    bool isValid() const { return !code.isEmpty(); }
+    bool evaluate(const MonitorSample& sample) const;
+
+    // 校验条件文本，供规则编辑界面使用
+    static bool validate(const QString& text, QString* error = nullptr);
+
+    static const int MaxStackDepth = 32;
+
+private:
+    enum OpCode : quint8 {
+        PushConst, LoadField,
+        Add, Sub, Mul, Div, Neg,
+        Lt, Le, Gt, Ge, Eq, Ne,
+        And, Or, Not
+    };
+    struct Instruction {
+        OpCode op;
+        quint8 field;   // LoadField: 0 温度, 1 湿度, 2 光照
+        double value;   // PushConst
+    };
+    friend class AlarmConditionParser;
+
+    QVector<Instruction> code;
+    int stackDepth;
+};
+
+struct CompiledAlarmRule {
+    int rule_id = 0;
+    int device_id = 0;
+    QString description;
+    QString condition;
+    AlarmCondition compiled;
+};
+
+// 一次规则命中，对应一条 alarm_records 记录
+struct AlarmHit {
+    int rule_id;
+    int device_id;
+    qint64 timestamp;   // 触发样本的时间（epoch ms）
+    QString content;
+};
+
+// 按设备索引的规则集：每个样本只评估所属设备的规则
+// 规则由"不满足"变为"满足"时才产生告警，条件持续满足期间不重复记录
+class AlarmRuleEngine
+{
+public:
+    // 替换全部规则；无法编译的规则被跳过并记入 errors
+    void setRules(const QVector<CompiledAlarmRule>& rules, QStringList* errors = nullptr);
+    // evaluate 改变的规则状态，写入告警记录的事务回滚时交给 restore() 撤销；
+    // 每条规则只记录第一次改变前的状态，同一事务中的多次评估可共用一个 Undo
+    struct Undo {
+        QHash<int, bool> active;   // rule_id -> 评估前是否满足条件
+        int hits = 0;
+    };
+    QVector<AlarmHit> evaluate(const QVector<MonitorSample>& samples, Undo* undo = nullptr);
+    void restore(const Undo& undo);
+    int ruleCount() const;
+
+    // 累计评估次数（自创建起）
+    struct Counters {
+        quint64 samples = 0;       // 评估过的样本数
+        quint64 evaluations = 0;   // 规则条件求值次数
+        quint64 hits = 0;          // 产生的告警数
+    };
+    Counters counters() const;
+
+private:
+    mutable QMutex mutex;
+    Counters totals;
+    QHash<int, QVector<CompiledAlarmRule>> rulesByDevice;
+    QHash<int, bool> activeRules;   // rule_id -> 上一个样本是否满足条件
+};
+
+#endif // ALARMRULEENGINE_H
@@ -0,0 +1,103 @@
+#ifndef ASYNCQUERYEXECUTOR_H
+#define ASYNCQUERYEXECUTOR_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include <functional>
+
+// 一次查询请求的令牌：同一通道发出新请求或被取消后，旧令牌即失效
+class QueryToken
+{
+public:
+    QueryToken() : serial(0) {}
+    QueryToken(const QSharedPointer<QAtomicInt>& generation, int serial)
+        : generation(generation), serial(serial) {}
+
+    // 工作线程在长查询的循环中检查，以便尽早放弃过期的请求
+    bool isCancelled() const { return !generation || generation->load() != serial; }
+
+private:
+    QSharedPointer<QAtomicInt> generation;
+    int serial;
+};
+
+// 每个界面的一类查询使用一个通道，保证只有最后一次请求的结果被应用
+class QueryChannel
+{
+public:
+    QueryChannel() : generation(new QAtomicInt(0)) {}
+
+    QueryToken next() { return QueryToken(generation, generation->fetchAndAddOrdered(1) + 1); }
+    void cancel() { generation->fetchAndAddOrdered(1); }
+
+private:
+    QSharedPointer<QAtomicInt> generation;
+};
+
+// 合并连续的筛选输入：最后一次输入后 delayMs 内没有新输入才发出一次请求，
+// 每次输入都会立即作废通道上进行中的旧查询（工作线程可提前放弃）
+class QueryCoalescer : public QObject
+{
+public:
+    // request 在 GUI 线程中调用，通常通过 channel.next() 提交新的查询
+    QueryCoalescer(QueryChannel& channel, const std::function<void()>& request, int delayMs = 300,
+                   QObject *parent = nullptr);
+
+    // 用户输入时调用
+    void schedule();
+    // 立即发出请求，取消尚未到期的合并请求（如切换设备、首次加载）
+    void runNow();
+    // 放弃尚未发出的请求和进行中的查询
+    void cancel();
+    bool isPending() const { return timer.isActive(); }
+
+private:
+    QueryChannel& channel;
+    const std::function<void()> request;
+    QTimer timer;
+};
+
+// 在后台线程池中执行数据库查询，结果回到 context 所在的 GUI 线程
+// 工作线程通过 DatabaseManager::connection() 使用各自的 SQLite 连接
+class AsyncQueryExecutor : public QObject
+{
+    Q_OBJECT
+public:
+    static AsyncQueryExecutor& instance();
+
+    // work 在线程池中执行；context 被销毁或令牌失效时丢弃结果
+    template <typename T>
+    void submit(QObject* context, const QueryToken& token,
+                const std::function<T()>& work,
+                const std::function<void(const T&)>& onResult)
+    {
+        QFutureWatcher<T>* watcher = new QFutureWatcher<T>(context);
+        QPointer<QObject> guard(context);
+        connect(watcher, &QFutureWatcher<T>::finished, watcher, [watcher, guard, token, onResult]() {
+            if (guard && !token.isCancelled()) {
+                onResult(watcher->result());
+            }
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run(&pool, [token, work]() -> T {
+            return token.isCancelled() ? T() : work();
+        }));
+    }
+
+    // 等待所有已提交的查询结束（程序退出前调用）
+    void waitForDone();
+
+private:
+    explicit AsyncQueryExecutor(QObject *parent = nullptr);
+    ~AsyncQueryExecutor();
+
+    QThreadPool pool;
+};
+
+#endif // ASYNCQUERYEXECUTOR_H
@@ -0,0 +1,16 @@
+#ifndef CHARTDOWNSAMPLER_H
+#define CHARTDOWNSAMPLER_H
+
+#include <QVector>
+#include <QPointF>
+
+// 折线图降采样：数据点远多于屏幕像素时，只保留决定折线形状的点，绘制开销只取决于图表宽度
+namespace ChartDownsampler
+{
+    // Largest-Triangle-Three-Buckets：首尾点保留，其余按 x 顺序均分为 threshold - 2 个桶，
+    // 每桶取与上一个选中点、下一桶均值点构成三角形面积最大的点，尖峰会被保留。
+    // points 需按 x 升序；点数不超过 threshold（或 threshold < 3）时原样返回
+    QVector<QPointF> lttb(const QVector<QPointF>& points, int threshold);
+}
+
+#endif // CHARTDOWNSAMPLER_H
@@ -0,0 +1,27 @@
+#ifndef CHUNKCODEC_H
+#define CHUNKCODEC_H
+
+#include <QByteArray>
+#include <QVector>
+#include "databasemanager.h"
+
+// 监控数据分块压缩（Gorilla 编码），monitor_chunks 表的 data 列
+//
+// 格式：u32 条数 n | i64 第一条时间戳 | 3 × f64 第一条数值 | 位流
+//   时间戳：二阶差分 dod，0 → '0'；否则 zigzag 后按 7/9/12/32 位分档，前缀 '10'/'110'/'1110'/'11110'，
+//           更大的 '11111' + 64 位
+//   数值：与同一指标上一条数值的位模式异或，0 → '0'；否则 '1' 后接
+//         '0' + 沿用上一次前导零/有效位窗口的有效位，或
+//         '1' + 5 位前导零数 + 6 位有效位数（64 记为 0）+ 有效位
+//   每条依次写时间戳、温度、湿度、光照
+namespace ChunkCodec
+{
+    const int HeaderSize = 4 + 8 + 3 * 8;
+
+    // samples 需按时间升序
+    QByteArray encode(const MonitorSample* samples, int count);
+    // device_id 不在编码内容中，由调用方填入；数据损坏时返回 false，samples 保留已解出的部分
+    bool decode(const QByteArray& data, int device_id, QVector<MonitorSample>& samples);
+}
+
+#endif // CHUNKCODEC_H
@@ -0,0 +1,70 @@
+#ifndef CSVEXPORTER_H
+#define CSVEXPORTER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVariantList>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <functional>
+
+class QWidget;
+
+// CSV 导出：后台线程中逐行读取数据源，经缓冲（可选 gzip/zstd 压缩）写入文件，
+// 内存占用与行数无关；可显示进度、随时取消，取消或失败时删除不完整的文件
+class CsvExporter : public QObject
+{
+    Q_OBJECT
+public:
+    enum Compression { NoCompression, Gzip, Zstd };
+
+    // 每行回调，返回 false 表示停止（已取消或写入失败）
+    typedef std::function<bool(const QVariantList&)> RowCallback;
+    // 数据源：在工作线程中调用，逐行交给回调，出错时返回 false 并填写 error
+    typedef std::function<bool(const RowCallback&, QString& error)> RowSource;
+
+    struct Request {
+        QString fileName;
+        QStringList headers;
+        RowSource source;
+        Compression compression = NoCompression;
+        qint64 expectedRows = -1;   // 仅用于显示进度，未知时为 -1
+    };
+
+    explicit CsvExporter(QObject *parent = nullptr);
+    ~CsvExporter();
+
+    // 已有导出在进行时返回 false
+    bool start(const Request& request);
+    void cancel();
+    bool isRunning() const;
+    bool isCancelled() const;
+
+    // 以 forward-only 方式流式读取一条 SELECT 的结果
+    static RowSource querySource(const QString& sql, const QVariantList& bindValues = QVariantList());
+    // 按文件扩展名（.gz / .zst）选择压缩方式
+    static Compression compressionForFile(const QString& fileName);
+    static bool isSupported(Compression compression);
+    // 保存对话框的文件类型过滤器，只列出本次构建支持的压缩格式
+    static QString fileFilter();
+
+    // 带进度对话框的导出：选择文件、显示进度并可取消，结束时提示结果；request.fileName 为空时弹出保存对话框
+    static void exportWithDialog(QWidget *parent, const QString& title, Request request);
+
+signals:
+    void progress(qint64 rows, qint64 expectedRows);
+    void finished(bool ok, qint64 rows, const QString& error);
+
+private:
+    struct Result {
+        bool ok = false;
+        qint64 rows = 0;
+        QString error;
+    };
+    Result run(const Request& request);
+
+    QFutureWatcher<Result> watcher;
+    QAtomicInt cancelled;
+};
+
+#endif // CSVEXPORTER_H
@@ -7,7 +7,52 @@
 #include <QSqlQuery>
 #include <QDateTime>
 #include <QVariantMap>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QScopedPointer>
+#include <QAtomicPointer>
+#include <QTimer>
+#include <QThread>
 #include <QDebug>
+#include <functional>
+#include "querystats.h"
+
+// 单条监控采样（批量写入、流式读取使用）
+struct MonitorSample {
+    int device_id = 0;
+    qint64 timestamp = 0;   // 毫秒时间戳（epoch ms）
+    double temperature = 0;
+    double humidity = 0;
+    double light = 0;
+};
+Q_DECLARE_TYPEINFO(MonitorSample, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(MonitorSample)
+
+// 单设备单指标的统计结果（SQL 聚合）
+struct MetricStatistics {
+    int device_id = 0;
+    QString device_name;
+    qint64 count = 0;
+    double min = 0;
+    double max = 0;
+    double avg = 0;
+    double stddev = 0;   // 总体标准差；部分范围已超过原始数据保留期、由汇总表统计时为 -1（汇总表不保存平方和）
+    bool approximate = false;   // 范围两端落在汇总桶中间且没有更细的数据，按整桶统计（含范围外的样本）
+};
+
+// 流式读取回调，返回 false 时提前结束遍历
+typedef std::function<bool(const MonitorSample&)> MonitorSampleCallback;
+
+class AlarmRuleEngine;
+struct AlarmHit;
+class StatementCache;
+class WriteBehindQueue;
+struct PendingWrite;
+class LogWriter;
+struct LogEntry;
 
 class DatabaseManager : public QObject
 {
@@ -19,12 +64,94 @@ public:
         static DatabaseManager instance;
         return instance;
     }
-    bool initDatabase();
+    // path 为空时使用当前目录下的 internetmonitoring.db
+    bool initDatabase(const QString& path = QString());
+    // 定期检查其他进程（如采集服务）的写入，刷新最新数据和设备缓存
+    void watchExternalChanges(int intervalMs);
+
+    // 历史数据读取粒度：原始数据或 1分钟/1小时/1天 汇总
+    enum Resolution { RawResolution = 0, MinuteResolution, HourResolution, DayResolution };
+    // 选择桶数仍不少于 maxPoints 的最粗粒度；maxPoints <= 0 时返回原始数据
+    static Resolution pickResolution(const QDateTime& startTime, const QDateTime& endTime, int maxPoints);
 
     // 数据库状态
     bool isConnected() const { return connected; }
-    QString lastError() const { return lastErrorMsg; }
-    void clearError() { lastErrorMsg.clear(); }
+    QString databasePath() const { return dbPath; }
+    QString lastError() const;
+    void clearError();
+
+    // 当前线程使用的连接：主线程为默认连接，其他线程各自持有一个命名连接
+    // 所有成员函数都可以在后台线程（见 AsyncQueryExecutor）中调用
+    QSqlDatabase connection();
+    // 当前线程的连接对应的语句缓存，与 connection() 一起传给 InstrumentedQuery
+    StatementCache* statements();
+
+    // 同步级别（PRAGMA synchronous），对主连接立即生效，其他线程的连接在下次使用时生效
+    enum Durability { DurabilityFull = 0, DurabilityNormal, DurabilityOff };
+    void setDurability(Durability level);
+    Durability durability() const;
+
+    // SQLite 运行参数（始终使用 WAL）。pageSize 只对新建的数据库生效；其余参数在 initDatabase 或
+    // setTuningProfile 时应用于主连接，其他线程的连接在下次使用时应用
+    struct TuningProfile {
+        QString name;
+        Durability durability = DurabilityFull;  // 通过 setDurability 应用
+        int cacheSizeKb = 2000;                  // cache_size（每个连接）
+        qint64 mmapSizeBytes = 0;                // mmap_size，0 表示不使用内存映射
+        bool tempStoreMemory = false;            // temp_store=MEMORY：排序和临时表放在内存中
+        int pageSize = 4096;                     // 新建数据库的 page_size
+        int walAutoCheckpointPages = 1000;       // wal_autocheckpoint，0 表示由提交的连接不再自动做检查点
+        qint64 journalSizeLimitBytes = -1;       // journal_size_limit：检查点后 WAL 文件保留的大小，-1 不限制
+        int busyTimeoutMs = 5000;                // busy_timeout
+        // 检查点线程：每 checkpointIntervalMs 毫秒做一次 PASSIVE 检查点，WAL 超过 walLimitBytes 时
+        // 改用 TRUNCATE（等待读者结束后截断文件），避免持续写入和长读事务使 WAL 无限增长；0 表示不启动
+        int checkpointIntervalMs = 0;
+        qint64 walLimitBytes = 64 * 1024 * 1024;
+    };
+    // 预置的配置：default（SQLite 默认值）、interactive（界面程序）、ingest（持续写入）、bulk（批量导入）
+    static QStringList tuningProfileNames();
+    static bool findTuningProfile(const QString& name, TuningProfile& profile);
+    void setTuningProfile(const TuningProfile& profile);
+    TuningProfile tuningProfile() const;
+    // 立即做一次检查点（检查点线程调用），可在任意线程调用
+    bool checkpointWal();
+    struct CheckpointStats {
+        quint64 passive = 0;          // PASSIVE 检查点次数
+        quint64 truncate = 0;         // 因 WAL 超限执行的 TRUNCATE 检查点次数
+        quint64 busy = 0;             // 因读者或写者占用未能完成的次数
+        qint64 walBytes = 0;          // 最近一次检查点前的 WAL 文件大小
+        qint64 peakWalBytes = 0;      // 观察到的最大 WAL 文件大小
+    };
+    CheckpointStats checkpointStats() const;
+
+    // 延迟写入：开启后 addMonitorData/addMonitorDataBatch/addAlarmRecord 只入队并立即返回，
+    // 由单个写线程每 maxRows 条或每 maxDelayMs 毫秒合并为一个事务提交；积压超过 maxPending 时丢弃。
+    // 应在没有其他线程写入时调用（启动或退出阶段）；关闭时先提交队列中剩余的数据
+    void setWriteBehind(bool enabled, int maxRows = 1000, int maxDelayMs = 50, int maxPending = 1000000);
+    bool isWriteBehind() const;
+    // 等待此前入队的写入全部提交（需要读到自己写入的数据时调用）；未开启延迟写入时直接返回 true
+    bool flushWrites(int timeoutMs = -1);
+    struct WriteBehindStats {
+        quint64 committed = 0;      // 已提交的条数
+        quint64 failed = 0;         // 写入失败的条数
+        quint64 dropped = 0;        // 因积压被丢弃的条数
+        quint64 transactions = 0;   // 提交的事务数
+        int pending = 0;            // 队列中尚未提交的条数
+    };
+    WriteBehindStats writeBehindStats() const;
+
+    // 调试辅助：返回 EXPLAIN QUERY PLAN 的 detail 列
+    QStringList explainQueryPlan(const QString& sql, const QVariantList& bindValues = QVariantList());
+
+    // 查询统计：本类执行的每条语句按模板汇总次数、延迟分布、行数和解码字节数（见 querystats.h）
+    QVector<QueryStatsEntry> queryStatistics() const;
+    void resetQueryStatistics();
+    // 每个连接缓存已 prepare 的语句（按 SQL 文本，LRU 淘汰，见 StatementCache），capacity 为每个连接的条数，0 表示关闭
+    void setStatementCacheCapacity(int capacity);
+    int statementCacheCapacity() const;
+    // 单次执行超过 ms 毫秒的语句连同查询计划写入 system_logs（每个模板每分钟最多一条），0 表示关闭
+    void setSlowQueryThreshold(int ms);
+    int slowQueryThreshold() const;
 
     // 事务控制
     bool beginTransaction();
@@ -53,26 +180,84 @@ public:
     QVariantList getDevices();
     bool getDeviceIdByName(const QString& name, int& device_id);
     bool getDeviceById(int device_id, QVariantMap& device);
+    // 设备名称，设备不存在时返回"未知设备"
+    QString deviceName(int device_id);
+    // 设备表可能被其他进程修改时强制下次读取重新加载
+    void invalidateDeviceCache();
 
     // 监控数据
     bool addMonitorData(int device_id, const QDateTime& timestamp,
                        double temperature, double humidity, double light);
-    QVariantList getDeviceData(int device_id, const QDateTime& startTime, const QDateTime& endTime);
+    // 批量写入：单个事务 + 单次prepare + execBatch；failedRows 返回写入失败的下标
+    bool addMonitorDataBatch(const QVector<MonitorSample>& samples, QVector<int>* failedRows = nullptr);
+    // maxPoints > 0 时按 pickResolution 自动改读汇总表（每桶取平均值）
+    QVariantList getDeviceData(int device_id, const QDateTime& startTime, const QDateTime& endTime, int maxPoints = 0);
+    // 只进游标：逐行解码为 MonitorSample 并回调，不物化整个结果集
+    bool forEachDeviceSample(int device_id, const QDateTime& startTime, const QDateTime& endTime,
+                             const MonitorSampleCallback& callback, Qt::SortOrder order = Qt::AscendingOrder,
+                             int maxPoints = 0);
+    // 分块存储：开启后后台线程每 compactIntervalMs 毫秒把已结束超过一小时的整点小时内的原始数据按设备
+    // 压缩进 monitor_chunks（见 ChunkCodec）并从 monitor_data 删除；读取接口对两种存储透明
+    void setChunkStorage(bool enabled, int compactIntervalMs = 60000);
+    bool isChunkStorage() const { return compactThread != nullptr; }
+    // 压缩 beforeMs 所在小时之前的原始数据，返回移入分块的条数，失败返回 -1；可在任意线程调用
+    int compactMonitorData(qint64 beforeMs);
+    // 数据保留策略（天），keepDays <= 0 表示永久保留；table 为 monitor_data（含分块存储）、
+    // monitor_rollup_1m/1h/1d 或 system_logs。默认原始数据 30 天、分钟汇总 365 天、日志 90 天
+    void setRetentionPolicy(const QString& table, int keepDays);
+    int retentionPolicy(const QString& table) const;
+    // 分区维护：开启后后台线程每 intervalMs 毫秒把 monitor_data/system_logs 中已结束的一天（UTC）
+    // 改名封存为 <表名>_pYYYYMMDD 分区并新建当前表，过期分区整表 DROP；应只在一个进程中开启。
+    // 跨分区查询由本类内部按时间范围路由，其他场合使用 monitor_data_all/system_logs_all 视图
+    void setPartitionMaintenance(bool enabled, int intervalMs = 60000);
+    // 封存已结束的分区并执行保留策略，可在任意线程调用
+    bool maintainPartitions();
+    // 由本类内部维护的表（已封存分区、汇总表、分块存储、分区登记表），不应直接浏览或编辑
+    static bool isInternalTable(const QString& table);
+    // 每台设备最新一条数据的内存缓存，写入时更新，O(1) 查询
+    bool latestSample(int device_id, MonitorSample& sample) const;
+    // 全部设备的最新数据（隐式共享的副本，只在复制时短暂持锁）
+    QHash<int, MonitorSample> latestSamplesSnapshot() const;
+    // 本进程自启动以来成功写入的监控数据条数
+    quint64 samplesWritten() const { return writtenSamples.loadRelaxed(); }
+    // 按设备分组的 MIN/MAX/AVG/COUNT/STDDEV，一次查询完成；metric: temperature/humidity/light，device_id=-1 表示所有设备。
+    // 原始数据已被保留策略删除的时段改用汇总表（选仍保留该时段的最细一级），分界取执行保留策略时记录的实际删除位置
+    QVector<MetricStatistics> getMetricStatistics(const QString& metric, const QDateTime& startTime,
+                                                  const QDateTime& endTime, int device_id = -1);
 
     // 告警规则
     bool addAlarmRule(int device_id, const QString& description, const QString& condition, const QString& action);
     bool updateAlarmRule(int rule_id, int device_id, const QString& description, const QString& condition, const QString& action);
     bool deleteAlarmRule(int rule_id);
+    // device_id=-1 表示所有设备；每条规则带 device_name
     QVariantList getAlarmRules(int device_id);
+    // 告警规则评估的累计次数
+    struct AlarmStats {
+        int rules = 0;
+        quint64 samples = 0;       // 评估过的样本数
+        quint64 evaluations = 0;   // 规则条件求值次数
+        quint64 raised = 0;        // 产生的告警数
+    };
+    AlarmStats alarmStats() const;
 
     // 告警记录
     bool addAlarmRecord(int device_id, const QDateTime& timestamp, const QString& content, const QString& status, const QString& note);
     QVariantList getAlarmRecords(int device_id);
-    QVariantList getAlarmRecordsFiltered(int device_id, const QString& status, const QDateTime& startTime, const QDateTime& endTime);
+    // 每条记录带 device_name，按时间倒序；limit > 0 时只返回最新的 limit 条
+    QVariantList getAlarmRecordsFiltered(int device_id, const QString& status, const QDateTime& startTime, const QDateTime& endTime,
+                                         int limit = -1);
 
-    // 系统日志
+    // 系统日志：initDatabase 之后由后台线程批量写入，addLog 只放入内存缓冲；缓冲满时丢弃并返回 false
     bool addLog(const QString& log_type, const QString& log_level, const QString& content,
                 int user_id = -1, int device_id = -1);
+    // 等待已提交的日志写入数据库；getLogs 会先调用
+    bool flushLogs(int timeoutMs = -1);
+    struct LogStats {
+        quint64 written = 0;   // 已写入的条数
+        quint64 failed = 0;    // 写入失败的条数
+        quint64 dropped = 0;   // 缓冲满时丢弃的条数
+    };
+    LogStats logStats() const;
     QVariantList getLogs(const QDateTime& startTime = QDateTime(), const QDateTime& endTime = QDateTime());
 
     // 设备分组管理
@@ -88,6 +273,10 @@ signals:
     void databaseError(const QString& error);
     void databaseConnected();
     void databaseDisconnected();
+    // 某台设备的最新数据发生变化（写入了更新的采样）
+    void latestSampleChanged(int device_id, const MonitorSample& sample);
+    // 告警规则由新写入的数据触发，已写入 alarm_records
+    void alarmRaised(int device_id, qint64 timestamp, const QString& content);
 
 private:
     DatabaseManager(QObject *parent = nullptr);
@@ -96,13 +285,116 @@ private:
     DatabaseManager& operator=(const DatabaseManager&) = delete;
 
     bool createTables();
+    bool createIndexes();
     bool dropTables();
+
+    // 表结构版本（PRAGMA user_version）及升级
+    int schemaVersion();
+    bool setSchemaVersion(int version);
+    bool migrateSchema();
+    bool migrateToV1();   // DATETIME文本 -> 毫秒时间戳，并建立时间索引
+    bool migrateToV2();   // 建立并回填汇总表
+    bool migrateToV3();   // 建立分块存储表
+    bool migrateToV4();   // 分区元数据表及跨分区视图
+    bool migrateToV5();   // 保留策略执行位置表
+    static QString monitorDataTableSql(const QString& table);
+    static QString alarmRecordsTableSql(const QString& table);
+    static QString systemLogsTableSql(const QString& table);
+    static QString monitorChunksTableSql(const QString& table);
+    int compactChunkWindow(int device_id, qint64 windowStart);
+
+    // 按时间分区的表：当前表 + 已封存的分区，分区范围记录在 table_partitions
+    static const char* const partitionedTables[2];
+    // 与 [startMs, endMs] 有交集的已封存分区（按时间先后），最后一项为当前表
+    QStringList partitionTables(const QString& base, qint64 startMs, qint64 endMs);
+    bool sealPartition(const QString& base, qint64 periodStart);
+    bool dropExpiredPartitions(const QString& base, qint64 cutoff);
+    bool rebuildPartitionView(const QString& base);
+    bool applyRetention();
+    // 保留策略执行前记录 table 从 retainedFrom 起的数据完整保留（只前移）；retainedFrom() 未执行过时返回最小时间戳
+    bool recordRetention(const QString& table, qint64 retainedFrom);
+    qint64 retainedFrom(const QString& table);
+
+    // 监控数据汇总表（写入时增量维护）
+    struct RollupTable {
+        const char* table;
+        qint64 bucketMs;
+    };
+    static const int rollupTableCount = 3;
+    static const RollupTable rollupTables[rollupTableCount];
+    static const char* const rollupMetrics[3];
+    static QString rollupTableSql(const QString& table);
+    static QString rollupUpsertSql(const QString& table);
+    bool updateRollups(const QVector<MonitorSample>& samples);
+
+    // 最新数据缓存
+    bool loadLatestSamples();
+    void checkExternalChanges();
+    void updateLatestSamples(const QVector<MonitorSample>& samples);
+
+    // 设备信息缓存：getDevices/getDeviceById 等直接读缓存，设备增删改时失效
+    bool loadDeviceCache();
+
+    // 告警规则：启动及规则变更时编译；写入监控数据时评估，命中的告警记录与样本在同一事务中写入，
+    // 事务回滚时撤销规则状态（AlarmRuleEngine::restore），提交后才发出 alarmRaised
+    bool loadAlarmRules();
+    bool insertAlarmHits(const QVector<AlarmHit>& hits);
+    void announceAlarms(const QVector<AlarmHit>& hits);
+
+    // 同步写入路径；延迟写入模式下由写线程调用
+    bool writeMonitorDataBatch(const QVector<MonitorSample>& samples, QVector<int>* failedRows);
+    bool insertRows(const QString& sql, const QVector<QVariantList>& columns);
+    // 写线程的提交函数：整批在一个事务中写入，返回失败的条数
+    int commitPendingWrites(const QVector<PendingWrite>& batch);
+    // 日志线程的提交函数
+    bool writeLogs(const QVector<LogEntry>& entries);
+
     bool executeQuery(const QString& sql);
+    // 提交 conn 上的事务；在其他线程提交成功时计入 localCommits
+    bool commitConnection(QSqlDatabase conn);
+    void noteLocalCommit();
+    // 把 profile 中按连接生效的参数应用于 connection，失败返回 false
+    static bool applyTuning(const QSqlDatabase& connection, const TuningProfile& profile);
+    void startCheckpointThread(const TuningProfile& profile);
     void setLastError(const QString& error);
+    void logSlowQuery(const QString& sql, const QVariantList& bindValues, qint64 micros);
+
+    static const int SCHEMA_VERSION = 5;
 
     QSqlDatabase db;
+    QString dbPath;
     bool connected;
+    mutable QMutex errorMutex;
     QString lastErrorMsg;
+    mutable QReadWriteLock latestLock;
+    QHash<int, MonitorSample> latestSamples;
+    QAtomicInteger<quint64> writtenSamples;
+    mutable QReadWriteLock deviceLock;
+    bool deviceCacheValid;
+    QMap<int, QVariantMap> deviceCache;  // 按 device_id 有序
+    QTimer* changeTimer;
+    qint64 dataVersion;                  // 上次检查时的 PRAGMA data_version
+    QAtomicInteger<quint64> localCommits;  // 本进程写线程/日志线程/维护线程的提交次数
+    quint64 checkedLocalCommits;         // 上次检查时的 localCommits
+    int skippedChanges;                  // 连续按本进程写入跳过重新加载的次数
+    QScopedPointer<AlarmRuleEngine> alarmEngine;
+    QScopedPointer<StatementCache> statementCache;   // 主连接的语句缓存
+    QAtomicPointer<WriteBehindQueue> writeQueue;   // 未开启延迟写入时为空
+    QAtomicInt durabilityLevel;
+    QScopedPointer<LogWriter> logWriter;          // initDatabase 成功后创建
+    QThread* compactThread;                       // 未开启分块存储时为空
+    QThread* partitionThread;                     // 未开启分区维护时为空
+    QThread* checkpointThread;                    // 当前配置不需要检查点线程时为空
+    mutable QMutex tuningMutex;
+    TuningProfile tuning;
+    QAtomicInt tuningGeneration;                  // 每次 setTuningProfile 加一，线程连接据此重新应用参数
+    QAtomicInteger<quint64> checkpointPassive;
+    QAtomicInteger<quint64> checkpointTruncate;
+    QAtomicInteger<quint64> checkpointBusy;
+    QAtomicInteger<qint64> lastWalBytes;
+    QAtomicInteger<qint64> peakWalBytes;
+    mutable QMutex retentionMutex;
+    QHash<QString, int> retentionDays;
 };
 
 #endif // DATABASEMANAGER_H 
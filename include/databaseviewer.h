@@ -2,7 +2,7 @@
 #define DATABASEVIEWER_H
 
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QComboBox>
 #include <QPushButton>
 #include <QVBoxLayout>
@@ -14,6 +14,7 @@
 #include <QMap>
 #include <QVariantMap>
 #include "UserEditDialog.h"
+#include "keysettablemodel.h"
 
 class DatabaseViewer : public QWidget
 {
@@ -31,12 +32,13 @@ private slots:
     void onDeleteClicked();
     void onEditClicked();
     void onSaveChangesClicked();
-    void onCellChanged(int row, int column);
     void onCellDoubleClicked(int row, int column);
 
 private:
     void setupUI();
     void loadTableData(const QString& tableName);
+    void updateStatus();
+    QString cellText(int row, int column) const;
     void displayUsers();
     void displayDevices();
     void displayMonitorData();
@@ -58,11 +60,13 @@ private:
     QPushButton *addButton;
     QPushButton *deleteButton;
     QPushButton *saveButton;
-    QTableWidget *dataTable; // 数据表格
+    QTableView *dataTable; // 数据表格
+    KeysetTableModel *tableModel; // 按页增量读取的表格模型
     QLabel *statusLabel; // 状态标签
     QStringList customTables;   // 自定义表
     QMap<int, QVariantMap> changedRows; // 跟踪已更改的行
     bool m_readonly = false;
+    QString currentTable;       // 当前显示的表
 };
 
 #endif // DATABASEVIEWER_H 
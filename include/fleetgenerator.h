@@ -0,0 +1,96 @@
+#ifndef FLEETGENERATOR_H
+#define FLEETGENERATOR_H
+
+#include <QString>
+#include <QVector>
+#include <QVariantList>
+#include "databasemanager.h"
+
+// 合成设备群数据：按种子确定性地生成设备分组、设备、monitor_data（昼夜变化 + 噪声 +
+// 离线缺口 + 乱序到达）以及对应的 alarm_records / system_logs，用于压测和界面测试
+// 同样的参数和种子总是得到逐行相同的数据库；生成在线程池中并行，写入仍由单个连接按固定顺序完成
+class FleetGenerator
+{
+public:
+    struct Options {
+        quint64 seed = 42;
+        int groups = 20;
+        int devices = 1000;
+        qint64 startMs = 0;           // 起始时间（含）
+        qint64 endMs = 0;             // 结束时间（不含）
+        int intervalMs = 60000;       // 每台设备的采样间隔
+        int windowMinutes = 0;        // 每批生成/写入的时间窗口，0 表示按约 50 万条自动选择
+        double gapRate = 0.05;        // 每台设备每天出现一次离线的概率
+        double lateRate = 0.01;       // 延迟到达（乱序写入）的样本比例
+        double spikeRate = 0.0005;    // 传感器毛刺（通常会触发告警）的样本比例
+        int utcOffsetHours = 8;       // 昼夜曲线使用的本地时区
+        int threads = 0;              // 0 表示使用全部核心
+    };
+
+    struct Stats {
+        qint64 samples = 0;
+        qint64 alarms = 0;
+        qint64 logs = 0;
+        qint64 elapsedMs = 0;
+    };
+
+    explicit FleetGenerator(const Options& options);
+
+    // 数据库须已通过 DatabaseManager::initDatabase 打开且为空
+    bool run();
+    const Stats& stats() const { return totals; }
+    QString lastError() const { return error; }
+
+private:
+    // 每台设备固定的特征，由种子和设备序号决定
+    struct Profile {
+        int deviceId = 0;
+        bool outdoor = false;
+        double baseTemperature = 0;
+        double temperatureAmplitude = 0;
+        double baseHumidity = 0;
+        double humidityAmplitude = 0;
+        double lightPeak = 0;
+        double noise = 0;
+        double alarmThreshold = 0;
+        int phaseMinutes = 0;        // 最高温时刻相对 14 点的偏移
+        int offsetMs = 0;            // 采样时刻相对整间隔的固定偏移，避免所有设备同时上报
+    };
+
+    struct Sample {
+        MonitorSample sample;
+        qint64 arrival = 0;          // 到达时间，写入顺序按它排序
+    };
+
+    // 一台设备在一个时间窗口内生成的全部数据
+    struct Slice {
+        QVector<Sample> samples;
+        QVector<QVariantList> alarms;  // device_id, timestamp, content, status, note
+        QVector<QVariantList> logs;    // timestamp, log_type, log_level, content, user_id, device_id
+    };
+
+    // 一个时间窗口内全部设备的数据，样本按到达时间排序；告警和日志按列存放，便于 execBatch
+    struct Window {
+        QVector<MonitorSample> samples;
+        QVector<QVariantList> alarmColumns;
+        QVector<QVariantList> logColumns;
+    };
+
+    bool writeFleet();
+    Slice generateSlice(int deviceIndex, qint64 windowStart, qint64 windowEnd) const;
+    Window mergeSlices(const QVector<Slice>& slices) const;
+    bool writeWindow(const Window& window);
+    bool insertRows(const char* sql, const QVector<QVariantList>& columns);
+    // 某台设备某一天的离线区间，没有时返回 false
+    bool outage(int deviceIndex, qint64 day, qint64& begin, qint64& end) const;
+    // 设备第 k 个采样点，只取决于种子、设备和 k，与窗口划分和线程数无关
+    Sample sampleAt(int deviceIndex, qint64 k) const;
+    quint64 streamSeed(quint64 a, quint64 b, quint64 c) const;
+
+    Options options;
+    QVector<Profile> profiles;
+    Stats totals;
+    QString error;
+};
+
+#endif // FLEETGENERATOR_H
@@ -0,0 +1,52 @@
+#ifndef INGESTSERVER_H
+#define INGESTSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "databasemanager.h"
+
+// 传感器数据采集服务：监听 TCP/UDP，解析 SensorProtocol 格式的数据，
+// 校验设备编号后交给 DatabaseManager 的延迟写入队列，由写线程组提交
+class IngestServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit IngestServer(QObject *parent = nullptr);
+
+    // 端口为 0 时不启用对应协议
+    bool listen(const QHostAddress& address, quint16 tcpPort, quint16 udpPort);
+    // 重新读取设备表（设备可能由界面程序新增）
+    void reloadDevices();
+
+private slots:
+    void onNewConnection();
+    void onUdpReadyRead();
+    void printStats();
+
+private:
+    void readTcp(QTcpSocket *socket);
+    void accept(QVector<MonitorSample>& samples, int malformed);
+
+    QTcpServer tcpServer;
+    QUdpSocket udpSocket;
+    QHash<QTcpSocket*, QByteArray> buffers;  // 每个连接未处理完的数据
+    QSet<int> knownDevices;
+    QVector<MonitorSample> parsed;           // 解析用的临时缓冲，避免重复分配
+    QTimer deviceTimer;
+    QTimer statsTimer;
+    QElapsedTimer deviceReloadClock;
+
+    quint64 received;
+    quint64 malformedCount;
+    quint64 unknownDeviceCount;
+    quint64 lastWritten;
+};
+
+#endif // INGESTSERVER_H
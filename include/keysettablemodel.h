@@ -0,0 +1,78 @@
+#ifndef KEYSETTABLEMODEL_H
+#define KEYSETTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include "asyncqueryexecutor.h"
+
+// 只读表格模型：按主键分页（keyset 分页）增量读取，视图滚动到底部时再取下一页
+// 只缓存最近访问的若干页数据，其余页只记录首行主键，需要时按主键重新读取
+// 因此内存占用与表大小无关，每页查询都走主键索引，不随翻页深度变慢。
+// 各页在 AsyncQueryExecutor 的线程池中读取：下一页返回后再插入行，已淘汰的页在返回前显示为空，返回后刷新
+class KeysetTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit KeysetTableModel(QObject *parent = nullptr);
+
+    // columns 为 SELECT 表达式，第一列必须是整数主键 keyColumn
+    void setQuery(const QString& table, const QString& keyColumn, const QStringList& columns,
+                  const QStringList& headers, Qt::SortOrder order = Qt::AscendingOrder);
+    // 重新从第一页开始读取
+    void refresh();
+    // 按当前排序读取全部行的 SELECT（用于导出），未设置查询时为空
+    QString fullSql() const;
+    QStringList headerLabels() const { return headers; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    // Qt::UserRole 返回原始值（未转为字符串）
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    static const int PageSize = 256;
+    static const int MaxCachedPages = 16;
+
+private:
+    typedef QVector<QVariantList> PageRows;
+    struct PageResult {
+        PageRows rows;
+        bool ok = false;
+    };
+
+    QString pageSql(bool bounded, bool inclusive) const;
+    // 在工作线程中执行
+    static PageResult queryPage(const QString& table, const QString& sql, bool bounded, qint64 bound, int columnCount);
+    void appendPage(const PageResult& result);
+    // 已缓存时直接返回；已被淘汰的页发出异步读取并返回 nullptr
+    const PageRows* page(int index) const;
+    void reloadPage(int index, const PageResult& result);
+    void cachePage(int index, const PageRows& rows) const;
+
+    QString table;
+    QString keyColumn;
+    QStringList columns;
+    QStringList headers;
+    Qt::SortOrder order;
+
+    QVector<qint64> pageFirstKeys;  // 每个已读取页的首行主键
+    qint64 lastKey;                 // 已读取的最后一行主键
+    int rows;
+    bool atEnd;
+    bool fetching;                  // 下一页正在读取
+    QueryChannel queries;
+    QueryToken generation;          // refresh 时更新，旧查询的页结果随之失效
+
+    mutable QHash<int, PageRows> pages;  // 页号 -> 解码后的行
+    mutable QList<int> recentPages;      // 最近访问的页号，最前为最新
+    mutable QSet<int> reloadingPages;    // 正在重新读取的已淘汰页
+};
+
+#endif // KEYSETTABLEMODEL_H
@@ -0,0 +1,58 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <random>
+#include "databasemanager.h"
+
+// 模拟 N 台设备按固定频率向采集服务发送数据，用于压测 IngestServer
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options {
+        QString host = "127.0.0.1";
+        quint16 port = 9500;
+        bool udp = false;
+        bool binary = false;
+        int devices = 100;
+        int firstDevice = 1;
+        double rate = 10;      // 每台设备每秒条数
+        int durationSec = 60;  // 0 表示一直运行
+    };
+
+    explicit LoadGenerator(const Options& options, QObject *parent = nullptr);
+    void start();
+
+signals:
+    void finished();
+
+private slots:
+    void tick();
+
+private:
+    void send(const QVector<MonitorSample>& samples);
+    void report(bool final);
+
+    Options options;
+    QTcpSocket tcpSocket;
+    QUdpSocket udpSocket;
+    QHostAddress address;
+    QTimer timer;
+    QElapsedTimer clock;
+    qint64 sent;
+    qint64 skipped;          // 发送缓冲积压时少发的条数
+    qint64 lastReportMs;
+    qint64 lastReportSent;
+    int nextDevice;
+    QVector<MonitorSample> state;   // 每台设备当前的模拟值
+    std::mt19937 random;
+};
+
+#endif // LOADGENERATOR_H
@@ -6,6 +6,7 @@
 #include <QDebug>
 #include <QTimer>
 #include <QDateTime>
+#include <QAtomicInt>
 
 class LoginManager : public QObject
 {
@@ -41,6 +42,8 @@ public:
     void setSessionTimeout(int minutes);
     int getSessionTimeout() const;
     QDateTime getLastActivityTime() const { return lastActivityTime; }
+    // 当前进程中已登录的会话数（所有 LoginManager 实例）
+    static int activeSessionCount() { return activeSessions.loadAcquire(); }
 
     // 密码验证
     static bool isPasswordValid(const QString& password, QString& errorMsg);
@@ -90,6 +93,7 @@ private:
 
     // 会话设置
     static const int DEFAULT_SESSION_TIMEOUT = 30;  // 30分钟
+    static QAtomicInt activeSessions;
 };
 
 #endif // LOGINMANAGER_H
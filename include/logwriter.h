@@ -0,0 +1,81 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QThread>
+#include <QAtomicInteger>
+#include <QScopedArrayPointer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <functional>
+
+// 一条系统日志，字段与 system_logs 表一致；user_id/device_id 为 -1 时写入 NULL
+struct LogEntry {
+    qint64 timestamp = 0;   // 毫秒时间戳（epoch ms），取调用时刻
+    QString log_type;
+    QString log_level;
+    QString content;
+    int user_id = -1;
+    int device_id = -1;
+};
+Q_DECLARE_TYPEINFO(LogEntry, Q_MOVABLE_TYPE);
+
+// 异步日志写入：调用方把日志放进固定容量的环形缓冲（有界多生产者队列，只有几次原子操作，不加锁），
+// 后台线程每 flushIntervalMs 毫秒或缓冲写满一半时批量写入；缓冲已满时丢弃并计数，从不阻塞调用方
+class LogWriter : public QThread
+{
+    Q_OBJECT
+public:
+    // commit 在后台线程中调用，整批写入成功时返回 true
+    typedef std::function<bool(const QVector<LogEntry>&)> CommitFunction;
+
+    // capacity 向上取整为 2 的幂
+    LogWriter(const CommitFunction& commit, int capacity = 8192, int flushIntervalMs = 200,
+              QObject *parent = nullptr);
+    ~LogWriter();
+
+    // 线程安全；缓冲已满时返回 false
+    bool append(const LogEntry& entry);
+    // 等待此前放入的日志全部写入；timeoutMs < 0 表示一直等待
+    bool flush(int timeoutMs = -1);
+    // 写完缓冲中剩余的日志后结束线程
+    void stop();
+
+    quint64 writtenCount() const { return written.loadAcquire(); }
+    quint64 failedCount() const { return failed.loadAcquire(); }
+    quint64 droppedCount() const { return dropped.loadAcquire(); }
+
+protected:
+    void run() override;
+
+private:
+    // sequence == 位置 表示空闲可写，== 位置 + 1 表示已写入待取出
+    struct Cell {
+        QAtomicInteger<quint64> sequence;
+        LogEntry entry;
+    };
+    bool hasPending() const;
+    void drain(QVector<LogEntry>& batch);
+
+    const CommitFunction commit;
+    const int flushIntervalMs;
+    quint64 capacity;
+    quint64 mask;
+    QScopedArrayPointer<Cell> ring;
+
+    QAtomicInteger<quint64> enqueuePos;
+    quint64 dequeuePos;                    // 只由后台线程访问
+    QAtomicInteger<quint64> flushedPos;    // 此前的日志已提交
+
+    QMutex mutex;
+    QWaitCondition wakeup;
+    QWaitCondition flushed;
+    int flushRequests;                     // 受 mutex 保护
+    bool stopping;                         // 受 mutex 保护
+
+    QAtomicInteger<quint64> written;
+    QAtomicInteger<quint64> failed;
+    QAtomicInteger<quint64> dropped;
+};
+
+#endif // LOGWRITER_H
@@ -0,0 +1,63 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QHash>
+#include "querystats.h"
+
+class QThread;
+class QTcpServer;
+class QTcpSocket;
+
+// 可选的内嵌 HTTP 端点：GET /metrics 返回 Prometheus 文本格式的指标
+// （写入量、各表行数、数据库/WAL 大小、查询延迟直方图、告警评估次数、登录会话、界面帧耗时、各设备最近上报距今秒数）
+// 监听和序列化都在独立线程中进行，只读取原子计数和短暂持锁的快照，不阻塞界面线程和写线程
+// 验证：curl http://127.0.0.1:9464/metrics
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetricsServer(QObject *parent = nullptr);
+    ~MetricsServer();
+
+    bool listen(const QHostAddress& address, quint16 port);
+    void close();
+    bool isListening() const { return server != nullptr; }
+
+    // 生成一次完整的指标文本，可在任意线程调用
+    QByteArray render();
+
+    // 界面帧耗时（实时曲线每次重绘的耗时，微秒），由界面代码记录
+    static LatencyHistogram& uiFrameTimes();
+
+    static const int DefaultPort = 9464;
+    // 行数统计的缓存时间；已封存的分区不再变化，只统计一次
+    static const int RowCountCacheMs = 60000;
+
+private slots:
+    void probeEventLoop();
+
+private:
+    void handleConnection(QTcpSocket *socket);
+    void respond(QTcpSocket *socket, const QByteArray& request);
+    void refreshRowCounts();
+
+    QThread *thread;
+    QTcpServer *server;        // 在 thread 中运行，未监听时为空
+
+    // 事件循环延迟：定时器实际触发时间与预期的差值
+    QTimer lagTimer;
+    QElapsedTimer lagClock;
+    LatencyHistogram eventLoopLag;
+
+    QMutex rowCountMutex;
+    QElapsedTimer rowCountAge;
+    QHash<QString, qint64> rowCounts;
+    QHash<QString, qint64> sealedRowCounts;   // 已封存分区 <表名>_pYYYYMMDD 的行数
+};
+
+#endif // METRICSSERVER_H
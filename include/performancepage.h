@@ -0,0 +1,38 @@
+#ifndef PERFORMANCEPAGE_H
+#define PERFORMANCEPAGE_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+
+class QLabel;
+class QSpinBox;
+class QTableWidget;
+
+// 数据库性能页：按语句模板显示调用次数、吞吐、延迟分位数、行数和解码字节数（DatabaseManager::queryStatistics），
+// 可见时每秒刷新一次
+class PerformancePage : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PerformancePage(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+    void onResetClicked();
+
+private:
+    QLabel *summaryLabel;
+    QSpinBox *thresholdSpinBox;
+    QTableWidget *table;
+    QTimer refreshTimer;
+    QElapsedTimer sinceLastRefresh;
+    QHash<QString, quint64> lastCalls;   // 上次刷新时各模板的调用次数，用于计算每秒次数
+};
+
+#endif // PERFORMANCEPAGE_H
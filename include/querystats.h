@@ -0,0 +1,153 @@
+#ifndef QUERYSTATS_H
+#define QUERYSTATS_H
+
+#include <QSqlQuery>
+#include <QElapsedTimer>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QVector>
+#include <QVariantList>
+#include <QAtomicInteger>
+#include <functional>
+
+class StatementCache;
+
+// 延迟直方图（HDR 风格）：每个 2 的幂区间再等分 16 段，相对误差不超过 1/16；
+// 单位为微秒，计数使用原子操作，多个线程可同时记录
+class LatencyHistogram
+{
+public:
+    static const int SubBuckets = 16;
+    static const int MaxShift = 36;   // 最大约 2^41 微秒（25 天），超出的记入最后一个桶
+    static const int BucketCount = (MaxShift + 2) * SubBuckets;
+
+    LatencyHistogram();
+    void record(quint64 micros);
+    void reset();
+    quint64 count() const;
+    quint64 sum() const { return total.loadRelaxed(); }
+    // 第 p 百分位（0~100）所在桶的上界
+    quint64 percentile(double p) const;
+    // 不超过 boundsMicros（递增）各上界的累计次数，返回总次数；上界落在桶内时该桶不计入
+    quint64 cumulativeCounts(const QVector<quint64>& boundsMicros, QVector<quint64>& counts) const;
+
+    static int bucketIndex(quint64 micros);
+    static quint64 bucketUpperBound(int index);
+
+private:
+    QAtomicInteger<quint32> counts[BucketCount];
+    QAtomicInteger<quint64> total;   // 记录值之和
+};
+
+// 某条语句模板的统计快照
+struct QueryStatsEntry {
+    QString statement;       // 归一化后的语句：字面量替换为 ?，空白合并
+    quint64 calls = 0;
+    quint64 errors = 0;
+    quint64 rows = 0;        // SELECT 为返回行数，其他语句为影响行数
+    quint64 bytes = 0;       // 读取结果时解码的字节数
+    double totalMs = 0;
+    double maxMs = 0;
+    double p50Ms = 0;
+    double p90Ms = 0;
+    double p99Ms = 0;
+    QVector<quint64> buckets;   // 按 snapshot() 传入的上界统计的累计次数
+    quint64 bucketTotal = 0;    // 与 buckets 同一次读取的总次数
+};
+
+// 按语句模板汇总的查询统计（进程内共享），由 InstrumentedQuery 在每次执行结束时记录
+class QueryStats
+{
+public:
+    struct Counters {
+        explicit Counters(const QString& statement) : statement(statement) {}
+        const QString statement;
+        QAtomicInteger<quint64> calls;
+        QAtomicInteger<quint64> errors;
+        QAtomicInteger<quint64> rows;
+        QAtomicInteger<quint64> bytes;
+        QAtomicInteger<quint64> totalMicros;
+        QAtomicInteger<quint64> maxMicros;
+        QAtomicInteger<qint64> lastSlowReportMs;   // 慢查询限流：每个模板每分钟最多报告一次
+        LatencyHistogram histogram;
+    };
+
+    // 慢查询回调：sql 为原始语句（含占位符），bindValues 为本次绑定的参数
+    typedef std::function<void(const QString& sql, const QVariantList& bindValues, qint64 micros)> SlowQueryHandler;
+
+    static QueryStats& global();
+
+    // 查找或登记 sql 对应的模板；返回的指针在进程内一直有效
+    Counters* counters(const QString& sql);
+    // 记录一次执行；超过慢查询阈值且该模板未被限流时返回 true，调用方随后调用 reportSlowQuery
+    bool record(Counters* counters, qint64 micros, quint64 rows, quint64 bytes, bool ok);
+    void reportSlowQuery(const QString& sql, const QVariantList& bindValues, qint64 micros);
+
+    // 按总耗时从高到低排列；给出 bucketBoundsMicros 时同时填写各条目的 buckets
+    QVector<QueryStatsEntry> snapshot(const QVector<quint64>& bucketBoundsMicros = QVector<quint64>()) const;
+    // 清零计数，已登记的模板保留
+    void reset();
+
+    // 单次执行超过 thresholdMs 毫秒时调用 handler；thresholdMs <= 0 关闭
+    void setSlowQueryThreshold(int thresholdMs);
+    int slowQueryThreshold() const;
+    void setSlowQueryHandler(const SlowQueryHandler& handler);
+
+    static const int SlowReportIntervalMs = 60 * 1000;
+
+    static QString normalize(const QString& sql);
+
+private:
+    QueryStats();
+    ~QueryStats();
+    QueryStats(const QueryStats&) = delete;
+    QueryStats& operator=(const QueryStats&) = delete;
+
+    static const int MaxRawStatements = 4096;
+
+    mutable QReadWriteLock lock;
+    QHash<QString, Counters*> byTemplate;
+    QHash<QString, Counters*> byStatement;   // 原始语句 -> 模板，避免每次执行都归一化
+    QAtomicInt slowThresholdMs;
+    SlowQueryHandler slowHandler;
+};
+
+// 带统计的 QSqlQuery：计时只包含 exec/next 本身（不含调用方处理结果的时间），
+// 在结果读完、重新执行、finish() 或析构时记为一次执行
+// 这些成员会隐藏 QSqlQuery 的同名函数，只有通过 InstrumentedQuery 类型调用时才会统计
+// 给出 cache 时 prepare() 先从缓存取已 prepare 的语句，析构或改执行其他语句时结束结果集并归还
+class InstrumentedQuery : public QSqlQuery
+{
+public:
+    explicit InstrumentedQuery(const QSqlDatabase& db, StatementCache* cache = nullptr);
+    ~InstrumentedQuery();
+    InstrumentedQuery(const InstrumentedQuery&) = delete;
+    InstrumentedQuery& operator=(const InstrumentedQuery&) = delete;
+
+    bool prepare(const QString& query);
+    bool exec(const QString& query);
+    bool exec();
+    bool execBatch(BatchExecutionMode mode = ValuesAsRows);
+    bool next();
+    QVariant value(int index) const;
+    QVariant value(const QString& name) const;
+    void finish();
+
+private:
+    void start(const QString& sql);
+    void stop();
+    void releaseStatement();
+
+    StatementCache* cache;
+    QString leasedSql;                // 从缓存取出的语句，没有时为空
+    bool leasedExecuted;              // 取出后是否执行过（执行时会清空绑定计数）
+    QString preparedSql;
+    QueryStats::Counters* current;    // 正在统计的执行，没有时为空
+    QString currentSql;
+    mutable qint64 elapsedNs;
+    mutable quint64 bytes;
+    quint64 rows;
+    bool ok;
+};
+
+#endif // QUERYSTATS_H
@@ -0,0 +1,76 @@
+#ifndef REALTIMECHART_H
+#define REALTIMECHART_H
+
+#include <QtCharts/QChartView>
+#include <QtCharts/QLineSeries>
+#include <QVector>
+#include <QPointF>
+#include <QStringList>
+#include <QTimer>
+#include <deque>
+#include <utility>
+
+QT_CHARTS_USE_NAMESPACE
+
+// 固定容量的环形缓冲，保存一条曲线最近 capacity 个点；
+// 用单调队列维护窗口内的最小/最大值，追加和取范围都是均摊 O(1)
+class RingSeries
+{
+public:
+    explicit RingSeries(int capacity = 1);
+
+    // 写满后覆盖最旧的点
+    void append(const QPointF& point);
+    void clear();
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    const QPointF& oldest() const { return ring.at(head); }
+    const QPointF& newest() const { return ring.at((head + count - 1) % ring.size()); }
+    double minimum() const { return minQueue.front().second; }
+    double maximum() const { return maxQueue.front().second; }
+    // 按时间顺序展开到 out（复用 out 的内存）
+    void copyTo(QVector<QPointF>& out) const;
+
+private:
+    QVector<QPointF> ring;
+    int head;              // 最旧的点
+    int count;
+    quint64 appended;      // 累计追加的点数，作为单调队列中的序号
+    // (序号, 数值)，minQueue 数值递增、maxQueue 数值递减
+    std::deque<std::pair<quint64, double>> minQueue;
+    std::deque<std::pair<quint64, double>> maxQueue;
+};
+
+// 实时曲线图：数据先写入环形缓冲，由定时器按固定帧率整体替换到曲线（OpenGL 绘制），
+// 每帧开销与数据到达频率无关；每条曲线最多保留 capacity 个点
+class RealtimeChart : public QChartView
+{
+    Q_OBJECT
+public:
+    RealtimeChart(const QString& title, const QStringList& seriesNames, int capacity = 2000,
+                  int refreshIntervalMs = 100, QWidget *parent = nullptr);
+
+    // values 依次对应各条曲线，timestamp 为毫秒时间戳，应递增
+    void append(qint64 timestamp, const QVector<double>& values);
+    void clear();
+
+protected:
+    // 定时刷新只在可见时运行
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    // 记录每帧绘制耗时（MetricsServer::uiFrameTimes）
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void refresh();
+
+private:
+    QVector<QLineSeries*> series;
+    QVector<RingSeries> buffers;
+    QVector<QPointF> scratch;
+    QTimer refreshTimer;
+    bool dirty;
+};
+
+#endif // REALTIMECHART_H
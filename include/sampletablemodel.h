@@ -0,0 +1,52 @@
+#ifndef SAMPLETABLEMODEL_H
+#define SAMPLETABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QVector>
+#include "databasemanager.h"
+#include "asyncqueryexecutor.h"
+
+// 只读表格模型：单台设备在时间范围内的原始数据，按时间倒序分页读取（以时间戳为游标，走 (device_id, timestamp) 索引），
+// 视图滚动到底部时再取下一页；单元格在显示时才格式化，打开页面的代价与时间范围和数据密度无关。
+// 每页在 AsyncQueryExecutor 的线程池中读取，结果回到 GUI 线程后再插入行，读取期间不阻塞界面
+class SampleTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit SampleTableModel(QObject *parent = nullptr);
+
+    // 从 endTime 起向前读取第一页，之后由视图按需调用 fetchMore；尚未返回的旧范围的页被丢弃
+    void setRange(int device_id, const QDateTime& startTime, const QDateTime& endTime);
+    void clear();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    // Qt::UserRole 返回原始值（时间戳为毫秒）
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    static const int PageSize = 256;
+
+private:
+    struct Page {
+        QVector<MonitorSample> samples;
+        bool ok = false;
+    };
+    void appendPage(const Page& page);
+
+    int device_id;
+    qint64 startMs;
+    qint64 cursorMs;      // 下一页的时间上界（含）
+    int cursorTies;       // 已读取的行中时间戳等于 cursorMs 的行数，下一页跳过
+    bool atEnd;
+    bool fetching;        // 有一页正在读取，期间不再发出新的请求
+    QVector<MonitorSample> samples;
+    QueryChannel queries;
+    QueryToken generation;   // setRange 时更新，旧范围的页结果随之失效
+};
+
+#endif // SAMPLETABLEMODEL_H
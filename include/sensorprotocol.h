@@ -0,0 +1,35 @@
+#ifndef SENSORPROTOCOL_H
+#define SENSORPROTOCOL_H
+
+#include <QByteArray>
+#include <QVector>
+#include "databasemanager.h"
+
+// 传感器上报协议，TCP 和 UDP 通用，同一连接中两种格式可以混用
+//
+// 文本格式：每行一条，字段以逗号分隔，时间戳为空或 0 时由服务端填入接收时间
+//   device_id,timestamp_ms,temperature,humidity,light\n
+//   以 # 开头的行和空行被忽略
+//
+// 二进制格式（小端）：
+//   u8 0xA5 | u8 版本(1) | u16 条数 n | n × { u32 device_id, i64 timestamp_ms,
+//                                          f32 temperature, f32 humidity, f32 light }
+namespace SensorProtocol
+{
+    const quint8 BinaryMagic = 0xA5;
+    const quint8 BinaryVersion = 1;
+    const int BinaryHeaderSize = 4;
+    const int BinaryRecordSize = 24;
+    const int MaxBinaryRecords = 4096;
+    const int MaxLineLength = 256;
+
+    // 解析 buffer 中所有完整的消息，并从 buffer 中移除已处理的部分
+    // final 为 true 时（UDP 数据报）末尾没有换行的文本也按完整一行处理
+    // 返回解析出的条数，malformed 累加无法解析的行/帧数
+    int parse(QByteArray& buffer, QVector<MonitorSample>& samples, bool final, int* malformed = nullptr);
+
+    void appendLine(QByteArray& out, const MonitorSample& sample);
+    void appendBinary(QByteArray& out, const MonitorSample* samples, int count);
+}
+
+#endif // SENSORPROTOCOL_H
@@ -0,0 +1,59 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QSqlQuery>
+#include <QSqlDriver>
+#include <QHash>
+#include <QAtomicInteger>
+#include <list>
+
+// 按 SQL 文本缓存已 prepare 的语句，容量满时淘汰最久未使用的；每个连接一个，只在该连接所属的线程中使用。
+// 取出的语句与缓存共享同一个 SQLite 语句句柄，用完后先 finish() 再 release()（InstrumentedQuery 自动完成）
+class StatementCache
+{
+public:
+    StatementCache();
+    ~StatementCache();
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // 返回 sql 对应的已 prepare 语句，未缓存时用 driver 新建并 prepare；
+    // 缓存关闭、同一语句正在使用（嵌套查询）或 prepare 失败时返回空，调用方按原方式 prepare
+    QSqlQuery* acquire(const QSqlDriver* driver, const QString& sql);
+    // reusable 为 false（取出后没有执行过，可能残留未使用的绑定值）时从缓存中移除
+    void release(const QString& sql, bool reusable);
+    // 连接关闭前调用
+    void clear();
+    int size() const { return index.size(); }
+
+    // 所有连接共用的容量，0 表示关闭；缩小后各缓存在下次 acquire 时淘汰多余的语句
+    static void setCapacity(int capacity);
+    static int capacity();
+    static const int DefaultCapacity = 64;
+
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+    };
+    static Stats stats();
+
+private:
+    struct Entry {
+        QString sql;
+        QSqlQuery query;
+        bool inUse;
+    };
+    typedef std::list<Entry> EntryList;
+    void evict(int limit);
+
+    EntryList entries;   // 从最近使用到最久未用
+    QHash<QString, EntryList::iterator> index;
+
+    static QAtomicInt sharedCapacity;
+    static QAtomicInteger<quint64> hitCount;
+    static QAtomicInteger<quint64> missCount;
+    static QAtomicInteger<quint64> evictionCount;
+};
+
+#endif // STATEMENTCACHE_H
@@ -0,0 +1,89 @@
+#ifndef WRITEBEHINDQUEUE_H
+#define WRITEBEHINDQUEUE_H
+
+#include <QThread>
+#include <QAtomicPointer>
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <QVariantList>
+#include <QVector>
+#include <functional>
+#include "databasemanager.h"
+
+// 一次延迟写入；AlarmRecord 的 values 按 INSERT 语句的列顺序排列
+struct PendingWrite {
+    enum Kind { MonitorData, AlarmRecord, Barrier };
+    Kind kind = MonitorData;
+    MonitorSample sample;
+    QVariantList values;
+    QSharedPointer<QSemaphore> done;   // Barrier：之前的写入全部提交后释放
+};
+
+// 写缓冲：任意线程无锁入队（多生产者单消费者链表），单个写线程取出后
+// 每攒够 maxRows 条或最早一条等待超过 maxDelayMs 时，用一个事务整批提交
+class WriteBehindQueue : public QThread
+{
+    Q_OBJECT
+public:
+    // commit 在写线程中调用，负责在一个事务中写入整批数据，返回失败的条数
+    typedef std::function<int(const QVector<PendingWrite>&)> CommitFunction;
+
+    WriteBehindQueue(const CommitFunction& commit, int maxRows, int maxDelayMs,
+                     int maxPending, QObject *parent = nullptr);
+    ~WriteBehindQueue();
+
+    // 线程安全；积压超过 maxPending 时丢弃并返回 false（屏障不受限制）
+    bool enqueue(const PendingWrite& write);
+    // 等待此前入队的写入全部提交；timeoutMs < 0 表示一直等待
+    bool flush(int timeoutMs = -1);
+    // 提交剩余数据后结束写线程
+    void stop();
+
+    quint64 committedCount() const { return committed.loadAcquire(); }
+    quint64 failedCount() const { return failed.loadAcquire(); }
+    quint64 droppedCount() const { return dropped.loadAcquire(); }
+    quint64 transactionCount() const { return transactions.loadAcquire(); }
+    int pendingCount() const { return pending.loadAcquire(); }
+
+protected:
+    void run() override;
+
+private:
+    struct Node {
+        QAtomicPointer<Node> next;
+        PendingWrite write;
+        qint64 enqueuedMs;   // 入队时刻（clock），批次的等待时间从其中最早一条算起
+    };
+    void push(Node *node);
+    Node *pop();
+    void wake();
+    void commitBatch(QVector<PendingWrite>& batch, QVector<QSharedPointer<QSemaphore>>& barriers);
+
+    const CommitFunction commit;
+    const int maxRows;
+    const int maxDelayMs;
+    const int maxPending;
+
+    // Vyukov 无锁队列：生产者只交换 head，消费者独占 tail
+    QAtomicPointer<Node> head;
+    Node *tail;
+    Node stub;
+
+    QElapsedTimer clock;   // 构造时启动，只读，各线程共用
+
+    QAtomicInt pending;
+    QAtomicInt stopping;
+    QMutex wakeMutex;
+    QWaitCondition wakeup;
+
+    QAtomicInteger<quint64> committed;
+    QAtomicInteger<quint64> failed;
+    QAtomicInteger<quint64> dropped;
+    QAtomicInteger<quint64> transactions;
+};
+
+#endif // WRITEBEHINDQUEUE_H
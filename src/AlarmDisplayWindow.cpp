@@ -5,7 +5,8 @@
 #include <QHeaderView>
 
 AlarmDisplayWindow::AlarmDisplayWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::AlarmDisplayWindow)
+    : QMainWindow(parent), ui(new Ui::AlarmDisplayWindow),
+      alarmFilter(alarmQueries, [this]() { loadAlarms(); })
 {
     ui->setupUi(this);
 
@@ -35,11 +36,11 @@ AlarmDisplayWindow::AlarmDisplayWindow(QWidget *parent)
     ui->recordTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     ui->recordTable->horizontalHeader()->setStretchLastSection(true);
 
-    // 连接信号
+    // 连接信号：下拉框是一次性选择，立即查询；时间编辑框滚动/输入时合并为一次查询
     connect(ui->deviceComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &AlarmDisplayWindow::onFilterChanged);
     connect(ui->statusComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &AlarmDisplayWindow::onFilterChanged);
-    connect(ui->startDateTimeEdit, &QDateTimeEdit::dateTimeChanged, this, &AlarmDisplayWindow::onFilterChanged);
-    connect(ui->endDateTimeEdit, &QDateTimeEdit::dateTimeChanged, this, &AlarmDisplayWindow::onFilterChanged);
+    connect(ui->startDateTimeEdit, &QDateTimeEdit::dateTimeChanged, this, &AlarmDisplayWindow::onTimeRangeChanged);
+    connect(ui->endDateTimeEdit, &QDateTimeEdit::dateTimeChanged, this, &AlarmDisplayWindow::onTimeRangeChanged);
     connect(ui->recordTable, &QTableWidget::itemSelectionChanged, this, [this]() {
         int currentRow = ui->recordTable->currentRow();
         if (currentRow < 0 || ui->recordTable->item(currentRow, 0) == nullptr) {
@@ -66,7 +67,19 @@ AlarmDisplayWindow::AlarmDisplayWindow(QWidget *parent)
 
         ui->recordDetailText->setText(details);
     });
-
+    // 新告警落在当前筛选时间范围内时刷新列表；页面不可见时只做标记，显示时再刷新
+    connect(&DatabaseManager::instance(), &DatabaseManager::alarmRaised, this, [this](int, qint64 timestamp, const QString&) {
+        // 有尚未发出的合并查询时，它到期后自然包含这条告警
+        if (alarmFilter.isPending()) return;
+        if (timestamp >= ui->startDateTimeEdit->dateTime().toMSecsSinceEpoch()
+            && timestamp <= ui->endDateTimeEdit->dateTime().toMSecsSinceEpoch()) {
+            if (isVisible()) {
+                loadAlarms();
+            } else {
+                alarmsStale = true;
+            }
+        }
+    });
 
     loadAlarms();
 }
@@ -76,41 +89,59 @@ AlarmDisplayWindow::~AlarmDisplayWindow()
     delete ui;
 }
 
+void AlarmDisplayWindow::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
+    if (alarmsStale) {
+        alarmsStale = false;
+        loadAlarms();
+    }
+}
+
 void AlarmDisplayWindow::onFilterChanged()
 {
-    loadAlarms();
+    alarmFilter.runNow();
 }
 
-void AlarmDisplayWindow::loadAlarms()
+void AlarmDisplayWindow::onTimeRangeChanged()
 {
-    ui->recordTable->clearContents();
-    ui->recordTable->setRowCount(0);
+    alarmFilter.schedule();
+}
 
+void AlarmDisplayWindow::loadAlarms()
+{
     // 从筛选器获取参数
     int deviceId = ui->deviceComboBox->currentData().toInt();
     QString status = ui->statusComboBox->currentData().toString();
     QDateTime startTime = ui->startDateTimeEdit->dateTime();
     QDateTime endTime = ui->endDateTimeEdit->dateTime();
 
-    // 从数据库加载过滤后的告警记录
-    QVariantList alarms = DatabaseManager::instance().getAlarmRecordsFiltered(deviceId, status, startTime, endTime);
+    // 在后台线程加载过滤后的告警记录（设备名称由查询 JOIN 得到），筛选条件连续变化时只应用最后一次结果；
+    // 多取一条用于判断是否超出 MaxAlarmRows
+    QueryToken token = alarmQueries.next();
+    AsyncQueryExecutor::instance().submit<QVariantList>(this, token,
+        [deviceId, status, startTime, endTime]() {
+            return DatabaseManager::instance().getAlarmRecordsFiltered(deviceId, status, startTime, endTime, MaxAlarmRows + 1);
+        },
+        [this](const QVariantList& alarms) {
+            showAlarms(alarms);
+        });
+}
+
+void AlarmDisplayWindow::showAlarms(const QVariantList &records)
+{
+    const bool truncated = records.size() > MaxAlarmRows;
+    const QVariantList alarms = truncated ? records.mid(0, MaxAlarmRows) : records;
+    ui->recordTable->clearContents();
+    ui->recordTable->setRowCount(alarms.size());
 
     int row = 0;
     for (const QVariant &alarmVariant : alarms) {
         QVariantMap alarm = alarmVariant.toMap();
 
-        ui->recordTable->insertRow(row);
-        
-        // 获取设备名称
-        QVariantMap device;
-        QString deviceName = "未知设备";
-        if (DatabaseManager::instance().getDeviceById(alarm["device_id"].toInt(), device)) {
-            deviceName = device["name"].toString();
-        }
-
         QTableWidgetItem* idItem = new QTableWidgetItem(alarm["alarm_id"].toString());
         QTableWidgetItem* deviceIdItem = new QTableWidgetItem(alarm["device_id"].toString());
-        QTableWidgetItem* deviceNameItem = new QTableWidgetItem(deviceName);
+        QTableWidgetItem* deviceNameItem = new QTableWidgetItem(alarm["device_name"].toString());
         QTableWidgetItem* timestampItem = new QTableWidgetItem(alarm["timestamp"].toDateTime().toString("yyyy-MM-dd hh:mm:ss"));
         QTableWidgetItem* contentItem = new QTableWidgetItem(alarm["content"].toString());
         QTableWidgetItem* statusItem = new QTableWidgetItem(alarm["status"].toString());
@@ -128,4 +159,7 @@ void AlarmDisplayWindow::loadAlarms()
     }
 
     ui->recordDetailText->clear();
+    ui->recordDetailText->setPlaceholderText(truncated
+        ? QString("仅显示最新的 %1 条告警，请缩小时间范围或按设备、状态筛选以查看更早的记录").arg(MaxAlarmRows)
+        : QString());
 } 
\ No newline at end of file
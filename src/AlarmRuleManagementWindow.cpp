@@ -124,23 +124,16 @@ void AlarmRuleManagementWindow::loadRules()
     ui->ruleTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     ui->ruleTable->horizontalHeader()->setStretchLastSection(true);
 
-    QVariantList rules = DatabaseManager::instance().getAlarmRules(-1); // -1 获取所有规则
+    QVariantList rules = DatabaseManager::instance().getAlarmRules(-1); // -1 获取所有规则，设备名称已随规则查出
 
+    ui->ruleTable->setRowCount(rules.size());
     int row = 0;
     for (const QVariant& ruleVariant : rules) {
         QVariantMap rule = ruleVariant.toMap();
-        ui->ruleTable->insertRow(row);
-
-        // 获取设备名称
-        QVariantMap device;
-        QString deviceName = "未知设备";
-        if (DatabaseManager::instance().getDeviceById(rule["device_id"].toInt(), device)) {
-            deviceName = device["name"].toString();
-        }
 
         QTableWidgetItem* idItem = new QTableWidgetItem(rule["rule_id"].toString());
         QTableWidgetItem* deviceIdItem = new QTableWidgetItem(rule["device_id"].toString());
-        QTableWidgetItem* deviceNameItem = new QTableWidgetItem(deviceName);
+        QTableWidgetItem* deviceNameItem = new QTableWidgetItem(rule["device_name"].toString());
         QTableWidgetItem* descriptionItem = new QTableWidgetItem(rule["description"].toString());
         QTableWidgetItem* conditionItem = new QTableWidgetItem(rule["condition"].toString());
         QTableWidgetItem* actionItem = new QTableWidgetItem(rule["action"].toString());
@@ -1,10 +1,9 @@
 #include "DataAnalysisWindow.h"
 #include "ui_DataAnalysisWindow.h"
 #include "databasemanager.h"
+#include "csvexporter.h"
 #include <QVBoxLayout>
 #include <QHeaderView>
-#include <QFileDialog>
-#include <QTextStream>
 #include <QMessageBox>
 #include <QtCharts/QBarCategoryAxis>
 #include <QtCharts/QValueAxis>
@@ -39,8 +38,8 @@ void DataAnalysisWindow::setupUiElements()
     ui->startDateTimeEdit->setDateTime(QDateTime::currentDateTime().addDays(-1));
 
     // 设置结果表格
-    ui->resultTable->setColumnCount(4);
-    ui->resultTable->setHorizontalHeaderLabels({"设备名称", "最大值", "最小值", "平均值"});
+    ui->resultTable->setColumnCount(6);
+    ui->resultTable->setHorizontalHeaderLabels({"设备名称", "最大值", "最小值", "平均值", "标准差", "样本数"});
     ui->resultTable->horizontalHeader()->setStretchLastSection(true);
     ui->resultTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
 }
@@ -97,47 +96,32 @@ void DataAnalysisWindow::onAnalysisClicked()
 
 void DataAnalysisWindow::performAnalysis(int deviceId, const QString& dataType, const QDateTime& startTime, const QDateTime& endTime)
 {
-    QList<QVariantMap> analysisResult;
-    QList<int> deviceIds;
-
-    if (deviceId == -1) { // 分析所有设备
-        QVariantList devices = DatabaseManager::instance().getDevices();
-        for(const auto& device : devices) {
-            deviceIds.append(device.toMap()["device_id"].toInt());
-        }
-    } else {
-        deviceIds.append(deviceId);
-    }
-    
-    for(int id : deviceIds) {
-        QVariantList monitorData = DatabaseManager::instance().getDeviceData(id, startTime, endTime);
-        if (monitorData.isEmpty()) continue;
-
-        double maxVal = monitorData.first().toMap()[dataType].toDouble();
-        double minVal = maxVal;
-        double sum = 0;
-
-        for (const QVariant& dataPoint : monitorData) {
-            double value = dataPoint.toMap()[dataType].toDouble();
-            if (value > maxVal) maxVal = value;
-            if (value < minVal) minVal = value;
-            sum += value;
-        }
-        
-        double avgVal = sum / monitorData.size();
-
-        QVariantMap result;
-        QVariantMap deviceDetails;
-        DatabaseManager::instance().getDeviceById(id, deviceDetails);
-        result["device_name"] = deviceDetails["name"].toString();
-        result["max"] = maxVal;
-        result["min"] = minVal;
-        result["avg"] = avgVal;
-        analysisResult.append(result);
-    }
-    
-    updateTable(analysisResult);
-    updateChart(analysisResult);
+    // 聚合在数据库中完成：无论设备数和数据量多少，只有一次查询，且在后台线程执行
+    ui->analysisButton->setEnabled(false);
+    QueryToken token = analysisQueries.next();
+    AsyncQueryExecutor::instance().submit<QVector<MetricStatistics>>(this, token,
+        [deviceId, dataType, startTime, endTime]() {
+            return DatabaseManager::instance().getMetricStatistics(dataType, startTime, endTime, deviceId);
+        },
+        [this](const QVector<MetricStatistics>& stats) {
+            ui->analysisButton->setEnabled(true);
+
+            QList<QVariantMap> analysisResult;
+            for (const MetricStatistics& item : stats) {
+                QVariantMap result;
+                result["device_name"] = item.device_name;
+                result["max"] = item.max;
+                result["min"] = item.min;
+                result["avg"] = item.avg;
+                result["stddev"] = item.stddev;
+                result["count"] = item.count;
+                result["approximate"] = item.approximate;
+                analysisResult.append(result);
+            }
+
+            updateTable(analysisResult);
+            updateChart(analysisResult);
+        });
 }
 
 void DataAnalysisWindow::updateTable(const QList<QVariantMap>& analysisResult)
@@ -146,10 +130,20 @@ void DataAnalysisWindow::updateTable(const QList<QVariantMap>& analysisResult)
     int row = 0;
     for (const auto& result : analysisResult) {
         ui->resultTable->insertRow(row);
-        ui->resultTable->setItem(row, 0, new QTableWidgetItem(result["device_name"].toString()));
+        // 范围两端只剩汇总数据时按整桶统计，设备名后加注并在提示中说明
+        const bool approximate = result["approximate"].toBool();
+        QTableWidgetItem* nameItem = new QTableWidgetItem(result["device_name"].toString() + (approximate ? QString("（近似）") : QString()));
+        if (approximate) {
+            nameItem->setToolTip("查询范围的起止时间落在汇总桶中间且该时段已没有更细的数据，边界处按整桶统计，可能包含范围外的样本");
+        }
+        ui->resultTable->setItem(row, 0, nameItem);
         ui->resultTable->setItem(row, 1, new QTableWidgetItem(QString::number(result["max"].toDouble(), 'f', 2)));
         ui->resultTable->setItem(row, 2, new QTableWidgetItem(QString::number(result["min"].toDouble(), 'f', 2)));
         ui->resultTable->setItem(row, 3, new QTableWidgetItem(QString::number(result["avg"].toDouble(), 'f', 2)));
+        // 超过原始数据保留期的范围由汇总表统计，没有标准差
+        const double stddev = result["stddev"].toDouble();
+        ui->resultTable->setItem(row, 4, new QTableWidgetItem(stddev < 0 ? QString("-") : QString::number(stddev, 'f', 2)));
+        ui->resultTable->setItem(row, 5, new QTableWidgetItem(QString::number(result["count"].toLongLong())));
         row++;
     }
 }
@@ -210,30 +204,30 @@ void DataAnalysisWindow::updateChart(const QList<QVariantMap>& analysisResult)
 
 void DataAnalysisWindow::onExportClicked()
 {
-    QString fileName = QFileDialog::getSaveFileName(this, "导出分析结果", "", "CSV 文件 (*.csv)");
-    if (fileName.isEmpty()) return;
-
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "错误", "无法打开文件进行写入。");
-        return;
+    // 分析结果只有每台设备一行，直接导出当前结果
+    QVector<QVariantList> rows;
+    rows.reserve(ui->resultTable->rowCount());
+    for (int row = 0; row < ui->resultTable->rowCount(); ++row) {
+        QVariantList rowData;
+        for (int col = 0; col < ui->resultTable->columnCount(); ++col) {
+            QTableWidgetItem* item = ui->resultTable->item(row, col);
+            rowData << (item ? item->text() : QString());
+        }
+        rows.append(rowData);
     }
-
-    QTextStream out(&file);
     QStringList headers;
     for (int i = 0; i < ui->resultTable->columnCount(); ++i) {
         headers << ui->resultTable->horizontalHeaderItem(i)->text();
     }
-    out << headers.join(',') << "\n";
 
-    for (int row = 0; row < ui->resultTable->rowCount(); ++row) {
-        QStringList rowData;
-        for (int col = 0; col < ui->resultTable->columnCount(); ++col) {
-            rowData << ui->resultTable->item(row, col)->text();
+    CsvExporter::Request request;
+    request.headers = headers;
+    request.expectedRows = rows.size();
+    request.source = [rows](const CsvExporter::RowCallback& callback, QString&) -> bool {
+        for (const QVariantList& row : rows) {
+            if (!callback(row)) break;
         }
-        out << rowData.join(',') << "\n";
-    }
-
-    file.close();
-    QMessageBox::information(this, "成功", "数据已成功导出。");
-} 
\ No newline at end of file
+        return true;
+    };
+    CsvExporter::exportWithDialog(this, "导出分析结果", request);
+}
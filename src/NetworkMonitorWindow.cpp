@@ -1,21 +1,24 @@
 #include "NetworkMonitorWindow.h"
 #include "ui_NetworkMonitorWindow.h"
 #include "databasemanager.h"
-#include <QTimer>
+#include "asyncqueryexecutor.h"
+#include "chartdownsampler.h"
+#include "realtimechart.h"
+#include "csvexporter.h"
+#include "sampletablemodel.h"
 #include <QtCharts/QDateTimeAxis>
 #include <QtCharts/QValueAxis>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
 #include <QVBoxLayout>
 #include <QHeaderView>
-#include <QFileDialog>
-#include <QTextStream>
 #include <QMessageBox>
 
 QT_CHARTS_USE_NAMESPACE
 
 NetworkMonitorWindow::NetworkMonitorWindow(QWidget *parent)
-    : QWidget(parent), ui(new Ui::NetworkMonitorWindow), realtimeTimer(new QTimer(this))
+    : QWidget(parent), ui(new Ui::NetworkMonitorWindow), lastRealtimeTimestamp(0),
+      historyFilter(historyQueries, [this]() { queryHistoryData(); }), historyModel(new SampleTableModel(this))
 {
     ui->setupUi(this);
     
@@ -27,9 +30,6 @@ NetworkMonitorWindow::NetworkMonitorWindow(QWidget *parent)
     connect(ui->startDateTimeEdit, &QDateTimeEdit::dateTimeChanged, this, &NetworkMonitorWindow::onTimeRangeChanged);
     connect(ui->endDateTimeEdit, &QDateTimeEdit::dateTimeChanged, this, &NetworkMonitorWindow::onTimeRangeChanged);
     connect(ui->exportButton, &QPushButton::clicked, this, &NetworkMonitorWindow::onExportClicked);
-    connect(realtimeTimer, &QTimer::timeout, this, &NetworkMonitorWindow::refreshRealtimeData);
-    
-    realtimeTimer->start(3000); // 3秒刷新一次
 }
 
 NetworkMonitorWindow::~NetworkMonitorWindow()
@@ -37,6 +37,24 @@ NetworkMonitorWindow::~NetworkMonitorWindow()
     delete ui;
 }
 
+void NetworkMonitorWindow::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    // 实时数据由写入端推送，无新数据时不做任何查询；只在页面可见时订阅
+    if (!latestConnection) {
+        latestConnection = connect(&DatabaseManager::instance(), &DatabaseManager::latestSampleChanged,
+                                   this, &NetworkMonitorWindow::onLatestSampleChanged);
+        refreshRealtimeData();
+    }
+}
+
+void NetworkMonitorWindow::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    disconnect(latestConnection);
+    latestConnection = QMetaObject::Connection();
+}
+
 void NetworkMonitorWindow::setupUiElements()
 {
     // 设置时间范围为最近一小时
@@ -44,8 +62,9 @@ void NetworkMonitorWindow::setupUiElements()
     ui->startDateTimeEdit->setDateTime(QDateTime::currentDateTime().addSecs(-3600));
 
     // 设置历史数据表格
-    ui->historyTable->setColumnCount(4);
-    ui->historyTable->setHorizontalHeaderLabels({"时间戳", "温度 (°C)", "湿度 (%)", "光照 (lux)"});
+    // 行高固定，视图不必逐行计算高度
+    ui->historyTable->setModel(historyModel);
+    ui->historyTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     ui->historyTable->horizontalHeader()->setStretchLastSection(true);
     ui->historyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
 }
@@ -53,39 +72,11 @@ void NetworkMonitorWindow::setupUiElements()
 void NetworkMonitorWindow::setupCharts()
 {
     // --- 实时图表设置 ---
-    realtimeChart = new QChart();
-    realtimeChart->setTitle("实时监控数据");
-    realtimeChartView = new QChartView(realtimeChart, this);
-    realtimeChartView->setRenderHint(QPainter::Antialiasing);
+    // 每条曲线保留最近 2000 个点，每秒刷新 10 次
+    realtimeChartView = new RealtimeChart("实时监控数据", {"温度", "湿度", "光照"}, 2000, 100, this);
     ui->realtimeChartWidget->setLayout(new QVBoxLayout());
     ui->realtimeChartWidget->layout()->addWidget(realtimeChartView);
 
-    tempSeriesRealtime = new QLineSeries();
-    tempSeriesRealtime->setName("温度");
-    humiditySeriesRealtime = new QLineSeries();
-    humiditySeriesRealtime->setName("湿度");
-    lightSeriesRealtime = new QLineSeries();
-    lightSeriesRealtime->setName("光照");
-
-    realtimeChart->addSeries(tempSeriesRealtime);
-    realtimeChart->addSeries(humiditySeriesRealtime);
-    realtimeChart->addSeries(lightSeriesRealtime);
-
-    QDateTimeAxis *axisXRealtime = new QDateTimeAxis;
-    axisXRealtime->setTickCount(10);
-    axisXRealtime->setFormat("hh:mm:ss");
-    realtimeChart->addAxis(axisXRealtime, Qt::AlignBottom);
-    tempSeriesRealtime->attachAxis(axisXRealtime);
-    humiditySeriesRealtime->attachAxis(axisXRealtime);
-    lightSeriesRealtime->attachAxis(axisXRealtime);
-
-    QValueAxis *axisYRealtime = new QValueAxis;
-    axisYRealtime->setLabelFormat("%f");
-    realtimeChart->addAxis(axisYRealtime, Qt::AlignLeft);
-    tempSeriesRealtime->attachAxis(axisYRealtime);
-    humiditySeriesRealtime->attachAxis(axisYRealtime);
-    lightSeriesRealtime->attachAxis(axisYRealtime);
-
     // --- 历史图表设置 ---
     historyChart = new QChart();
     historyChart->setTitle("历史监控数据");
@@ -136,59 +127,52 @@ void NetworkMonitorWindow::loadDeviceList()
 void NetworkMonitorWindow::onDeviceChanged(int index)
 {
     if (index <= 0) { // "请选择设备"
-        tempSeriesRealtime->clear();
-        humiditySeriesRealtime->clear();
-        lightSeriesRealtime->clear();
-        updateHistoryUi({});
+        realtimeChartView->clear();
+        historyFilter.cancel();
+        clearHistoryUi();
         return;
     }
     
     // 设备切换时，清空实时数据并立即查询一次历史和实时数据
-    tempSeriesRealtime->clear();
-    humiditySeriesRealtime->clear();
-    lightSeriesRealtime->clear();
+    realtimeChartView->clear();
+    lastRealtimeTimestamp = 0;
 
     refreshRealtimeData();
-    queryHistoryData();
+    historyFilter.runNow();
 }
 
 void NetworkMonitorWindow::onTimeRangeChanged()
 {
-    queryHistoryData();
+    // 滚动或输入时间时只在停顿后查询一次
+    historyFilter.schedule();
 }
 
 void NetworkMonitorWindow::onExportClicked()
 {
-    QString fileName = QFileDialog::getSaveFileName(this, "导出历史数据", "", "CSV 文件 (*.csv)");
-    if (fileName.isEmpty()) {
-        return;
-    }
-
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "错误", "无法打开文件进行写入。");
+    int deviceId = ui->deviceComboBox->currentData().toInt();
+    if (deviceId == -1) {
+        QMessageBox::warning(this, "提示", "请先选择设备。");
         return;
     }
 
-    QTextStream out(&file);
-    // 写入表头
-    QStringList headers;
-    for (int i = 0; i < ui->historyTable->columnCount(); ++i) {
-        headers << ui->historyTable->horizontalHeaderItem(i)->text();
-    }
-    out << headers.join(',') << "\n";
-
-    // 写入数据
-    for (int row = 0; row < ui->historyTable->rowCount(); ++row) {
-        QStringList rowData;
-        for (int col = 0; col < ui->historyTable->columnCount(); ++col) {
-            rowData << ui->historyTable->item(row, col)->text();
-        }
-        out << rowData.join(',') << "\n";
-    }
-
-    file.close();
-    QMessageBox::information(this, "成功", "数据已成功导出。");
+    // 直接从数据库导出整个时间范围内的原始数据（含已压缩的分块），不受表格中已加载行数的限制
+    const QDateTime startTime = ui->startDateTimeEdit->dateTime();
+    const QDateTime endTime = ui->endDateTimeEdit->dateTime();
+    CsvExporter::Request request;
+    request.headers = QStringList{"时间戳", "温度 (°C)", "湿度 (%)", "光照 (lux)"};
+    request.source = [deviceId, startTime, endTime](const CsvExporter::RowCallback& callback, QString& error) -> bool {
+        QVariantList row;
+        const bool ok = DatabaseManager::instance().forEachDeviceSample(deviceId, startTime, endTime,
+            [&](const MonitorSample& sample) {
+                row.clear();
+                row << QDateTime::fromMSecsSinceEpoch(sample.timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz")
+                    << sample.temperature << sample.humidity << sample.light;
+                return callback(row);
+            }, Qt::AscendingOrder, 0);
+        if (!ok) error = DatabaseManager::instance().lastError();
+        return ok;
+    };
+    CsvExporter::exportWithDialog(this, "导出历史数据", request);
 }
 
 void NetworkMonitorWindow::refreshRealtimeData()
@@ -196,110 +180,117 @@ void NetworkMonitorWindow::refreshRealtimeData()
     int deviceId = ui->deviceComboBox->currentData().toInt();
     if (deviceId == -1) return;
 
-    // 假设我们有一个函数可以获取最新的单条数据
-    QVariantList latestDataList = DatabaseManager::instance().getDeviceData(deviceId, QDateTime::currentDateTime().addSecs(-5), QDateTime::currentDateTime());
-    if (!latestDataList.isEmpty()) {
-        updateRealtimeChart(latestDataList.last().toMap());
+    // 从最新数据缓存读取，O(1)，不访问数据库
+    MonitorSample sample;
+    if (DatabaseManager::instance().latestSample(deviceId, sample)) {
+        updateRealtimeChart(sample);
     }
 }
 
+void NetworkMonitorWindow::onLatestSampleChanged(int deviceId, const MonitorSample &sample)
+{
+    if (deviceId != ui->deviceComboBox->currentData().toInt()) return;
+    updateRealtimeChart(sample);
+}
+
 void NetworkMonitorWindow::queryHistoryData()
 {
     int deviceId = ui->deviceComboBox->currentData().toInt();
     if (deviceId == -1) {
-        updateHistoryUi({});
+        clearHistoryUi();
         return;
     };
 
     QDateTime startTime = ui->startDateTimeEdit->dateTime();
     QDateTime endTime = ui->endDateTimeEdit->dateTime();
 
-    QVariantList historyData = DatabaseManager::instance().getDeviceData(deviceId, startTime, endTime);
-    updateHistoryUi(historyData);
+    updateHistoryUi(deviceId, startTime, endTime);
 }
 
-void NetworkMonitorWindow::updateRealtimeChart(const QVariantMap &data)
+void NetworkMonitorWindow::updateRealtimeChart(const MonitorSample &sample)
 {
-    if (data.isEmpty()) return;
-    
-    qint64 timestamp = QDateTime::fromString(data["timestamp"].toString(), Qt::ISODate).toMSecsSinceEpoch();
-    
-    tempSeriesRealtime->append(timestamp, data["temperature"].toDouble());
-    humiditySeriesRealtime->append(timestamp, data["humidity"].toDouble());
-    lightSeriesRealtime->append(timestamp, data["light"].toDouble());
-    
-    // 保持图表中数据点数量，避免无限增长
-    if (tempSeriesRealtime->count() > 100) {
-        tempSeriesRealtime->remove(0);
-        humiditySeriesRealtime->remove(0);
-        lightSeriesRealtime->remove(0);
-    }
-    
-    if (tempSeriesRealtime->count() == 0) return;
+    // 同一条数据只画一次
+    if (sample.timestamp <= lastRealtimeTimestamp) return;
+    lastRealtimeTimestamp = sample.timestamp;
 
-    realtimeChart->axes(Qt::Horizontal).first()->setRange(
-        QDateTime::fromMSecsSinceEpoch(tempSeriesRealtime->at(0).x()),
-        QDateTime::fromMSecsSinceEpoch(tempSeriesRealtime->at(tempSeriesRealtime->count() - 1).x())
-    );
-    
-    // 自动调整Y轴范围
-    double minVal = 0, maxVal = 100; // 默认范围
-    if (tempSeriesRealtime->count() > 0) {
-        minVal = tempSeriesRealtime->at(0).y();
-        maxVal = tempSeriesRealtime->at(0).y();
-        for (const auto& point : tempSeriesRealtime->points()) {
-            if (point.y() < minVal) minVal = point.y();
-            if (point.y() > maxVal) maxVal = point.y();
-        }
-    }
-     realtimeChart->axes(Qt::Vertical).first()->setRange(minVal - 10, maxVal + 10);
+    // 只写入环形缓冲，坐标轴和曲线由图表按帧率刷新
+    realtimeChartView->append(sample.timestamp, {sample.temperature, sample.humidity, sample.light});
 }
 
-void NetworkMonitorWindow::updateHistoryUi(const QVariantList &data)
+void NetworkMonitorWindow::clearHistoryUi()
 {
-    // 更新表格
-    ui->historyTable->setRowCount(0);
-    for (int i = 0; i < data.size(); ++i) {
-        QVariantMap rowData = data[i].toMap();
-        ui->historyTable->insertRow(i);
-        ui->historyTable->setItem(i, 0, new QTableWidgetItem(rowData["timestamp"].toDateTime().toString("yyyy-MM-dd hh:mm:ss")));
-        ui->historyTable->setItem(i, 1, new QTableWidgetItem(QString::number(rowData["temperature"].toDouble())));
-        ui->historyTable->setItem(i, 2, new QTableWidgetItem(QString::number(rowData["humidity"].toDouble())));
-        ui->historyTable->setItem(i, 3, new QTableWidgetItem(QString::number(rowData["light"].toDouble())));
-    }
-
-    // 更新图表
+    historyQueries.cancel();
+    historyModel->clear();
     tempSeriesHistory->clear();
     humiditySeriesHistory->clear();
     lightSeriesHistory->clear();
-    if(data.isEmpty()) {
-        historyChart->axes(Qt::Horizontal).first()->setRange(QDateTime::currentDateTime(), QDateTime::currentDateTime().addDays(1));
-        historyChart->axes(Qt::Vertical).first()->setRange(0, 100);
+    historyChart->axes(Qt::Horizontal).first()->setRange(QDateTime::currentDateTime(), QDateTime::currentDateTime().addDays(1));
+    historyChart->axes(Qt::Vertical).first()->setRange(0, 100);
+}
+
+void NetworkMonitorWindow::updateHistoryUi(int deviceId, const QDateTime &startTime, const QDateTime &endTime)
+{
+    // 表格始终显示原始数据，由模型在滚动时按页读取，不随时间范围变慢
+    historyModel->setRange(deviceId, startTime, endTime);
+
+    // 图表在后台线程读取，时间范围连续变化时只应用最后一次请求的结果
+    // 时间跨度较大时按图表宽度自动改读汇总表（图表标题注明粒度）
+    const int maxPoints = historyChartView->width();
+    // 原始数据仍可能远多于像素数，在后台线程中按绘图区宽度降采样，只把降采样结果交给界面线程
+    const int chartPoints = qMax(100, static_cast<int>(historyChart->plotArea().width()));
+    QueryToken token = historyQueries.next();
+    AsyncQueryExecutor::instance().submit<HistoryData>(this, token,
+        [deviceId, startTime, endTime, maxPoints, chartPoints, token]() -> HistoryData {
+            HistoryData data;
+            data.resolution = DatabaseManager::pickResolution(startTime, endTime, maxPoints);
+            QVector<QPointF> tempPoints, humidityPoints, lightPoints;
+            bool first = true;
+            DatabaseManager::instance().forEachDeviceSample(deviceId, startTime, endTime, [&](const MonitorSample& sample) -> bool {
+                if (first) {
+                    data.minValue = data.maxValue = sample.temperature;
+                    data.firstTimestamp = sample.timestamp;
+                    first = false;
+                }
+                data.lastTimestamp = sample.timestamp;
+                data.minValue = qMin(data.minValue, qMin(sample.temperature, qMin(sample.humidity, sample.light)));
+                data.maxValue = qMax(data.maxValue, qMax(sample.temperature, qMax(sample.humidity, sample.light)));
+                tempPoints.append(QPointF(sample.timestamp, sample.temperature));
+                humidityPoints.append(QPointF(sample.timestamp, sample.humidity));
+                lightPoints.append(QPointF(sample.timestamp, sample.light));
+                return !token.isCancelled();
+            }, Qt::AscendingOrder, maxPoints);
+            if (token.isCancelled()) {
+                return data;
+            }
+            data.tempPoints = ChartDownsampler::lttb(tempPoints, chartPoints);
+            data.humidityPoints = ChartDownsampler::lttb(humidityPoints, chartPoints);
+            data.lightPoints = ChartDownsampler::lttb(lightPoints, chartPoints);
+            return data;
+        },
+        [this](const HistoryData& data) {
+            applyHistoryData(data);
+        });
+}
+
+void NetworkMonitorWindow::applyHistoryData(const HistoryData &data)
+{
+    static const char* const resolutionNames[4] = { "原始数据", "1分钟平均", "1小时平均", "1天平均" };
+    historyChart->setTitle(QString("历史监控数据（%1）").arg(resolutionNames[data.resolution]));
+    if (data.tempPoints.isEmpty()) {
+        tempSeriesHistory->clear();
+        humiditySeriesHistory->clear();
+        lightSeriesHistory->clear();
         return;
     }
 
-    double minVal = 0, maxVal = 100;
-    
-    for (const QVariant& rowVariant : data) {
-        QVariantMap rowData = rowVariant.toMap();
-        qint64 timestamp = rowData["timestamp"].toDateTime().toMSecsSinceEpoch();
-        double temp = rowData["temperature"].toDouble();
-        
-        if (tempSeriesHistory->count() == 0) {
-            minVal = maxVal = temp;
-        } else {
-            if (temp < minVal) minVal = temp;
-            if (temp > maxVal) maxVal = temp;
-        }
-
-        tempSeriesHistory->append(timestamp, temp);
-        humiditySeriesHistory->append(timestamp, rowData["humidity"].toDouble());
-        lightSeriesHistory->append(timestamp, rowData["light"].toDouble());
-    }
-    
+    // 界面线程只替换降采样后的曲线，代价与像素数有关而与数据量无关
+    tempSeriesHistory->replace(data.tempPoints);
+    humiditySeriesHistory->replace(data.humidityPoints);
+    lightSeriesHistory->replace(data.lightPoints);
+
     historyChart->axes(Qt::Horizontal).first()->setRange(
-        data.first().toMap()["timestamp"].toDateTime(),
-        data.last().toMap()["timestamp"].toDateTime()
+        QDateTime::fromMSecsSinceEpoch(data.firstTimestamp),
+        QDateTime::fromMSecsSinceEpoch(data.lastTimestamp)
     );
-    historyChart->axes(Qt::Vertical).first()->setRange(minVal - 10, maxVal + 10);
+    historyChart->axes(Qt::Vertical).first()->setRange(data.minValue - 10, data.maxValue + 10);
 }
@@ -9,6 +9,7 @@
 #include "AlarmRuleManagementWindow.h"
 #include "AlarmDisplayWindow.h"
 #include "DataAnalysisWindow.h"
+#include "performancepage.h"
 #include <QButtonGroup>
 #include <QPropertyAnimation>
 #include <QParallelAnimationGroup>
@@ -119,7 +120,8 @@ AdminWindow::AdminWindow(const QString& currentUsername, QWidget *parent)
         ui->alarmRuleManagementBtn, // 3
         ui->alarmDisplayBtn,        // 4
         ui->dataAnalysisBtn,        // 5
-        ui->systemSettingsBtn       // 6 -> 现在在数据分析下方
+        ui->systemSettingsBtn,      // 6 -> 现在在数据分析下方
+        ui->performanceBtn          // 7
     };
     QList<QStyle::StandardPixmap> icons = {
         QStyle::SP_DirHomeIcon,           // 用户管理
@@ -128,7 +130,8 @@ AdminWindow::AdminWindow(const QString& currentUsername, QWidget *parent)
         QStyle::SP_FileIcon,              // 报警规则
         QStyle::SP_MessageBoxWarning,     // 报警显示
         QStyle::SP_FileDialogDetailedView, // 数据分析
-        QStyle::SP_DialogApplyButton      // 系统日志
+        QStyle::SP_DialogApplyButton,     // 系统日志
+        QStyle::SP_FileDialogInfoView     // 性能监控
     };
 
     sideBarGroup = new QButtonGroup(this);
@@ -230,22 +233,17 @@ AdminWindow::AdminWindow(const QString& currentUsername, QWidget *parent)
     // 状态栏（如无statusBar成员可注释）
     // statusBar()->showMessage("管理员控制台已就绪");
 
-    // 实例化功能页面并添加到QStackedWidget
-    DatabaseViewer* userPage = new DatabaseViewer(this, QStringList() << "users");
-    DeviceManagementPage* devicePage = new DeviceManagementPage(currentUsername, this);
-    NetworkMonitorPage* networkPage = new NetworkMonitorPage(this);
-    AlarmRuleManagementPage* alarmRulePage = new AlarmRuleManagementPage(this);
-    AlarmDisplayPage* alarmDisplayPage = new AlarmDisplayPage(this);
-    DataAnalysisPage* dataAnalysisPage = new DataAnalysisPage(this);
-    SystemLogsPage* logsPage = new SystemLogsPage(this);
-
-    ui->mainStackedWidget->addWidget(userPage);         // index 0
-    ui->mainStackedWidget->addWidget(devicePage);       // index 1
-    ui->mainStackedWidget->addWidget(networkPage);      // index 2
-    ui->mainStackedWidget->addWidget(alarmRulePage);    // index 3
-    ui->mainStackedWidget->addWidget(alarmDisplayPage); // index 4
-    ui->mainStackedWidget->addWidget(dataAnalysisPage); // index 5
-    ui->mainStackedWidget->addWidget(logsPage);         // index 6
+    // 功能页面在第一次切换到时才创建（各页面构造时会查询数据库），先放入空的占位页面
+    const QString username = currentUsername;
+    addLazyPage([this]() -> QWidget* { return new DatabaseViewer(this, QStringList() << "users"); });  // index 0
+    addLazyPage([this, username]() -> QWidget* { return new DeviceManagementPage(username, this); });  // index 1
+    addLazyPage([this]() -> QWidget* { return new NetworkMonitorPage(this); });                        // index 2
+    addLazyPage([this]() -> QWidget* { return new AlarmRuleManagementPage(this); });                   // index 3
+    addLazyPage([this]() -> QWidget* { return new AlarmDisplayPage(this); });                          // index 4
+    addLazyPage([this]() -> QWidget* { return new DataAnalysisPage(this); });                          // index 5
+    addLazyPage([this]() -> QWidget* { return new SystemLogsPage(this); });                            // index 6
+    addLazyPage([this]() -> QWidget* { return new PerformancePage(this); });                           // index 7
+    connect(ui->mainStackedWidget, &QStackedWidget::currentChanged, this, &AdminWindow::ensurePage);
 
     // 设置默认显示设备管理页面
     ui->deviceManagementBtn->click();
@@ -274,6 +272,23 @@ AdminWindow::~AdminWindow()
     }
 }
 
+void AdminWindow::addLazyPage(const std::function<QWidget*()>& factory)
+{
+    QWidget* placeholder = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(placeholder);
+    layout->setContentsMargins(0,0,0,0);
+    ui->mainStackedWidget->addWidget(placeholder);
+    pageFactories.append(factory);
+}
+
+void AdminWindow::ensurePage(int pageIndex)
+{
+    if (pageIndex < 0 || pageIndex >= pageFactories.size() || !pageFactories.at(pageIndex)) return;
+    QWidget* page = pageFactories.at(pageIndex)();
+    pageFactories[pageIndex] = nullptr;
+    ui->mainStackedWidget->widget(pageIndex)->layout()->addWidget(page);
+}
+
 void AdminWindow::onUserManagementClicked()
 {
     ui->mainStackedWidget->setCurrentIndex(0);
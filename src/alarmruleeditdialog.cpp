@@ -1,5 +1,6 @@
 #include "alarmruleeditdialog.h"
 #include "databasemanager.h"
+#include "alarmruleengine.h"
 #include <QComboBox>
 #include <QLineEdit>
 #include <QTextEdit>
@@ -34,7 +35,16 @@ void AlarmRuleEditDialog::setupUi()
     formLayout->addRow("执行动作:", actionTextEdit);
 
     QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
-    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, [this]() {
+        // 保存前先编译一次条件，语法错误直接提示位置
+        QString error;
+        QString condition = conditionTextEdit->toPlainText();
+        if (!condition.trimmed().isEmpty() && !AlarmCondition::validate(condition, &error)) {
+            QMessageBox::warning(this, "条件无效", error);
+            return;
+        }
+        accept();
+    });
     connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
 
     mainLayout->addLayout(formLayout);
@@ -0,0 +1,436 @@
+#include "alarmruleengine.h"
+#include <QMutexLocker>
+
+// 递归下降解析器：先构建语法树并做类型检查，再生成后缀字节码
+//   expr       := andExpr (OR andExpr)*
+//   andExpr    := notExpr (AND notExpr)*
+//   notExpr    := NOT notExpr | comparison
+//   comparison := additive ((< | <= | > | >= | = | == | != | <>) additive)?
+//   additive   := term ((+ | -) term)*
+//   term       := unary ((* | /) unary)*
+//   unary      := - unary | NUMBER | FIELD | ( expr )
+class AlarmConditionParser
+{
+public:
+    explicit AlarmConditionParser(const QString& text) : text(text), pos(0) {}
+
+    bool parse(AlarmCondition& condition, QString* error)
+    {
+        int root = parseOr();
+        skipSpaces();
+        if (errorMsg.isEmpty() && pos < text.size()) {
+            fail(QString("无法识别的内容 \"%1\"").arg(text.mid(pos, 10)));
+        }
+        if (errorMsg.isEmpty() && nodes[root].type != Bool) {
+            fail("条件的结果必须是比较或逻辑表达式");
+        }
+        if (!errorMsg.isEmpty()) {
+            if (error) *error = errorMsg;
+            return false;
+        }
+
+        condition.code.clear();
+        condition.stackDepth = generate(root, condition.code);
+        if (condition.stackDepth > AlarmCondition::MaxStackDepth) {
+            condition.code.clear();
+            if (error) *error = "条件过于复杂";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    enum ValueType { Number, Bool };
+    struct Node {
+        AlarmCondition::OpCode op;
+        ValueType type;
+        quint8 field;
+        double value;
+        int lhs;
+        int rhs;
+    };
+
+    const QString text;
+    int pos;
+    QString errorMsg;
+    QVector<Node> nodes;
+
+    void fail(const QString& message)
+    {
+        if (errorMsg.isEmpty()) {
+            errorMsg = QString("第 %1 个字符处: %2").arg(pos + 1).arg(message);
+        }
+    }
+
+    int addNode(AlarmCondition::OpCode op, ValueType type, int lhs = -1, int rhs = -1)
+    {
+        Node node;
+        node.op = op;
+        node.type = type;
+        node.field = 0;
+        node.value = 0;
+        node.lhs = lhs;
+        node.rhs = rhs;
+        nodes.append(node);
+        return nodes.size() - 1;
+    }
+
+    // 出错后返回一个占位常量节点，使解析可以直接返回而不必逐层判断
+    int errorNode()
+    {
+        return addNode(AlarmCondition::PushConst, Number);
+    }
+
+    void skipSpaces()
+    {
+        while (pos < text.size() && text.at(pos).isSpace()) ++pos;
+    }
+
+    bool matchSymbol(const char* symbol)
+    {
+        skipSpaces();
+        const QString s = QString::fromLatin1(symbol);
+        if (text.midRef(pos, s.size()) == s) {
+            pos += s.size();
+            return true;
+        }
+        return false;
+    }
+
+    bool matchKeyword(const char* keyword)
+    {
+        skipSpaces();
+        const QString s = QString::fromLatin1(keyword);
+        if (text.midRef(pos, s.size()).compare(s, Qt::CaseInsensitive) != 0) return false;
+        int end = pos + s.size();
+        if (end < text.size() && (text.at(end).isLetterOrNumber() || text.at(end) == '_')) return false;
+        pos = end;
+        return true;
+    }
+
+    bool expectType(int node, ValueType type, const char* what)
+    {
+        if (nodes[node].type != type) {
+            fail(QString::fromUtf8(what));
+            return false;
+        }
+        return true;
+    }
+
+    int parseOr()
+    {
+        int lhs = parseAnd();
+        while (errorMsg.isEmpty() && (matchKeyword("OR") || matchSymbol("||"))) {
+            int rhs = parseAnd();
+            if (!expectType(lhs, Bool, "OR 两侧必须是条件") || !expectType(rhs, Bool, "OR 两侧必须是条件")) {
+                return errorNode();
+            }
+            lhs = addNode(AlarmCondition::Or, Bool, lhs, rhs);
+        }
+        return lhs;
+    }
+
+    int parseAnd()
+    {
+        int lhs = parseNot();
+        while (errorMsg.isEmpty() && (matchKeyword("AND") || matchSymbol("&&"))) {
+            int rhs = parseNot();
+            if (!expectType(lhs, Bool, "AND 两侧必须是条件") || !expectType(rhs, Bool, "AND 两侧必须是条件")) {
+                return errorNode();
+            }
+            lhs = addNode(AlarmCondition::And, Bool, lhs, rhs);
+        }
+        return lhs;
+    }
+
+    int parseNot()
+    {
+        skipSpaces();
+        // "!" 需要与 "!=" 区分
+        bool bang = pos < text.size() && text.at(pos) == '!' && !(pos + 1 < text.size() && text.at(pos + 1) == '=');
+        if (bang) ++pos;
+        if (bang || matchKeyword("NOT")) {
+            int operand = parseNot();
+            if (!expectType(operand, Bool, "NOT 之后必须是条件")) return errorNode();
+            return addNode(AlarmCondition::Not, Bool, operand);
+        }
+        return parseComparison();
+    }
+
+    int parseComparison()
+    {
+        int lhs = parseAdditive();
+        if (!errorMsg.isEmpty()) return lhs;
+
+        // 长的运算符优先匹配
+        static const struct { const char* symbol; AlarmCondition::OpCode op; } ops[] = {
+            { "<=", AlarmCondition::Le }, { ">=", AlarmCondition::Ge },
+            { "==", AlarmCondition::Eq }, { "!=", AlarmCondition::Ne }, { "<>", AlarmCondition::Ne },
+            { "<", AlarmCondition::Lt }, { ">", AlarmCondition::Gt }, { "=", AlarmCondition::Eq }
+        };
+        for (const auto& entry : ops) {
+            if (matchSymbol(entry.symbol)) {
+                int rhs = parseAdditive();
+                if (!expectType(lhs, Number, "比较运算两侧必须是数值")
+                    || !expectType(rhs, Number, "比较运算两侧必须是数值")) {
+                    return errorNode();
+                }
+                return addNode(entry.op, Bool, lhs, rhs);
+            }
+        }
+        return lhs;
+    }
+
+    int parseAdditive()
+    {
+        int lhs = parseTerm();
+        while (errorMsg.isEmpty()) {
+            AlarmCondition::OpCode op;
+            if (matchSymbol("+")) op = AlarmCondition::Add;
+            else if (matchSymbol("-")) op = AlarmCondition::Sub;
+            else break;
+            int rhs = parseTerm();
+            if (!expectType(lhs, Number, "算术运算只能用于数值") || !expectType(rhs, Number, "算术运算只能用于数值")) {
+                return errorNode();
+            }
+            lhs = addNode(op, Number, lhs, rhs);
+        }
+        return lhs;
+    }
+
+    int parseTerm()
+    {
+        int lhs = parseUnary();
+        while (errorMsg.isEmpty()) {
+            AlarmCondition::OpCode op;
+            if (matchSymbol("*")) op = AlarmCondition::Mul;
+            else if (matchSymbol("/")) op = AlarmCondition::Div;
+            else break;
+            int rhs = parseUnary();
+            if (!expectType(lhs, Number, "算术运算只能用于数值") || !expectType(rhs, Number, "算术运算只能用于数值")) {
+                return errorNode();
+            }
+            lhs = addNode(op, Number, lhs, rhs);
+        }
+        return lhs;
+    }
+
+    int parseUnary()
+    {
+        if (matchSymbol("-")) {
+            int operand = parseUnary();
+            if (!expectType(operand, Number, "负号只能用于数值")) return errorNode();
+            // 常量直接取负，避免多一条指令
+            if (nodes[operand].op == AlarmCondition::PushConst) {
+                nodes[operand].value = -nodes[operand].value;
+                return operand;
+            }
+            return addNode(AlarmCondition::Neg, Number, operand);
+        }
+        return parsePrimary();
+    }
+
+    int parsePrimary()
+    {
+        skipSpaces();
+        if (pos >= text.size()) {
+            fail("条件不完整");
+            return errorNode();
+        }
+
+        if (matchSymbol("(")) {
+            int inner = parseOr();
+            if (errorMsg.isEmpty() && !matchSymbol(")")) {
+                fail("缺少右括号");
+            }
+            return inner;
+        }
+
+        const QChar c = text.at(pos);
+        if (c.isDigit() || c == '.') {
+            int start = pos;
+            while (pos < text.size() && (text.at(pos).isDigit() || text.at(pos) == '.')) ++pos;
+            bool ok = false;
+            double value = text.mid(start, pos - start).toDouble(&ok);
+            if (!ok) {
+                pos = start;
+                fail("无效的数值");
+                return errorNode();
+            }
+            int node = addNode(AlarmCondition::PushConst, Number);
+            nodes[node].value = value;
+            return node;
+        }
+
+        if (c.isLetter() || c == '_') {
+            int start = pos;
+            while (pos < text.size() && (text.at(pos).isLetterOrNumber() || text.at(pos) == '_')) ++pos;
+            const QString name = text.mid(start, pos - start).toLower();
+            int field = name == "temperature" ? 0 : name == "humidity" ? 1 : name == "light" ? 2 : -1;
+            if (field < 0) {
+                pos = start;
+                fail(QString("未知字段 \"%1\"，可用字段为 temperature、humidity、light").arg(name));
+                return errorNode();
+            }
+            int node = addNode(AlarmCondition::LoadField, Number);
+            nodes[node].field = static_cast<quint8>(field);
+            return node;
+        }
+
+        fail(QString("无法识别的符号 \"%1\"").arg(c));
+        return errorNode();
+    }
+
+    // 后序遍历生成字节码，返回该子树求值所需的栈深度
+    int generate(int index, QVector<AlarmCondition::Instruction>& code) const
+    {
+        const Node& node = nodes[index];
+        int depth = 1;
+        if (node.lhs >= 0) depth = generate(node.lhs, code);
+        if (node.rhs >= 0) depth = qMax(depth, 1 + generate(node.rhs, code));
+
+        AlarmCondition::Instruction ins;
+        ins.op = node.op;
+        ins.field = node.field;
+        ins.value = node.value;
+        code.append(ins);
+        return depth;
+    }
+};
+
+bool AlarmCondition::compile(const QString& text, QString* error)
+{
+    AlarmConditionParser parser(text);
+    if (!parser.parse(*this, error)) {
+        code.clear();
+        stackDepth = 0;
+        return false;
+    }
+    return true;
+}
+
+bool AlarmCondition::validate(const QString& text, QString* error)
+{
+    AlarmCondition condition;
+    return condition.compile(text, error);
+}
+
+bool AlarmCondition::evaluate(const MonitorSample& sample) const
+{
+    if (code.isEmpty()) return false;
+
+    const double fields[3] = { sample.temperature, sample.humidity, sample.light };
+    double stack[MaxStackDepth];
+    int sp = 0;
+    for (const Instruction& ins : code) {
+        switch (ins.op) {
+        case PushConst: stack[sp++] = ins.value; break;
+        case LoadField: stack[sp++] = fields[ins.field]; break;
+        case Neg: stack[sp - 1] = -stack[sp - 1]; break;
+        case Not: stack[sp - 1] = stack[sp - 1] == 0 ? 1 : 0; break;
+        default: {
+            const double rhs = stack[--sp];
+            double& lhs = stack[sp - 1];
+            switch (ins.op) {
+            case Add: lhs = lhs + rhs; break;
+            case Sub: lhs = lhs - rhs; break;
+            case Mul: lhs = lhs * rhs; break;
+            case Div: lhs = lhs / rhs; break;
+            case Lt: lhs = lhs < rhs; break;
+            case Le: lhs = lhs <= rhs; break;
+            case Gt: lhs = lhs > rhs; break;
+            case Ge: lhs = lhs >= rhs; break;
+            case Eq: lhs = (lhs == rhs); break;
+            case Ne: lhs = (lhs != rhs); break;
+            case And: lhs = (lhs != 0 && rhs != 0); break;
+            case Or: lhs = (lhs != 0 || rhs != 0); break;
+            default: break;
+            }
+            break;
+        }
+        }
+    }
+    return stack[0] != 0;
+}
+
+void AlarmRuleEngine::setRules(const QVector<CompiledAlarmRule>& rules, QStringList* errors)
+{
+    QHash<int, QVector<CompiledAlarmRule>> byDevice;
+    for (CompiledAlarmRule rule : rules) {
+        QString error;
+        if (!rule.compiled.isValid() && !rule.compiled.compile(rule.condition, &error)) {
+            if (errors) errors->append(QString("规则 %1 (%2): %3").arg(rule.rule_id).arg(rule.description, error));
+            continue;
+        }
+        byDevice[rule.device_id].append(rule);
+    }
+
+    QMutexLocker locker(&mutex);
+    rulesByDevice.swap(byDevice);
+    // 保留仍然存在的规则的触发状态，避免重新加载后重复告警
+    QHash<int, bool> active;
+    for (auto it = rulesByDevice.constBegin(); it != rulesByDevice.constEnd(); ++it) {
+        for (const CompiledAlarmRule& rule : it.value()) {
+            active.insert(rule.rule_id, activeRules.value(rule.rule_id, false));
+        }
+    }
+    activeRules.swap(active);
+}
+
+QVector<AlarmHit> AlarmRuleEngine::evaluate(const QVector<MonitorSample>& samples, Undo* undo)
+{
+    QVector<AlarmHit> hits;
+    QMutexLocker locker(&mutex);
+    totals.samples += samples.size();
+    if (rulesByDevice.isEmpty()) return hits;
+
+    for (const MonitorSample& sample : samples) {
+        auto it = rulesByDevice.constFind(sample.device_id);
+        if (it == rulesByDevice.constEnd()) continue;
+        totals.evaluations += it.value().size();
+        for (const CompiledAlarmRule& rule : it.value()) {
+            bool matched = rule.compiled.evaluate(sample);
+            bool& active = activeRules[rule.rule_id];
+            if (matched && !active) {
+                AlarmHit hit;
+                hit.rule_id = rule.rule_id;
+                hit.device_id = sample.device_id;
+                hit.timestamp = sample.timestamp;
+                hit.content = QString("%1（%2）").arg(rule.description, rule.condition);
+                hits.append(hit);
+            }
+            if (undo && active != matched && !undo->active.contains(rule.rule_id)) {
+                undo->active.insert(rule.rule_id, active);
+            }
+            active = matched;
+        }
+    }
+    totals.hits += hits.size();
+    if (undo) undo->hits += hits.size();
+    return hits;
+}
+
+void AlarmRuleEngine::restore(const Undo& undo)
+{
+    QMutexLocker locker(&mutex);
+    for (auto it = undo.active.constBegin(); it != undo.active.constEnd(); ++it) {
+        activeRules[it.key()] = it.value();
+    }
+    totals.hits -= undo.hits;
+}
+
+AlarmRuleEngine::Counters AlarmRuleEngine::counters() const
+{
+    QMutexLocker locker(&mutex);
+    return totals;
+}
+
+int AlarmRuleEngine::ruleCount() const
+{
+    QMutexLocker locker(&mutex);
+    int count = 0;
+    for (auto it = rulesByDevice.constBegin(); it != rulesByDevice.constEnd(); ++it) {
+        count += it.value().size();
+    }
+    return count;
+}
@@ -0,0 +1,56 @@
+#include "asyncqueryexecutor.h"
+#include <QCoreApplication>
+#include <QThread>
+
+QueryCoalescer::QueryCoalescer(QueryChannel& channel, const std::function<void()>& request, int delayMs,
+                               QObject *parent)
+    : QObject(parent), channel(channel), request(request)
+{
+    timer.setSingleShot(true);
+    timer.setInterval(delayMs);
+    connect(&timer, &QTimer::timeout, this, [this]() { this->request(); });
+}
+
+void QueryCoalescer::schedule()
+{
+    channel.cancel();
+    timer.start();   // 重新计时
+}
+
+void QueryCoalescer::runNow()
+{
+    timer.stop();
+    request();
+}
+
+void QueryCoalescer::cancel()
+{
+    timer.stop();
+    channel.cancel();
+}
+
+AsyncQueryExecutor& AsyncQueryExecutor::instance()
+{
+    // 挂在 QCoreApplication 下，保证在数据库驱动卸载前停止所有工作线程
+    static AsyncQueryExecutor* executor = new AsyncQueryExecutor(QCoreApplication::instance());
+    return *executor;
+}
+
+AsyncQueryExecutor::AsyncQueryExecutor(QObject *parent)
+    : QObject(parent)
+{
+    // SQLite 在 WAL 模式下支持多个并发读者，但写入仍是串行的，线程不宜过多
+    pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 4));
+    // 线程常驻，避免反复打开/关闭各线程的数据库连接
+    pool.setExpiryTimeout(-1);
+}
+
+AsyncQueryExecutor::~AsyncQueryExecutor()
+{
+    waitForDone();
+}
+
+void AsyncQueryExecutor::waitForDone()
+{
+    pool.waitForDone();
+}
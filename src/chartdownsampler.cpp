@@ -0,0 +1,57 @@
+#include "chartdownsampler.h"
+#include <cmath>
+
+namespace ChartDownsampler
+{
+
+QVector<QPointF> lttb(const QVector<QPointF>& points, int threshold)
+{
+    const int count = points.size();
+    if (threshold < 3 || count <= threshold) {
+        return points;
+    }
+
+    QVector<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(points.first());
+
+    // 中间的点均分到 threshold - 2 个桶
+    const double every = static_cast<double>(count - 2) / (threshold - 2);
+    int selected = 0;
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        const int start = static_cast<int>(bucket * every) + 1;
+        const int end = qMin(static_cast<int>((bucket + 1) * every) + 1, count - 1);
+
+        // 下一个桶的均值点，最后一个桶以终点代替
+        const int nextStart = end;
+        const int nextEnd = qMin(static_cast<int>((bucket + 2) * every) + 1, count);
+        double avgX = 0, avgY = 0;
+        for (int i = nextStart; i < nextEnd; ++i) {
+            avgX += points.at(i).x();
+            avgY += points.at(i).y();
+        }
+        const int nextCount = nextEnd - nextStart;
+        avgX /= nextCount;
+        avgY /= nextCount;
+
+        const QPointF& a = points.at(selected);
+        double maxArea = -1;
+        int best = start;
+        for (int i = start; i < end; ++i) {
+            // 三角形面积的两倍，比较大小时不必除以 2
+            const double area = std::fabs((a.x() - avgX) * (points.at(i).y() - a.y())
+                                          - (a.x() - points.at(i).x()) * (avgY - a.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                best = i;
+            }
+        }
+        sampled.append(points.at(best));
+        selected = best;
+    }
+
+    sampled.append(points.last());
+    return sampled;
+}
+
+}
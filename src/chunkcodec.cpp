@@ -0,0 +1,280 @@
+#include "chunkcodec.h"
+#include <QtEndian>
+#include <QtAlgorithms>
+#include <cstring>
+
+namespace {
+
+// 按位写入，高位在前
+class BitWriter
+{
+public:
+    explicit BitWriter(QByteArray& out) : out(out), acc(0), used(0) {}
+
+    // 写入 value 的低 bits 位（bits <= 64）
+    void write(quint64 value, int bits)
+    {
+        while (bits > 0) {
+            const int n = qMin(bits, 8 - used);
+            bits -= n;
+            acc = static_cast<quint8>((acc << n) | ((value >> bits) & ((1u << n) - 1)));
+            used += n;
+            if (used == 8) {
+                out.append(static_cast<char>(acc));
+                acc = 0;
+                used = 0;
+            }
+        }
+    }
+    void finish()
+    {
+        if (used > 0) {
+            out.append(static_cast<char>(acc << (8 - used)));
+            acc = 0;
+            used = 0;
+        }
+    }
+
+private:
+    QByteArray& out;
+    quint8 acc;
+    int used;
+};
+
+class BitReader
+{
+public:
+    BitReader(const uchar *data, int size) : data(data), size(size), pos(0), bit(0) {}
+
+    bool read(int bits, quint64& value)
+    {
+        value = 0;
+        while (bits > 0) {
+            if (pos >= size) return false;
+            const int avail = 8 - bit;
+            const int n = qMin(bits, avail);
+            value = (value << n) | ((data[pos] >> (avail - n)) & ((1u << n) - 1));
+            bit += n;
+            bits -= n;
+            if (bit == 8) {
+                bit = 0;
+                ++pos;
+            }
+        }
+        return true;
+    }
+
+private:
+    const uchar *data;
+    int size;
+    int pos;
+    int bit;
+};
+
+// 每个指标的异或编码状态
+struct XorState {
+    quint64 prev = 0;
+    int leading = -1;   // -1 表示还没有可沿用的窗口
+    int trailing = 0;
+};
+
+quint64 doubleBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(quint64 bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+quint64 zigzag(qint64 value)
+{
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+qint64 unzigzag(quint64 value)
+{
+    return static_cast<qint64>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// 前缀 1 的个数对应的数据位数
+const int timestampBits[6] = { 0, 7, 9, 12, 32, 64 };
+
+void writeTimestamp(BitWriter& writer, qint64 dod)
+{
+    if (dod == 0) {
+        writer.write(0, 1);
+        return;
+    }
+    const quint64 z = zigzag(dod);
+    int level = 1;
+    while (level < 5 && z >= (1ULL << timestampBits[level])) {
+        ++level;
+    }
+    // level 个 1，不足 5 个时以 0 结尾
+    writer.write((1ULL << level) - 1, level);
+    if (level < 5) writer.write(0, 1);
+    writer.write(z, timestampBits[level]);
+}
+
+bool readTimestamp(BitReader& reader, qint64& dod)
+{
+    int level = 0;
+    quint64 bit = 1;
+    while (level < 5) {
+        if (!reader.read(1, bit)) return false;
+        if (!bit) break;
+        ++level;
+    }
+    if (level == 0) {
+        dod = 0;
+        return true;
+    }
+    quint64 z;
+    if (!reader.read(timestampBits[level], z)) return false;
+    dod = unzigzag(z);
+    return true;
+}
+
+void writeValue(BitWriter& writer, XorState& state, double value)
+{
+    const quint64 bits = doubleBits(value);
+    const quint64 x = bits ^ state.prev;
+    state.prev = bits;
+    if (x == 0) {
+        writer.write(0, 1);
+        return;
+    }
+    writer.write(1, 1);
+    const int leading = qMin<int>(qCountLeadingZeroBits(x), 31);
+    const int trailing = static_cast<int>(qCountTrailingZeroBits(x));
+    if (state.leading >= 0 && leading >= state.leading && trailing >= state.trailing) {
+        writer.write(0, 1);
+        writer.write(x >> state.trailing, 64 - state.leading - state.trailing);
+        return;
+    }
+    const int meaningful = 64 - leading - trailing;
+    writer.write(1, 1);
+    writer.write(static_cast<quint64>(leading), 5);
+    writer.write(static_cast<quint64>(meaningful & 63), 6);
+    writer.write(x >> trailing, meaningful);
+    state.leading = leading;
+    state.trailing = trailing;
+}
+
+bool readValue(BitReader& reader, XorState& state, double& value)
+{
+    quint64 bit;
+    if (!reader.read(1, bit)) return false;
+    if (bit) {
+        quint64 control, x;
+        if (!reader.read(1, control)) return false;
+        if (!control) {
+            if (state.leading < 0) return false;
+            if (!reader.read(64 - state.leading - state.trailing, x)) return false;
+            x <<= state.trailing;
+        } else {
+            quint64 leading, meaningful;
+            if (!reader.read(5, leading) || !reader.read(6, meaningful)) return false;
+            if (meaningful == 0) meaningful = 64;
+            if (leading + meaningful > 64) return false;
+            const int trailing = static_cast<int>(64 - leading - meaningful);
+            if (!reader.read(static_cast<int>(meaningful), x)) return false;
+            x <<= trailing;
+            state.leading = static_cast<int>(leading);
+            state.trailing = trailing;
+        }
+        state.prev ^= x;
+    }
+    value = bitsDouble(state.prev);
+    return true;
+}
+
+}
+
+namespace ChunkCodec
+{
+
+QByteArray encode(const MonitorSample* samples, int count)
+{
+    QByteArray out;
+    if (count <= 0) return out;
+    out.reserve(HeaderSize + count * 4);
+
+    const MonitorSample& first = samples[0];
+    uchar header[HeaderSize];
+    qToLittleEndian<quint32>(static_cast<quint32>(count), header);
+    qToLittleEndian<qint64>(first.timestamp, header + 4);
+    qToLittleEndian<quint64>(doubleBits(first.temperature), header + 12);
+    qToLittleEndian<quint64>(doubleBits(first.humidity), header + 20);
+    qToLittleEndian<quint64>(doubleBits(first.light), header + 28);
+    out.append(reinterpret_cast<const char*>(header), HeaderSize);
+
+    XorState states[3];
+    states[0].prev = doubleBits(first.temperature);
+    states[1].prev = doubleBits(first.humidity);
+    states[2].prev = doubleBits(first.light);
+    qint64 prevTimestamp = first.timestamp;
+    qint64 prevDelta = 0;
+
+    BitWriter writer(out);
+    for (int i = 1; i < count; ++i) {
+        const MonitorSample& sample = samples[i];
+        const qint64 delta = sample.timestamp - prevTimestamp;
+        writeTimestamp(writer, delta - prevDelta);
+        prevTimestamp = sample.timestamp;
+        prevDelta = delta;
+        writeValue(writer, states[0], sample.temperature);
+        writeValue(writer, states[1], sample.humidity);
+        writeValue(writer, states[2], sample.light);
+    }
+    writer.finish();
+    return out;
+}
+
+bool decode(const QByteArray& data, int device_id, QVector<MonitorSample>& samples)
+{
+    if (data.size() < HeaderSize) return false;
+    const uchar *p = reinterpret_cast<const uchar*>(data.constData());
+    const quint32 count = qFromLittleEndian<quint32>(p);
+    if (count == 0) return true;
+    // 每条至少占 4 位，条数明显超出数据长度时视为损坏
+    if (count - 1 > static_cast<quint32>(data.size() - HeaderSize) * 2) return false;
+
+    MonitorSample sample;
+    sample.device_id = device_id;
+    sample.timestamp = qFromLittleEndian<qint64>(p + 4);
+    sample.temperature = bitsDouble(qFromLittleEndian<quint64>(p + 12));
+    sample.humidity = bitsDouble(qFromLittleEndian<quint64>(p + 20));
+    sample.light = bitsDouble(qFromLittleEndian<quint64>(p + 28));
+    samples.reserve(samples.size() + static_cast<int>(count));
+    samples.append(sample);
+
+    XorState states[3];
+    states[0].prev = doubleBits(sample.temperature);
+    states[1].prev = doubleBits(sample.humidity);
+    states[2].prev = doubleBits(sample.light);
+    qint64 prevDelta = 0;
+
+    BitReader reader(p + HeaderSize, data.size() - HeaderSize);
+    for (quint32 i = 1; i < count; ++i) {
+        qint64 dod;
+        if (!readTimestamp(reader, dod)
+            || !readValue(reader, states[0], sample.temperature)
+            || !readValue(reader, states[1], sample.humidity)
+            || !readValue(reader, states[2], sample.light)) {
+            return false;
+        }
+        prevDelta += dod;
+        sample.timestamp += prevDelta;
+        samples.append(sample);
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,433 @@
+#include "csvexporter.h"
+#include "databasemanager.h"
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QProgressDialog>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QtConcurrent/QtConcurrentRun>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+const int bufferSize = 1 << 20;       // 攒满 1 MB 再写文件/压缩
+const qint64 progressInterval = 10000; // 每写这么多行通知一次进度
+
+// 输出端：CSV 文本先进入缓冲区，攒满后按压缩方式写入文件
+class OutputSink
+{
+public:
+    virtual ~OutputSink() {}
+    virtual bool open(const QString& fileName, QString& error) = 0;
+    // data 为一整块缓冲
+    virtual bool write(const QByteArray& data) = 0;
+    virtual bool finish() = 0;
+
+protected:
+    QFile file;
+};
+
+class PlainSink : public OutputSink
+{
+public:
+    bool open(const QString& fileName, QString& error) override
+    {
+        file.setFileName(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            error = file.errorString();
+            return false;
+        }
+        return true;
+    }
+    bool write(const QByteArray& data) override
+    {
+        return file.write(data) == data.size();
+    }
+    bool finish() override
+    {
+        file.close();
+        return file.error() == QFileDevice::NoError;
+    }
+};
+
+#ifdef HAVE_ZLIB
+class GzipSink : public OutputSink
+{
+public:
+    GzipSink() : initialized(false), out(bufferSize, Qt::Uninitialized) {}
+    ~GzipSink() override
+    {
+        if (initialized) deflateEnd(&stream);
+    }
+    bool open(const QString& fileName, QString& error) override
+    {
+        file.setFileName(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            error = file.errorString();
+            return false;
+        }
+        stream = z_stream();
+        // windowBits + 16 输出 gzip 格式；压缩级别 6 在速度和体积之间折中
+        if (deflateInit2(&stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            error = "无法初始化 gzip 压缩";
+            return false;
+        }
+        initialized = true;
+        return true;
+    }
+    bool write(const QByteArray& data) override
+    {
+        return deflateData(data, Z_NO_FLUSH);
+    }
+    bool finish() override
+    {
+        const bool ok = deflateData(QByteArray(), Z_FINISH);
+        file.close();
+        return ok && file.error() == QFileDevice::NoError;
+    }
+
+private:
+    bool deflateData(const QByteArray& data, int flush)
+    {
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        int ret;
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(out.data());
+            stream.avail_out = static_cast<uInt>(out.size());
+            ret = deflate(&stream, flush);
+            if (ret == Z_STREAM_ERROR) return false;
+            const qint64 produced = out.size() - stream.avail_out;
+            if (produced > 0 && file.write(out.constData(), produced) != produced) return false;
+        } while (stream.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+        return true;
+    }
+
+    z_stream stream;
+    bool initialized;
+    QByteArray out;
+};
+#endif
+
+#ifdef HAVE_ZSTD
+class ZstdSink : public OutputSink
+{
+public:
+    ZstdSink() : stream(nullptr), out(static_cast<int>(ZSTD_CStreamOutSize()), Qt::Uninitialized) {}
+    ~ZstdSink() override
+    {
+        if (stream) ZSTD_freeCStream(stream);
+    }
+    bool open(const QString& fileName, QString& error) override
+    {
+        file.setFileName(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            error = file.errorString();
+            return false;
+        }
+        stream = ZSTD_createCStream();
+        if (!stream || ZSTD_isError(ZSTD_initCStream(stream, 3))) {
+            error = "无法初始化 zstd 压缩";
+            return false;
+        }
+        return true;
+    }
+    bool write(const QByteArray& data) override
+    {
+        ZSTD_inBuffer input = { data.constData(), static_cast<size_t>(data.size()), 0 };
+        while (input.pos < input.size) {
+            ZSTD_outBuffer output = { out.data(), static_cast<size_t>(out.size()), 0 };
+            if (ZSTD_isError(ZSTD_compressStream(stream, &output, &input)) || !flushOutput(output)) return false;
+        }
+        return true;
+    }
+    bool finish() override
+    {
+        size_t remaining;
+        do {
+            ZSTD_outBuffer output = { out.data(), static_cast<size_t>(out.size()), 0 };
+            remaining = ZSTD_endStream(stream, &output);
+            if (ZSTD_isError(remaining) || !flushOutput(output)) return false;
+        } while (remaining > 0);
+        file.close();
+        return file.error() == QFileDevice::NoError;
+    }
+
+private:
+    bool flushOutput(const ZSTD_outBuffer& output)
+    {
+        const qint64 produced = static_cast<qint64>(output.pos);
+        return produced == 0 || file.write(out.constData(), produced) == produced;
+    }
+
+    ZSTD_CStream* stream;
+    QByteArray out;
+};
+#endif
+
+OutputSink* createSink(CsvExporter::Compression compression)
+{
+    switch (compression) {
+#ifdef HAVE_ZLIB
+    case CsvExporter::Gzip:
+        return new GzipSink;
+#endif
+#ifdef HAVE_ZSTD
+    case CsvExporter::Zstd:
+        return new ZstdSink;
+#endif
+    case CsvExporter::NoCompression:
+        return new PlainSink;
+    default:
+        return nullptr;
+    }
+}
+
+// 含逗号、引号或换行的字段加引号，引号转义为两个引号
+void appendField(QByteArray& buffer, const QByteArray& field)
+{
+    bool quote = false;
+    for (char c : field) {
+        if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+            quote = true;
+            break;
+        }
+    }
+    if (!quote) {
+        buffer.append(field);
+        return;
+    }
+    buffer.append('"');
+    for (char c : field) {
+        if (c == '"') buffer.append('"');
+        buffer.append(c);
+    }
+    buffer.append('"');
+}
+
+void appendValue(QByteArray& buffer, const QVariant& value)
+{
+    switch (value.type()) {
+    case QVariant::Invalid:
+        break;
+    case QVariant::Int:
+    case QVariant::LongLong:
+        buffer.append(QByteArray::number(value.toLongLong()));
+        break;
+    case QVariant::Double:
+        buffer.append(QByteArray::number(value.toDouble(), 'g', 15));
+        break;
+    default:
+        appendField(buffer, value.toString().toUtf8());
+        break;
+    }
+}
+
+}
+
+CsvExporter::CsvExporter(QObject *parent)
+    : QObject(parent), cancelled(0)
+{
+    connect(&watcher, &QFutureWatcher<Result>::finished, this, [this]() {
+        const Result result = watcher.result();
+        emit finished(result.ok, result.rows, result.error);
+    });
+}
+
+CsvExporter::~CsvExporter()
+{
+    cancel();
+    watcher.waitForFinished();
+}
+
+bool CsvExporter::start(const Request& request)
+{
+    if (isRunning()) return false;
+    cancelled.store(0);
+    watcher.setFuture(QtConcurrent::run([this, request]() { return run(request); }));
+    return true;
+}
+
+void CsvExporter::cancel()
+{
+    cancelled.store(1);
+}
+
+bool CsvExporter::isRunning() const
+{
+    return watcher.isRunning();
+}
+
+bool CsvExporter::isCancelled() const
+{
+    return cancelled.load() != 0;
+}
+
+CsvExporter::RowSource CsvExporter::querySource(const QString& sql, const QVariantList& bindValues)
+{
+    return [sql, bindValues](const RowCallback& callback, QString& error) -> bool {
+        // 工作线程自己的连接；forward-only 不缓存已读过的行
+        QSqlQuery query(DatabaseManager::instance().connection());
+        query.setForwardOnly(true);
+        query.prepare(sql);
+        for (const QVariant& value : bindValues) {
+            query.addBindValue(value);
+        }
+        if (!query.exec()) {
+            error = query.lastError().text();
+            return false;
+        }
+        const int columns = query.record().count();
+        QVariantList row;
+        row.reserve(columns);
+        while (query.next()) {
+            row.clear();
+            for (int i = 0; i < columns; ++i) {
+                row.append(query.value(i));
+            }
+            if (!callback(row)) break;
+        }
+        return true;
+    };
+}
+
+CsvExporter::Compression CsvExporter::compressionForFile(const QString& fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+    if (suffix == "gz") return Gzip;
+    if (suffix == "zst") return Zstd;
+    return NoCompression;
+}
+
+bool CsvExporter::isSupported(Compression compression)
+{
+    switch (compression) {
+    case NoCompression:
+        return true;
+    case Gzip:
+#ifdef HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case Zstd:
+#ifdef HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+QString CsvExporter::fileFilter()
+{
+    QStringList filters;
+    filters << "CSV 文件 (*.csv)";
+    if (isSupported(Gzip)) filters << "gzip 压缩的 CSV (*.csv.gz)";
+    if (isSupported(Zstd)) filters << "zstd 压缩的 CSV (*.csv.zst)";
+    return filters.join(";;");
+}
+
+CsvExporter::Result CsvExporter::run(const Request& request)
+{
+    Result result;
+    QScopedPointer<OutputSink> sink(createSink(request.compression));
+    if (!sink) {
+        result.error = "当前构建不支持该压缩格式";
+        return result;
+    }
+    if (!sink->open(request.fileName, result.error)) {
+        return result;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(bufferSize + 4096);
+    bool writeOk = true;
+    // Excel 按 BOM 识别 UTF-8
+    buffer.append("\xEF\xBB\xBF");
+    for (int i = 0; i < request.headers.size(); ++i) {
+        if (i > 0) buffer.append(',');
+        appendField(buffer, request.headers.at(i).toUtf8());
+    }
+    buffer.append('\n');
+
+    const bool sourceOk = request.source([&](const QVariantList& row) -> bool {
+        if (cancelled.load()) return false;
+        for (int i = 0; i < row.size(); ++i) {
+            if (i > 0) buffer.append(',');
+            appendValue(buffer, row.at(i));
+        }
+        buffer.append('\n');
+        if (buffer.size() >= bufferSize) {
+            writeOk = sink->write(buffer);
+            buffer.clear();
+            if (!writeOk) return false;
+        }
+        if (++result.rows % progressInterval == 0) {
+            emit progress(result.rows, request.expectedRows);
+        }
+        return true;
+    }, result.error);
+
+    if (cancelled.load()) {
+        result.error = "导出已取消";
+    } else if (!writeOk) {
+        result.error = "写入文件失败";
+    } else if (sourceOk) {
+        result.ok = (buffer.isEmpty() || sink->write(buffer)) && sink->finish();
+        if (!result.ok) result.error = "写入文件失败";
+    }
+    if (!result.ok) {
+        sink.reset();
+        QFile::remove(request.fileName);
+    }
+    return result;
+}
+
+void CsvExporter::exportWithDialog(QWidget *parent, const QString& title, Request request)
+{
+    if (request.fileName.isEmpty()) {
+        request.fileName = QFileDialog::getSaveFileName(parent, title, "", fileFilter());
+        if (request.fileName.isEmpty()) return;
+    }
+    request.compression = compressionForFile(request.fileName);
+    if (!isSupported(request.compression)) {
+        QMessageBox::warning(parent, "错误", "当前版本不支持该压缩格式。");
+        return;
+    }
+
+    // 对话框关闭时一并销毁导出器；导出器析构时会取消并等待工作线程
+    QProgressDialog* dialog = new QProgressDialog("正在导出...", "取消", 0, 0, parent);
+    dialog->setWindowTitle(title);
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setMinimumDuration(300);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    CsvExporter* exporter = new CsvExporter(dialog);
+    connect(dialog, &QProgressDialog::canceled, exporter, &CsvExporter::cancel);
+    connect(exporter, &CsvExporter::progress, dialog, [dialog](qint64 rows, qint64 expectedRows) {
+        if (expectedRows > 0) {
+            dialog->setMaximum(1000);
+            dialog->setValue(static_cast<int>(qMin<qint64>(1000, rows * 1000 / expectedRows)));
+        }
+        dialog->setLabelText(QString("已导出 %1 行...").arg(rows));
+    });
+    const QString fileName = request.fileName;
+    connect(exporter, &CsvExporter::finished, dialog, [dialog, exporter, parent, fileName](bool ok, qint64 rows, const QString& error) {
+        dialog->close();
+        if (ok) {
+            QMessageBox::information(parent, "成功", QString("已导出 %1 行到: %2").arg(rows).arg(fileName));
+        } else if (!exporter->isCancelled()) {
+            QMessageBox::warning(parent, "错误", "导出失败: " + error);
+        }
+    });
+    exporter->start(request);
+}
@@ -1,18 +1,205 @@
 #include "databasemanager.h"
+#include "alarmruleengine.h"
+#include "writebehindqueue.h"
+#include "logwriter.h"
+#include "chunkcodec.h"
+#include "statementcache.h"
 #include <QDir>
 #include <QCryptographicHash>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QSqlDriver>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
+#include <QPair>
+#include <QThread>
+#include <QThreadStorage>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <limits>
+
+// 汇总表：粒度从细到粗，下标 + 1 即 Resolution
+const DatabaseManager::RollupTable DatabaseManager::rollupTables[DatabaseManager::rollupTableCount] = {
+    { "monitor_rollup_1m", 60 * 1000LL },
+    { "monitor_rollup_1h", 60 * 60 * 1000LL },
+    { "monitor_rollup_1d", 24 * 60 * 60 * 1000LL }
+};
+const char* const DatabaseManager::rollupMetrics[3] = { "temperature", "humidity", "light" };
+const char* const DatabaseManager::partitionedTables[2] = { "monitor_data", "system_logs" };
+
+namespace {
+// 工作线程各自持有的命名连接，线程结束时由 QThreadStorage 析构并移除
+struct ThreadConnection {
+    QSqlDatabase db;
+    StatementCache statements;
+    int synchronous = -1;   // 已应用的 Durability，-1 表示尚未设置
+    int tuning = -1;        // 已应用的 TuningProfile 版本（tuningGeneration），-1 表示尚未设置
+    ~ThreadConnection()
+    {
+        statements.clear();
+        QString name = db.connectionName();
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+};
+QThreadStorage<ThreadConnection*> threadConnections;
+// 当前线程是否处于 beginTransaction() 开启的事务中；单条写入接口据此决定并入还是自己开启事务
+QThreadStorage<bool> outerTransactions;
+// 外层事务中产生的告警：commitTransaction() 后通知，rollbackTransaction() 时撤销规则状态
+struct OuterAlarms {
+    QVector<AlarmHit> hits;
+    AlarmRuleEngine::Undo undo;
+};
+QThreadStorage<OuterAlarms> outerAlarms;
+
+// 所有连接共用的 SQLite 连接参数：读写并发时等待锁而不是直接报 SQLITE_BUSY（打开后由 TuningProfile::busyTimeoutMs 覆盖）
+const char* const sqliteConnectOptions = "QSQLITE_BUSY_TIMEOUT=5000";
+
+// 下标与 DatabaseManager::Durability 一致
+const char* const synchronousPragmas[3] = {
+    "PRAGMA synchronous=FULL", "PRAGMA synchronous=NORMAL", "PRAGMA synchronous=OFF"
+};
+
+const char* const insertMonitorDataSql =
+    "INSERT INTO monitor_data (device_id, timestamp, temperature, humidity, light) VALUES (?, ?, ?, ?, ?)";
+const char* const insertAlarmRecordSql =
+    "INSERT INTO alarm_records (device_id, timestamp, content, status, note) VALUES (?, ?, ?, ?, ?)";
+const char* const insertLogSql =
+    "INSERT INTO system_logs (timestamp, log_type, log_level, content, user_id, device_id) VALUES (?, ?, ?, ?, ?, ?)";
+
+// 分块存储：块不跨越整点小时，每块最多约 maxChunkSamples 条
+const qint64 chunkSpanMs = 60 * 60 * 1000LL;
+const int maxChunkSamples = 8192;
+
+qint64 chunkWindow(qint64 timestamp)
+{
+    return timestamp - timestamp % chunkSpanMs;
+}
+
+// 分区按 UTC 自然日封存
+const qint64 partitionSpanMs = 24 * 60 * 60 * 1000LL;
+const qint64 minTimestamp = std::numeric_limits<qint64>::min();
+// 分区登记表：name == base_table 的一行表示当前写入的表，min_ts 为其起始日
+const char tablePartitionsSql[] =
+    "CREATE TABLE table_partitions ("
+    "name TEXT PRIMARY KEY,"
+    "base_table TEXT NOT NULL,"
+    "min_ts INTEGER,"
+    "max_ts INTEGER"
+    ")";
+const qint64 maxTimestamp = std::numeric_limits<qint64>::max();
+// 保留策略执行位置：table_name 表中早于 retained_from 的数据可能已被删除，之后的完整保留
+const char retentionCutoffsSql[] =
+    "CREATE TABLE retention_cutoffs ("
+    "table_name TEXT PRIMARY KEY,"
+    "retained_from INTEGER NOT NULL"
+    ")";
+
+// 在独立线程中启动时执行一次 task，之后每 intervalMs 毫秒执行一次；task 使用该线程自己的数据库连接
+QThread* startPeriodicThread(int intervalMs, const std::function<void()>& task)
+{
+    QThread* thread = new QThread;
+    QTimer* timer = new QTimer;
+    timer->setInterval(intervalMs);
+    timer->moveToThread(thread);
+    QObject::connect(thread, &QThread::started, timer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    QObject::connect(thread, &QThread::started, timer, task);
+    QObject::connect(timer, &QTimer::timeout, timer, task);
+    QObject::connect(thread, &QThread::finished, timer, &QObject::deleteLater);
+    thread->start();
+    return thread;
+}
+
+void stopPeriodicThread(QThread*& thread)
+{
+    if (!thread) return;
+    thread->quit();
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+}
+
+// 按时间顺序逐块解码 monitor_chunks 中与 [start, end] 重叠的样本，同一时刻只保留一块解码结果
+class ChunkCursor
+{
+public:
+    ChunkCursor(const QSqlDatabase& db, StatementCache* statements, int device_id, qint64 start, qint64 end, bool descending)
+        : query(db, statements), device_id(device_id), start(start), end(end), descending(descending), index(0)
+    {
+        query.setForwardOnly(true);
+        // 块不跨整点，与 start 重叠的块一定从 start 所在小时开始，start_ts 可以走主键范围扫描
+        query.prepare(QString("SELECT data FROM monitor_chunks WHERE device_id=? AND start_ts BETWEEN ? AND ? "
+                              "AND end_ts >= ? ORDER BY start_ts %1").arg(descending ? "DESC" : "ASC"));
+        query.addBindValue(device_id);
+        query.addBindValue(chunkWindow(start));
+        query.addBindValue(end);
+        query.addBindValue(start);
+    }
+    bool exec() { return query.exec(); }
+    QSqlError lastError() const { return query.lastError(); }
+
+    bool next(MonitorSample& sample)
+    {
+        while (index >= buffer.size()) {
+            if (!query.next()) return false;
+            decoded.clear();
+            if (!ChunkCodec::decode(query.value(0).toByteArray(), device_id, decoded)) {
+                qWarning() << "monitor_chunks 数据块损坏，设备" << device_id;
+            }
+            buffer.clear();
+            for (const MonitorSample& item : decoded) {
+                if (item.timestamp >= start && item.timestamp <= end) buffer.append(item);
+            }
+            if (descending) std::reverse(buffer.begin(), buffer.end());
+            index = 0;
+        }
+        sample = buffer[index++];
+        return true;
+    }
+
+private:
+    InstrumentedQuery query;
+    int device_id;
+    qint64 start;
+    qint64 end;
+    bool descending;
+    QVector<MonitorSample> decoded;
+    QVector<MonitorSample> buffer;
+    int index;
+};
+}
 
 DatabaseManager::DatabaseManager(QObject *parent)
-    : QObject(parent), connected(false)
+    : QObject(parent), connected(false), deviceCacheValid(false), changeTimer(nullptr), dataVersion(-1), checkedLocalCommits(0), skippedChanges(0),
+      alarmEngine(new AlarmRuleEngine), statementCache(new StatementCache), writeQueue(nullptr), durabilityLevel(DurabilityFull),
+      compactThread(nullptr), partitionThread(nullptr), checkpointThread(nullptr)
 {
+    qRegisterMetaType<MonitorSample>("MonitorSample");
+    retentionDays.insert("monitor_data", 30);
+    retentionDays.insert("monitor_rollup_1m", 365);
+    retentionDays.insert("system_logs", 90);
+    QueryStats::global().setSlowQueryThreshold(200);
+    QueryStats::global().setSlowQueryHandler([this](const QString& sql, const QVariantList& bindValues, qint64 micros) {
+        logSlowQuery(sql, bindValues, micros);
+    });
 }
 
 DatabaseManager::~DatabaseManager()
 {
+    QueryStats::global().setSlowQueryHandler(nullptr);
+    stopPeriodicThread(checkpointThread);
+    setPartitionMaintenance(false);
+    setChunkStorage(false);
+    setWriteBehind(false);
+    logWriter.reset();   // 写完缓冲中剩余的日志
+    statementCache->clear();
     if (db.isOpen()) {
         db.close();
         emit databaseDisconnected();
@@ -25,8 +212,23 @@ DatabaseManager::~DatabaseManager()
 
 bool DatabaseManager::dropTables()
 {
-    QStringList tables = {"users", "devices", "monitor_data", "alarm_rules", "alarm_records", "system_logs"};
+    QStringList tables = {"users", "devices", "monitor_data", "alarm_rules", "alarm_records", "system_logs",
+                          "monitor_rollup_1m", "monitor_rollup_1h", "monitor_rollup_1d", "monitor_chunks"};
     bool success = true;
+
+    // 已封存的分区和合并视图
+    InstrumentedQuery query(connection(), statements());
+    if (query.exec("SELECT name FROM table_partitions WHERE name<>base_table")) {
+        while (query.next()) {
+            tables << query.value(0).toString();
+        }
+    }
+    tables << "table_partitions" << "retention_cutoffs";
+    for (const char* base : partitionedTables) {
+        if (!executeQuery(QString("DROP VIEW IF EXISTS %1_all").arg(base))) {
+            success = false;
+        }
+    }
     
     for (const QString& table : tables) {
         if (!executeQuery(QString("DROP TABLE IF EXISTS %1").arg(table))) {
@@ -37,9 +239,11 @@ bool DatabaseManager::dropTables()
     return success;
 }
 
-bool DatabaseManager::initDatabase()
+bool DatabaseManager::initDatabase(const QString& path)
 {
     if (connected) {
+        stopPeriodicThread(checkpointThread);
+        statementCache->clear();
         QString connectionName = db.connectionName();
         db.close();
         db = QSqlDatabase();
@@ -48,8 +252,9 @@ bool DatabaseManager::initDatabase()
     }
 
     db = QSqlDatabase::addDatabase("QSQLITE");
-    QString dbPath = QDir::currentPath() + "/internetmonitoring.db";
+    dbPath = path.isEmpty() ? QDir::currentPath() + "/internetmonitoring.db" : path;
     db.setDatabaseName(dbPath);
+    db.setConnectOptions(sqliteConnectOptions);
 
     bool dbExists = QFile::exists(dbPath);
 
@@ -61,19 +266,461 @@ bool DatabaseManager::initDatabase()
     connected = true;
     emit databaseConnected();
 
+    const TuningProfile profile = tuningProfile();
+    if (!dbExists) {
+        // page_size 只能在写入第一页之前（切换到 WAL 之前）设置
+        executeQuery(QString("PRAGMA page_size=%1").arg(profile.pageSize));
+    }
+    // WAL 模式下后台线程的读连接不会阻塞写入（该设置持久化在数据库文件中）
+    executeQuery("PRAGMA journal_mode=WAL");
+    executeQuery(synchronousPragmas[durabilityLevel.loadAcquire()]);
+    applyTuning(db, profile);
+
     if (!dbExists) {
         // 仅首次创建数据库时建表
         if (!createTables()) {
             setLastError("创建表失败");
             return false;
         }
+    } else if (!migrateSchema()) {
+        return false;
+    }
+    invalidateDeviceCache();
+    loadLatestSamples();
+    loadAlarmRules();
+
+    if (!logWriter) {
+        logWriter.reset(new LogWriter([this](const QVector<LogEntry>& entries) {
+            return writeLogs(entries);
+        }));
+        logWriter->start();
+    }
+    startCheckpointThread(profile);
+
+#ifdef QT_DEBUG
+    // 调试构建下确认历史查询走 (device_id, timestamp) 索引
+    QStringList plan = explainQueryPlan("SELECT timestamp, temperature, humidity, light FROM monitor_data "
+                                        "WHERE device_id=? AND timestamp BETWEEN ? AND ? ORDER BY timestamp DESC",
+                                        QVariantList() << 1 << 0 << 0);
+    if (!plan.join(' ').contains("idx_monitor_data_device_ts")) {
+        qWarning() << "monitor_data 历史查询未使用索引:" << plan;
+    }
+#endif
+    return true;
+}
+
+void DatabaseManager::watchExternalChanges(int intervalMs)
+{
+    if (!changeTimer) {
+        changeTimer = new QTimer(this);
+        connect(changeTimer, &QTimer::timeout, this, &DatabaseManager::checkExternalChanges);
+    }
+    dataVersion = -1;
+    checkExternalChanges();
+    changeTimer->start(intervalMs);
+}
+
+void DatabaseManager::checkExternalChanges()
+{
+    // data_version 只在其他连接提交后变化，本连接的写入不会触发；
+    // 本进程其他线程的连接提交时也会变化，这些写入已经更新过缓存，不需要重新加载
+    QSqlQuery query("PRAGMA data_version", db);
+    if (!query.next()) return;
+    const qint64 version = query.value(0).toLongLong();
+    const quint64 commits = localCommits.loadAcquire();
+    if (version == dataVersion) return;
+    const bool firstCheck = (dataVersion < 0);
+    const bool localOnly = (commits != checkedLocalCommits);
+    dataVersion = version;
+    checkedLocalCommits = commits;
+    if (firstCheck) return;
+    // 同一段时间内也可能有其他进程写入，无法区分；连续跳过若干次后仍重新加载一次，外部写入最多延迟这么多个检查周期
+    const int maxSkippedChanges = 10;
+    if (localOnly && ++skippedChanges < maxSkippedChanges) return;
+    skippedChanges = 0;
+
+    invalidateDeviceCache();
+    QHash<int, MonitorSample> before;
+    {
+        QReadLocker locker(&latestLock);
+        before = latestSamples;
+    }
+    if (!loadLatestSamples()) return;
+
+    QVector<MonitorSample> changed;
+    {
+        QReadLocker locker(&latestLock);
+        for (auto it = latestSamples.constBegin(); it != latestSamples.constEnd(); ++it) {
+            auto old = before.constFind(it.key());
+            if (old == before.constEnd() || old.value().timestamp < it.value().timestamp) {
+                changed.append(it.value());
+            }
+        }
+    }
+    for (const MonitorSample& sample : changed) {
+        emit latestSampleChanged(sample.device_id, sample);
+    }
+}
+
+QSqlDatabase DatabaseManager::connection()
+{
+    // 主线程使用默认连接，其他线程按需打开各自的命名连接
+    if (QThread::currentThread() == thread()) {
+        return db;
+    }
+    if (!threadConnections.hasLocalData()) {
+        ThreadConnection* holder = new ThreadConnection;
+        QString name = QString("internetmonitoring_%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()), 0, 16);
+        holder->db = QSqlDatabase::addDatabase("QSQLITE", name);
+        holder->db.setDatabaseName(dbPath);
+        holder->db.setConnectOptions(sqliteConnectOptions);
+        if (!holder->db.open()) {
+            setLastError("无法打开线程数据库连接: " + holder->db.lastError().text());
+        }
+        threadConnections.setLocalData(holder);
+    }
+    ThreadConnection* holder = threadConnections.localData();
+    const int level = durabilityLevel.loadAcquire();
+    if (holder->synchronous != level && holder->db.isOpen()) {
+        // 事务中不能修改 synchronous，失败时下次再试
+        QSqlQuery query(holder->db);
+        if (query.exec(synchronousPragmas[level])) {
+            holder->synchronous = level;
+        }
+    }
+    const int generation = tuningGeneration.loadAcquire();
+    if (holder->tuning != generation && holder->db.isOpen() && applyTuning(holder->db, tuningProfile())) {
+        holder->tuning = generation;
+    }
+    return holder->db;
+}
+
+StatementCache* DatabaseManager::statements()
+{
+    if (QThread::currentThread() == thread()) {
+        return statementCache.data();
+    }
+    if (!threadConnections.hasLocalData()) {
+        connection();
+    }
+    return &threadConnections.localData()->statements;
+}
+
+void DatabaseManager::setStatementCacheCapacity(int capacity)
+{
+    StatementCache::setCapacity(capacity);
+}
+
+int DatabaseManager::statementCacheCapacity() const
+{
+    return StatementCache::capacity();
+}
+
+void DatabaseManager::setDurability(Durability level)
+{
+    durabilityLevel.storeRelease(level);
+    if (connected) {
+        executeQuery(synchronousPragmas[level]);
+    }
+}
+
+DatabaseManager::Durability DatabaseManager::durability() const
+{
+    return static_cast<Durability>(durabilityLevel.loadAcquire());
+}
+
+QStringList DatabaseManager::tuningProfileNames()
+{
+    return {"default", "interactive", "ingest", "bulk"};
+}
+
+bool DatabaseManager::findTuningProfile(const QString& name, TuningProfile& profile)
+{
+    TuningProfile result;
+    result.name = name;
+    if (name == "default") {
+        // SQLite 默认值，与不调用 setTuningProfile 相同
+    } else if (name == "interactive") {
+        // 界面程序：读多写少，较大的页缓存和内存映射加快历史查询，自动检查点即可
+        result.durability = DurabilityNormal;
+        result.cacheSizeKb = 16 * 1024;
+        result.mmapSizeBytes = 256LL * 1024 * 1024;
+        result.tempStoreMemory = true;
+        result.journalSizeLimitBytes = 64LL * 1024 * 1024;
+    } else if (name == "ingest") {
+        // 持续写入：检查点从提交事务的写线程移到检查点线程，WAL 超过 64MB 时截断
+        result.durability = DurabilityNormal;
+        result.cacheSizeKb = 64 * 1024;
+        result.mmapSizeBytes = 256LL * 1024 * 1024;
+        result.tempStoreMemory = true;
+        result.walAutoCheckpointPages = 0;
+        result.journalSizeLimitBytes = 64LL * 1024 * 1024;
+        result.checkpointIntervalMs = 1000;
+    } else if (name == "bulk") {
+        // 批量导入（如 FleetGenerator）：失败时删除文件重来，不需要掉电保护
+        result.durability = DurabilityOff;
+        result.cacheSizeKb = 256 * 1024;
+        result.mmapSizeBytes = 1024LL * 1024 * 1024;
+        result.tempStoreMemory = true;
+        result.pageSize = 8192;
+        result.walAutoCheckpointPages = 0;
+        result.journalSizeLimitBytes = 64LL * 1024 * 1024;
+        result.checkpointIntervalMs = 5000;
+        result.walLimitBytes = 256LL * 1024 * 1024;
+    } else {
+        return false;
+    }
+    profile = result;
+    return true;
+}
+
+void DatabaseManager::setTuningProfile(const TuningProfile& profile)
+{
+    {
+        QMutexLocker locker(&tuningMutex);
+        tuning = profile;
+    }
+    tuningGeneration.ref();
+    setDurability(profile.durability);
+    if (connected) {
+        applyTuning(db, profile);
+        startCheckpointThread(profile);
+    }
+}
+
+DatabaseManager::TuningProfile DatabaseManager::tuningProfile() const
+{
+    QMutexLocker locker(&tuningMutex);
+    TuningProfile profile = tuning;
+    profile.durability = durability();
+    return profile;
+}
+
+bool DatabaseManager::applyTuning(const QSqlDatabase& connection, const TuningProfile& profile)
+{
+    // cache_size 为负数时单位是 KiB
+    const QStringList pragmas = {
+        QString("PRAGMA cache_size=%1").arg(-qint64(profile.cacheSizeKb)),
+        QString("PRAGMA mmap_size=%1").arg(profile.mmapSizeBytes),
+        QString("PRAGMA temp_store=%1").arg(profile.tempStoreMemory ? "MEMORY" : "DEFAULT"),
+        QString("PRAGMA wal_autocheckpoint=%1").arg(profile.walAutoCheckpointPages),
+        QString("PRAGMA journal_size_limit=%1").arg(profile.journalSizeLimitBytes),
+        QString("PRAGMA busy_timeout=%1").arg(profile.busyTimeoutMs)
+    };
+    QSqlQuery query(connection);
+    bool ok = true;
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << pragma << "失败:" << query.lastError().text();
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void DatabaseManager::startCheckpointThread(const TuningProfile& profile)
+{
+    stopPeriodicThread(checkpointThread);
+    if (profile.checkpointIntervalMs <= 0) return;
+    checkpointThread = startPeriodicThread(profile.checkpointIntervalMs, [this]() { checkpointWal(); });
+}
+
+bool DatabaseManager::checkpointWal()
+{
+    if (!connected) {
+        setLastError("数据库未连接");
+        return false;
+    }
+    qint64 walLimit;
+    {
+        QMutexLocker locker(&tuningMutex);
+        walLimit = tuning.walLimitBytes;
+    }
+    const qint64 walBytes = QFileInfo(dbPath + "-wal").size();
+    lastWalBytes.storeRelaxed(walBytes);
+    qint64 peak = peakWalBytes.loadRelaxed();
+    while (walBytes > peak && !peakWalBytes.testAndSetRelaxed(peak, walBytes, peak)) {
+    }
+
+    // PASSIVE 不等待读写，只写回没有读者引用的页；一直有读者或写入时 WAL 无法从头复用，
+    // 超限后改用 TRUNCATE：在 busy_timeout 内等待读者结束（期间写入也会等待），完成后把 WAL 截断为 0
+    const bool truncate = walLimit > 0 && walBytes > walLimit;
+    InstrumentedQuery query(connection(), statements());
+    if (!query.exec(truncate ? "PRAGMA wal_checkpoint(TRUNCATE)" : "PRAGMA wal_checkpoint(PASSIVE)") || !query.next()) {
+        setLastError("WAL 检查点失败: " + query.lastError().text());
+        return false;
+    }
+    const bool busy = query.value(0).toInt() != 0;
+    query.finish();
+    (truncate ? checkpointTruncate : checkpointPassive).fetchAndAddRelaxed(1);
+    if (busy) {
+        checkpointBusy.fetchAndAddRelaxed(1);
+    }
+    return !busy;
+}
+
+DatabaseManager::CheckpointStats DatabaseManager::checkpointStats() const
+{
+    CheckpointStats stats;
+    stats.passive = checkpointPassive.loadRelaxed();
+    stats.truncate = checkpointTruncate.loadRelaxed();
+    stats.busy = checkpointBusy.loadRelaxed();
+    stats.walBytes = lastWalBytes.loadRelaxed();
+    stats.peakWalBytes = peakWalBytes.loadRelaxed();
+    return stats;
+}
+
+void DatabaseManager::setWriteBehind(bool enabled, int maxRows, int maxDelayMs, int maxPending)
+{
+    // 析构时提交剩余数据并结束写线程
+    delete writeQueue.fetchAndStoreOrdered(nullptr);
+    if (!enabled) return;
+
+    WriteBehindQueue* queue = new WriteBehindQueue([this](const QVector<PendingWrite>& batch) {
+        return commitPendingWrites(batch);
+    }, maxRows, maxDelayMs, maxPending);
+    queue->start();
+    writeQueue.storeRelease(queue);
+}
+
+bool DatabaseManager::isWriteBehind() const
+{
+    return writeQueue.loadAcquire() != nullptr;
+}
+
+bool DatabaseManager::flushWrites(int timeoutMs)
+{
+    WriteBehindQueue* queue = writeQueue.loadAcquire();
+    return !queue || queue->flush(timeoutMs);
+}
+
+DatabaseManager::WriteBehindStats DatabaseManager::writeBehindStats() const
+{
+    WriteBehindStats stats;
+    if (WriteBehindQueue* queue = writeQueue.loadAcquire()) {
+        stats.committed = queue->committedCount();
+        stats.failed = queue->failedCount();
+        stats.dropped = queue->droppedCount();
+        stats.transactions = queue->transactionCount();
+        stats.pending = queue->pendingCount();
+    }
+    return stats;
+}
+
+int DatabaseManager::commitPendingWrites(const QVector<PendingWrite>& batch)
+{
+    QVector<MonitorSample> samples;
+    QVector<QVariantList> sampleColumns(5), alarmColumns(5);
+    QVector<const QVariantList*> alarms;
+    for (const PendingWrite& write : batch) {
+        switch (write.kind) {
+        case PendingWrite::MonitorData:
+            samples.append(write.sample);
+            sampleColumns[0] << write.sample.device_id;
+            sampleColumns[1] << write.sample.timestamp;
+            sampleColumns[2] << write.sample.temperature;
+            sampleColumns[3] << write.sample.humidity;
+            sampleColumns[4] << write.sample.light;
+            break;
+        case PendingWrite::AlarmRecord:
+            alarms.append(&write.values);
+            for (int i = 0; i < alarmColumns.size(); ++i) alarmColumns[i] << write.values.value(i);
+            break;
+        case PendingWrite::Barrier:
+            break;
+        }
+    }
+
+    // 监控数据、告警记录（含本批样本触发的告警）和汇总表在同一个事务中提交
+    QSqlDatabase conn = connection();
+    if (conn.transaction()) {
+        AlarmRuleEngine::Undo undo;
+        const QVector<AlarmHit> hits = alarmEngine->evaluate(samples, &undo);
+        if (insertRows(insertMonitorDataSql, sampleColumns) && updateRollups(samples)
+            && insertRows(insertAlarmRecordSql, alarmColumns) && insertAlarmHits(hits) && commitConnection(conn)) {
+            updateLatestSamples(samples);
+            announceAlarms(hits);
+            return 0;
+        }
+        conn.rollback();
+        alarmEngine->restore(undo);
+    }
+
+    // 整批失败时按同步路径分别写入，只丢弃真正写不进去的行
+    int failed = 0;
+    if (!samples.isEmpty()) {
+        QVector<int> failedRows;
+        if (!writeMonitorDataBatch(samples, &failedRows)) {
+            failed += failedRows.isEmpty() ? samples.size() : failedRows.size();
+        }
+    }
+    for (const QVariantList* values : alarms) {
+        QVector<QVariantList> row;
+        for (const QVariant& value : *values) row.append(QVariantList() << value);
+        if (!insertRows(insertAlarmRecordSql, row)) ++failed;
+    }
+    return failed;
+}
+
+bool DatabaseManager::writeLogs(const QVector<LogEntry>& entries)
+{
+    QVector<QVariantList> columns(6);
+    for (const LogEntry& entry : entries) {
+        columns[0] << entry.timestamp;
+        columns[1] << entry.log_type;
+        columns[2] << entry.log_level;
+        columns[3] << entry.content;
+        columns[4] << (entry.user_id == -1 ? QVariant(QVariant::Int) : QVariant(entry.user_id));
+        columns[5] << (entry.device_id == -1 ? QVariant(QVariant::Int) : QVariant(entry.device_id));
+    }
+    QSqlDatabase conn = connection();
+    if (!conn.transaction()) {
+        setLastError("写入系统日志失败: 无法开启事务 " + conn.lastError().text());
+        return false;
+    }
+    if (!insertRows(insertLogSql, columns) || !commitConnection(conn)) {
+        conn.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::insertRows(const QString& sql, const QVector<QVariantList>& columns)
+{
+    if (columns.isEmpty() || columns.first().isEmpty()) return true;
+    InstrumentedQuery query(connection(), statements());
+    if (!query.prepare(sql)) {
+        setLastError("写入失败: " + query.lastError().text());
+        return false;
+    }
+    for (const QVariantList& column : columns) {
+        query.addBindValue(column);
+    }
+    if (!query.execBatch()) {
+        setLastError("写入失败: " + query.lastError().text() + "\nSQL语句: " + sql);
+        return false;
     }
     return true;
 }
 
+QString DatabaseManager::lastError() const
+{
+    QMutexLocker locker(&errorMutex);
+    return lastErrorMsg;
+}
+
+void DatabaseManager::clearError()
+{
+    QMutexLocker locker(&errorMutex);
+    lastErrorMsg.clear();
+}
+
 void DatabaseManager::setLastError(const QString& error)
 {
-    lastErrorMsg = error;
+    {
+        QMutexLocker locker(&errorMutex);
+        lastErrorMsg = error;
+    }
     emit databaseError(error);
     qDebug() << "数据库错误:" << error;
 }
@@ -84,7 +731,14 @@ bool DatabaseManager::beginTransaction()
         setLastError("数据库未连接");
         return false;
     }
-    return db.transaction();
+    QSqlDatabase conn = connection();
+    if (!conn.transaction()) {
+        setLastError("无法开启事务: " + conn.lastError().text());
+        return false;
+    }
+    outerTransactions.setLocalData(true);
+    outerAlarms.setLocalData(OuterAlarms());
+    return true;
 }
 
 bool DatabaseManager::commitTransaction()
@@ -93,7 +747,14 @@ bool DatabaseManager::commitTransaction()
         setLastError("数据库未连接");
         return false;
     }
-    return db.commit();
+    if (!commitConnection(connection())) {
+        return false;
+    }
+    outerTransactions.setLocalData(false);
+    const OuterAlarms pending = outerAlarms.localData();
+    outerAlarms.setLocalData(OuterAlarms());
+    announceAlarms(pending.hits);
+    return true;
 }
 
 bool DatabaseManager::rollbackTransaction()
@@ -102,13 +763,18 @@ bool DatabaseManager::rollbackTransaction()
         setLastError("数据库未连接");
         return false;
     }
-    return db.rollback();
+    // 回滚失败时事务也已无法继续使用，不再视为外层事务
+    outerTransactions.setLocalData(false);
+    alarmEngine->restore(outerAlarms.localData().undo);
+    outerAlarms.setLocalData(OuterAlarms());
+    return connection().rollback();
 }
 
 bool DatabaseManager::createTables()
 {
     // 表结构与SQL脚本保持一致
-    return executeQuery("CREATE TABLE device_groups ("
+    // 时间戳统一存为 INTEGER（毫秒时间戳），便于索引范围查询
+    bool ok = executeQuery("CREATE TABLE device_groups ("
                        "group_id INTEGER PRIMARY KEY AUTOINCREMENT,"
                        "group_name TEXT NOT NULL,"
                        "group_type TEXT NOT NULL" // 类型/位置/自定义
@@ -133,15 +799,7 @@ bool DatabaseManager::createTables()
                        "group_id INTEGER,"
                        "FOREIGN KEY(group_id) REFERENCES device_groups(group_id)"
                        ")")
-        && executeQuery("CREATE TABLE monitor_data ("
-                       "data_id INTEGER PRIMARY KEY AUTOINCREMENT,"
-                       "device_id INTEGER NOT NULL,"
-                       "timestamp DATETIME NOT NULL,"
-                       "temperature REAL,"
-                       "humidity REAL,"
-                       "light REAL,"
-                       "FOREIGN KEY(device_id) REFERENCES devices(device_id)"
-                       ")")
+        && executeQuery(monitorDataTableSql("monitor_data"))
         && executeQuery("CREATE TABLE alarm_rules ("
                        "rule_id INTEGER PRIMARY KEY AUTOINCREMENT,"
                        "device_id INTEGER NOT NULL,"
@@ -150,311 +808,1920 @@ bool DatabaseManager::createTables()
                        "action TEXT NOT NULL,"
                        "FOREIGN KEY(device_id) REFERENCES devices(device_id)"
                        ")")
-        && executeQuery("CREATE TABLE alarm_records ("
-                       "alarm_id INTEGER PRIMARY KEY AUTOINCREMENT,"
-                       "device_id INTEGER NOT NULL,"
-                       "timestamp DATETIME NOT NULL,"
-                       "content TEXT NOT NULL,"
-                       "status TEXT NOT NULL,"
-                       "note TEXT,"
-                       "FOREIGN KEY(device_id) REFERENCES devices(device_id)"
-                       ")")
-        && executeQuery("CREATE TABLE system_logs ("
-                       "log_id INTEGER PRIMARY KEY AUTOINCREMENT,"
-                       "timestamp DATETIME NOT NULL,"
-                       "log_type TEXT NOT NULL,"
-                       "log_level TEXT NOT NULL,"
-                       "content TEXT NOT NULL,"
-                       "user_id INTEGER,"
-                       "device_id INTEGER,"
-                       "FOREIGN KEY(user_id) REFERENCES users(user_id),"
-                       "FOREIGN KEY(device_id) REFERENCES devices(device_id)"
-                       ")");
-    qDebug() << "所有表已重建";
+        && executeQuery(alarmRecordsTableSql("alarm_records"))
+        && executeQuery(systemLogsTableSql("system_logs"))
+        && executeQuery(rollupTableSql(rollupTables[0].table))
+        && executeQuery(rollupTableSql(rollupTables[1].table))
+        && executeQuery(rollupTableSql(rollupTables[2].table))
+        && executeQuery(monitorChunksTableSql("monitor_chunks"))
+        && executeQuery(tablePartitionsSql)
+        && executeQuery(retentionCutoffsSql)
+        && createIndexes()
+        && rebuildPartitionView("monitor_data")
+        && rebuildPartitionView("system_logs")
+        && setSchemaVersion(SCHEMA_VERSION);
+    if (ok) {
+        qDebug() << "所有表已重建";
+    }
+    return ok;
 }
 
-bool DatabaseManager::executeQuery(const QString& sql)
+QString DatabaseManager::monitorDataTableSql(const QString& table)
 {
-    if (!connected) {
-        setLastError("数据库未连接");
-        return false;
-    }
-    QSqlQuery query;
-    if (!query.exec(sql)) {
-        setLastError("SQL执行失败: " + query.lastError().text() + "\nSQL语句: " + sql);
-        return false;
-    }
-    return true;
+    return QString("CREATE TABLE %1 ("
+                   "data_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                   "device_id INTEGER NOT NULL,"
+                   "timestamp INTEGER NOT NULL,"   // 毫秒时间戳
+                   "temperature REAL,"
+                   "humidity REAL,"
+                   "light REAL,"
+                   "FOREIGN KEY(device_id) REFERENCES devices(device_id)"
+                   ")").arg(table);
 }
 
-// 用户管理
-bool DatabaseManager::addUser(const QString& username, const QString& password,
-                const QString& email, const QString& phone,
-                const QString& nickname, const QString& role)
+QString DatabaseManager::alarmRecordsTableSql(const QString& table)
 {
-    qDebug() << "addUser called:" << username << email << phone;
-    QSqlQuery query;
-    query.prepare("INSERT INTO users (username, password, email, phone, nickname, role) "
-                  "VALUES (?, ?, ?, ?, ?, ?)");
-    QByteArray hashedPassword = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex();
-    query.addBindValue(username);
-    query.addBindValue(hashedPassword);
-    query.addBindValue(email);
-    query.addBindValue(phone);
-    query.addBindValue(nickname);
-    query.addBindValue(role);
-    if (!query.exec()) {
-        setLastError("添加用户失败: " + query.lastError().text());
-        return false;
-    }
-    return true;
+    return QString("CREATE TABLE %1 ("
+                   "alarm_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                   "device_id INTEGER NOT NULL,"
+                   "timestamp INTEGER NOT NULL,"   // 毫秒时间戳
+                   "content TEXT NOT NULL,"
+                   "status TEXT NOT NULL,"
+                   "note TEXT,"
+                   "FOREIGN KEY(device_id) REFERENCES devices(device_id)"
+                   ")").arg(table);
 }
 
-bool DatabaseManager::updateUser(int user_id, const QString& email,
-                   const QString& phone, const QString& nickname)
+QString DatabaseManager::monitorChunksTableSql(const QString& table)
 {
-    qDebug() << "updateUser called:" << user_id << email << phone << nickname;
-    QSqlQuery query;
-    query.prepare("UPDATE users SET email=?, phone=?, nickname=? WHERE user_id=?");
-    query.addBindValue(email);
-    query.addBindValue(phone);
-    query.addBindValue(nickname);
-    query.addBindValue(user_id);
-    return query.exec();
+    // 每块带 min/max/count 头信息，data 为 ChunkCodec 编码的样本
+    return QString("CREATE TABLE %1 ("
+                   "device_id INTEGER NOT NULL,"
+                   "start_ts INTEGER NOT NULL,"    // 块内第一条的毫秒时间戳
+                   "end_ts INTEGER NOT NULL,"      // 块内最后一条的毫秒时间戳
+                   "count INTEGER NOT NULL,"
+                   "temperature_min REAL, temperature_max REAL,"
+                   "humidity_min REAL, humidity_max REAL,"
+                   "light_min REAL, light_max REAL,"
+                   "data BLOB NOT NULL,"
+                   "PRIMARY KEY(device_id, start_ts)"
+                   ")").arg(table);
 }
 
-bool DatabaseManager::updatePassword(int user_id, const QString& newPassword)
+QString DatabaseManager::systemLogsTableSql(const QString& table)
 {
-    QSqlQuery query;
-    query.prepare("UPDATE users SET password=? WHERE user_id=?");
-    QByteArray hashedPassword = QCryptographicHash::hash(newPassword.toUtf8(), QCryptographicHash::Sha256).toHex();
-    query.addBindValue(hashedPassword);
-    query.addBindValue(user_id);
-    return query.exec();
+    return QString("CREATE TABLE %1 ("
+                   "log_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                   "timestamp INTEGER NOT NULL,"   // 毫秒时间戳
+                   "log_type TEXT NOT NULL,"
+                   "log_level TEXT NOT NULL,"
+                   "content TEXT NOT NULL,"
+                   "user_id INTEGER,"
+                   "device_id INTEGER,"
+                   "FOREIGN KEY(user_id) REFERENCES users(user_id),"
+                   "FOREIGN KEY(device_id) REFERENCES devices(device_id)"
+                   ")").arg(table);
 }
 
-bool DatabaseManager::deleteUser(int user_id)
+bool DatabaseManager::createIndexes()
 {
-    qDebug() << "deleteUser called:" << user_id;
-    QSqlQuery query;
-    query.prepare("DELETE FROM users WHERE user_id=?");
-    query.addBindValue(user_id);
-    return query.exec();
+    // monitor_data 的索引带上数值列，历史查询可以只读索引（覆盖索引）
+    return executeQuery("CREATE INDEX IF NOT EXISTS idx_monitor_data_device_ts "
+                        "ON monitor_data(device_id, timestamp, temperature, humidity, light)")
+        && executeQuery("CREATE INDEX IF NOT EXISTS idx_alarm_records_device_ts "
+                        "ON alarm_records(device_id, timestamp)")
+        && executeQuery("CREATE INDEX IF NOT EXISTS idx_alarm_records_ts "
+                        "ON alarm_records(timestamp)")
+        && executeQuery("CREATE INDEX IF NOT EXISTS idx_system_logs_ts "
+                        "ON system_logs(timestamp)");
 }
 
-bool DatabaseManager::verifyUser(const QString& username, const QString& password, int& user_id, QString& role)
+int DatabaseManager::schemaVersion()
 {
-    QSqlQuery query;
-    query.prepare("SELECT user_id, password, role FROM users WHERE username = ?");
-    query.addBindValue(username);
-    if (!query.exec() || !query.next()) {
+    InstrumentedQuery query(connection(), statements());
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        return 0;
+    }
+    return query.value(0).toInt();
+}
+
+bool DatabaseManager::setSchemaVersion(int version)
+{
+    return executeQuery(QString("PRAGMA user_version = %1").arg(version));
+}
+
+bool DatabaseManager::migrateSchema()
+{
+    // 按版本号依次升级，每一步在独立事务中完成
+    typedef bool (DatabaseManager::*MigrationStep)();
+    static const MigrationStep steps[SCHEMA_VERSION] = {
+        &DatabaseManager::migrateToV1,
+        &DatabaseManager::migrateToV2,
+        &DatabaseManager::migrateToV3,
+        &DatabaseManager::migrateToV4,
+        &DatabaseManager::migrateToV5
+    };
+
+    int version = schemaVersion();
+    if (version > SCHEMA_VERSION) {
+        setLastError(QString("数据库版本(%1)高于程序支持的版本(%2)").arg(version).arg(SCHEMA_VERSION));
         return false;
     }
-    QByteArray hashedPassword = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex();
-    if (query.value(1).toString() == hashedPassword) {
-        user_id = query.value(0).toInt();
-        role = query.value(2).toString();
-        return true;
+    for (; version < SCHEMA_VERSION; ++version) {
+        if (!db.transaction()) {
+            setLastError("数据库升级失败: 无法开启事务 " + db.lastError().text());
+            return false;
+        }
+        if (!(this->*steps[version])() || !setSchemaVersion(version + 1) || !db.commit()) {
+            db.rollback();
+            setLastError(QString("数据库升级到版本%1失败").arg(version + 1));
+            return false;
+        }
+        qDebug() << "数据库已升级到版本" << version + 1;
+    }
+    return true;
+}
+
+// 版本1：DATETIME 文本时间戳转为毫秒时间戳，并建立 (device_id, timestamp) 索引
+bool DatabaseManager::migrateToV1()
+{
+    // Qt 写入的 QDateTime 为本地时间的 ISO 文本（不带时区），用 'utc' 修饰符换算；
+    // 带 Z 或 ±hh:mm 后缀的文本 julianday 已按 UTC 解析
+    const QString toEpochMs =
+        "CASE typeof(timestamp) "
+        "WHEN 'integer' THEN timestamp "
+        "WHEN 'real' THEN CAST(timestamp AS INTEGER) "
+        "ELSE COALESCE(CAST(ROUND((CASE WHEN timestamp LIKE '%Z' "
+        "OR timestamp GLOB '*[+-][0-9][0-9]:[0-9][0-9]' "
+        "THEN julianday(timestamp) ELSE julianday(timestamp, 'utc') END "
+        "- 2440587.5) * 86400000.0) AS INTEGER), 0) END";
+
+    return executeQuery(monitorDataTableSql("monitor_data_v1"))
+        && executeQuery("INSERT INTO monitor_data_v1 (data_id, device_id, timestamp, temperature, humidity, light) "
+                        "SELECT data_id, device_id, " + toEpochMs + ", temperature, humidity, light FROM monitor_data")
+        && executeQuery("DROP TABLE monitor_data")
+        && executeQuery("ALTER TABLE monitor_data_v1 RENAME TO monitor_data")
+        && executeQuery(alarmRecordsTableSql("alarm_records_v1"))
+        && executeQuery("INSERT INTO alarm_records_v1 (alarm_id, device_id, timestamp, content, status, note) "
+                        "SELECT alarm_id, device_id, " + toEpochMs + ", content, status, note FROM alarm_records")
+        && executeQuery("DROP TABLE alarm_records")
+        && executeQuery("ALTER TABLE alarm_records_v1 RENAME TO alarm_records")
+        && executeQuery(systemLogsTableSql("system_logs_v1"))
+        && executeQuery("INSERT INTO system_logs_v1 (log_id, timestamp, log_type, log_level, content, user_id, device_id) "
+                        "SELECT log_id, " + toEpochMs + ", log_type, log_level, content, user_id, device_id FROM system_logs")
+        && executeQuery("DROP TABLE system_logs")
+        && executeQuery("ALTER TABLE system_logs_v1 RENAME TO system_logs")
+        && createIndexes();
+}
+
+// 版本2：建立 1分钟/1小时/1天 汇总表，并用已有的原始数据回填
+bool DatabaseManager::migrateToV2()
+{
+    for (const RollupTable& rollup : rollupTables) {
+        if (!executeQuery(rollupTableSql(rollup.table))) {
+            return false;
+        }
+    }
+
+    // 按 (device_id, timestamp) 索引顺序分块回填，复用写入时的增量汇总逻辑
+    InstrumentedQuery query(connection(), statements());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT device_id, timestamp, temperature, humidity, light FROM monitor_data "
+                    "ORDER BY device_id, timestamp")) {
+        setLastError("回填汇总表失败: " + query.lastError().text());
+        return false;
+    }
+    QVector<MonitorSample> chunk;
+    chunk.reserve(10000);
+    while (query.next()) {
+        MonitorSample sample;
+        sample.device_id = query.value(0).toInt();
+        sample.timestamp = query.value(1).toLongLong();
+        sample.temperature = query.value(2).toDouble();
+        sample.humidity = query.value(3).toDouble();
+        sample.light = query.value(4).toDouble();
+        chunk.append(sample);
+        if (chunk.size() == 10000) {
+            if (!updateRollups(chunk)) return false;
+            chunk.clear();
+        }
+    }
+    return chunk.isEmpty() || updateRollups(chunk);
+}
+
+// 版本3：分块存储表，开启分块存储前为空
+bool DatabaseManager::migrateToV3()
+{
+    return executeQuery(monitorChunksTableSql("monitor_chunks"));
+}
+
+// 版本4：分区登记表和合并视图；现有的表作为当前分区，开启分区维护后按天封存
+bool DatabaseManager::migrateToV4()
+{
+    return executeQuery(tablePartitionsSql)
+        && rebuildPartitionView("monitor_data")
+        && rebuildPartitionView("system_logs");
+}
+
+// 版本5：保留策略执行位置表，升级前执行过的保留策略没有记录，视为全部保留
+bool DatabaseManager::migrateToV5()
+{
+    return executeQuery(retentionCutoffsSql);
+}
+
+QString DatabaseManager::rollupTableSql(const QString& table)
+{
+    // 每个桶保存各指标的 min/max/sum/first/last，avg = sum / count
+    QStringList columns;
+    columns << "device_id INTEGER NOT NULL"
+            << "bucket INTEGER NOT NULL"      // 桶起始毫秒时间戳（UTC 对齐）
+            << "count INTEGER NOT NULL"
+            << "first_ts INTEGER NOT NULL"
+            << "last_ts INTEGER NOT NULL";
+    for (const char* metric : rollupMetrics) {
+        columns << QString("%1_min REAL").arg(metric)
+                << QString("%1_max REAL").arg(metric)
+                << QString("%1_sum REAL").arg(metric)
+                << QString("%1_first REAL").arg(metric)
+                << QString("%1_last REAL").arg(metric);
+    }
+    columns << "PRIMARY KEY(device_id, bucket)";
+    return QString("CREATE TABLE %1 (%2) WITHOUT ROWID").arg(table, columns.join(","));
+}
+
+QString DatabaseManager::rollupUpsertSql(const QString& table)
+{
+    QStringList columns, placeholders, updates;
+    columns << "device_id" << "bucket" << "count" << "first_ts" << "last_ts";
+    updates << "count = count + excluded.count";
+    for (const char* metric : rollupMetrics) {
+        columns << QString("%1_min").arg(metric) << QString("%1_max").arg(metric)
+                << QString("%1_sum").arg(metric) << QString("%1_first").arg(metric)
+                << QString("%1_last").arg(metric);
+        updates << QString("%1_min = min(%1_min, excluded.%1_min)").arg(metric)
+                << QString("%1_max = max(%1_max, excluded.%1_max)").arg(metric)
+                << QString("%1_sum = %1_sum + excluded.%1_sum").arg(metric)
+                << QString("%1_first = CASE WHEN excluded.first_ts < first_ts THEN excluded.%1_first ELSE %1_first END").arg(metric)
+                << QString("%1_last = CASE WHEN excluded.last_ts >= last_ts THEN excluded.%1_last ELSE %1_last END").arg(metric);
+    }
+    // SET 右侧引用的都是更新前的值，first_ts/last_ts 放在最后只是为了可读性
+    updates << "first_ts = min(first_ts, excluded.first_ts)"
+            << "last_ts = max(last_ts, excluded.last_ts)";
+    for (int i = 0; i < columns.size(); ++i) {
+        placeholders << "?";
+    }
+    return QString("INSERT INTO %1 (%2) VALUES (%3) ON CONFLICT(device_id, bucket) DO UPDATE SET %4")
+        .arg(table, columns.join(", "), placeholders.join(", "), updates.join(", "));
+}
+
+bool DatabaseManager::updateRollups(const QVector<MonitorSample>& samples)
+{
+    if (samples.isEmpty()) return true;
+
+    struct Bucket {
+        qint64 count;
+        qint64 firstTs;
+        qint64 lastTs;
+        double min[3], max[3], sum[3], first[3], last[3];
+    };
+
+    for (const RollupTable& rollup : rollupTables) {
+        // 先在内存中按 (device_id, bucket) 预聚合，每个桶只 upsert 一次
+        QHash<QPair<int, qint64>, Bucket> buckets;
+        for (const MonitorSample& sample : samples) {
+            const double values[3] = { sample.temperature, sample.humidity, sample.light };
+            QPair<int, qint64> key(sample.device_id, sample.timestamp - sample.timestamp % rollup.bucketMs);
+            auto it = buckets.find(key);
+            if (it == buckets.end()) {
+                Bucket bucket;
+                bucket.count = 1;
+                bucket.firstTs = bucket.lastTs = sample.timestamp;
+                for (int m = 0; m < 3; ++m) {
+                    bucket.min[m] = bucket.max[m] = bucket.sum[m] = bucket.first[m] = bucket.last[m] = values[m];
+                }
+                buckets.insert(key, bucket);
+                continue;
+            }
+            Bucket& bucket = it.value();
+            bucket.count++;
+            for (int m = 0; m < 3; ++m) {
+                bucket.min[m] = qMin(bucket.min[m], values[m]);
+                bucket.max[m] = qMax(bucket.max[m], values[m]);
+                bucket.sum[m] += values[m];
+                if (sample.timestamp < bucket.firstTs) bucket.first[m] = values[m];
+                if (sample.timestamp >= bucket.lastTs) bucket.last[m] = values[m];
+            }
+            bucket.firstTs = qMin(bucket.firstTs, sample.timestamp);
+            bucket.lastTs = qMax(bucket.lastTs, sample.timestamp);
+        }
+
+        // 列顺序与 rollupUpsertSql 一致
+        QVector<QVariantList> columns(5 + 5 * 3);
+        for (auto it = buckets.constBegin(); it != buckets.constEnd(); ++it) {
+            const Bucket& bucket = it.value();
+            columns[0] << it.key().first;
+            columns[1] << it.key().second;
+            columns[2] << bucket.count;
+            columns[3] << bucket.firstTs;
+            columns[4] << bucket.lastTs;
+            for (int m = 0; m < 3; ++m) {
+                columns[5 + m * 5] << bucket.min[m];
+                columns[6 + m * 5] << bucket.max[m];
+                columns[7 + m * 5] << bucket.sum[m];
+                columns[8 + m * 5] << bucket.first[m];
+                columns[9 + m * 5] << bucket.last[m];
+            }
+        }
+
+        InstrumentedQuery query(connection(), statements());
+        query.prepare(rollupUpsertSql(rollup.table));
+        for (const QVariantList& column : columns) {
+            query.addBindValue(column);
+        }
+        if (!query.execBatch()) {
+            setLastError(QString("更新汇总表 %1 失败: %2").arg(rollup.table, query.lastError().text()));
+            return false;
+        }
+    }
+    return true;
+}
+
+DatabaseManager::Resolution DatabaseManager::pickResolution(const QDateTime& startTime, const QDateTime& endTime, int maxPoints)
+{
+    if (maxPoints <= 0) return RawResolution;
+    qint64 span = startTime.msecsTo(endTime);
+    // 从最粗的粒度开始，选第一个桶数仍不少于 maxPoints 的汇总表
+    for (int i = rollupTableCount - 1; i >= 0; --i) {
+        if (span / rollupTables[i].bucketMs >= maxPoints) {
+            return static_cast<Resolution>(i + 1);
+        }
+    }
+    return RawResolution;
+}
+
+QStringList DatabaseManager::explainQueryPlan(const QString& sql, const QVariantList& bindValues)
+{
+    QStringList plan;
+    QSqlQuery query(connection());
+    query.prepare("EXPLAIN QUERY PLAN " + sql);
+    for (const QVariant& value : bindValues) {
+        query.addBindValue(value);
+    }
+    if (!query.exec()) {
+        setLastError("获取查询计划失败: " + query.lastError().text());
+        return plan;
+    }
+    // 结果列: id, parent, notused, detail
+    while (query.next()) {
+        plan << query.value(3).toString();
+    }
+    return plan;
+}
+
+QVector<QueryStatsEntry> DatabaseManager::queryStatistics() const
+{
+    return QueryStats::global().snapshot();
+}
+
+void DatabaseManager::resetQueryStatistics()
+{
+    QueryStats::global().reset();
+}
+
+void DatabaseManager::setSlowQueryThreshold(int ms)
+{
+    QueryStats::global().setSlowQueryThreshold(ms);
+}
+
+int DatabaseManager::slowQueryThreshold() const
+{
+    return QueryStats::global().slowQueryThreshold();
+}
+
+void DatabaseManager::logSlowQuery(const QString& sql, const QVariantList& bindValues, qint64 micros)
+{
+    // 日志写入本身不再记录，避免日志线程繁忙时循环产生慢查询日志
+    if (sql == QLatin1String(insertLogSql)) return;
+    const QString statement = sql.simplified();
+    const QString verb = statement.section(' ', 0, 0).toUpper();
+    QStringList plan;
+    if (verb == "SELECT" || verb == "WITH" || verb == "INSERT" || verb == "UPDATE" || verb == "DELETE") {
+        // 与 explainQueryPlan 相同，但失败时不设置 lastError；批量执行绑定的是整列数据，此时不带参数
+        QSqlQuery query(connection());
+        query.prepare("EXPLAIN QUERY PLAN " + sql);
+        for (const QVariant& value : bindValues) {
+            query.addBindValue(value.type() == QVariant::List ? QVariant() : value);
+        }
+        if (query.exec()) {
+            while (query.next()) {
+                plan << query.value(3).toString();
+            }
+        }
+    }
+    qWarning().noquote() << QString("慢查询 %1 ms:").arg(micros / 1000.0, 0, 'f', 1) << statement;
+    addLog("慢查询", "WARN", QString("耗时 %1 ms：%2\n查询计划：%3")
+           .arg(micros / 1000.0, 0, 'f', 1)
+           .arg(statement, plan.isEmpty() ? QString("无") : plan.join("; ")));
+}
+
+bool DatabaseManager::commitConnection(QSqlDatabase conn)
+{
+    if (!conn.commit()) return false;
+    noteLocalCommit();
+    return true;
+}
+
+void DatabaseManager::noteLocalCommit()
+{
+    // 主连接自己的提交不改变它看到的 data_version，不计数
+    if (QThread::currentThread() != thread()) {
+        localCommits.fetchAndAddRelease(1);
+    }
+}
+
+bool DatabaseManager::executeQuery(const QString& sql)
+{
+    if (!connected) {
+        setLastError("数据库未连接");
+        return false;
+    }
+    InstrumentedQuery query(connection(), statements());
+    if (!query.exec(sql)) {
+        setLastError("SQL执行失败: " + query.lastError().text() + "\nSQL语句: " + sql);
+        return false;
+    }
+    return true;
+}
+
+// 用户管理
+bool DatabaseManager::addUser(const QString& username, const QString& password,
+                const QString& email, const QString& phone,
+                const QString& nickname, const QString& role)
+{
+    qDebug() << "addUser called:" << username << email << phone;
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("INSERT INTO users (username, password, email, phone, nickname, role) "
+                  "VALUES (?, ?, ?, ?, ?, ?)");
+    QByteArray hashedPassword = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex();
+    query.addBindValue(username);
+    query.addBindValue(hashedPassword);
+    query.addBindValue(email);
+    query.addBindValue(phone);
+    query.addBindValue(nickname);
+    query.addBindValue(role);
+    if (!query.exec()) {
+        setLastError("添加用户失败: " + query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::updateUser(int user_id, const QString& email,
+                   const QString& phone, const QString& nickname)
+{
+    qDebug() << "updateUser called:" << user_id << email << phone << nickname;
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("UPDATE users SET email=?, phone=?, nickname=? WHERE user_id=?");
+    query.addBindValue(email);
+    query.addBindValue(phone);
+    query.addBindValue(nickname);
+    query.addBindValue(user_id);
+    return query.exec();
+}
+
+bool DatabaseManager::updatePassword(int user_id, const QString& newPassword)
+{
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("UPDATE users SET password=? WHERE user_id=?");
+    QByteArray hashedPassword = QCryptographicHash::hash(newPassword.toUtf8(), QCryptographicHash::Sha256).toHex();
+    query.addBindValue(hashedPassword);
+    query.addBindValue(user_id);
+    return query.exec();
+}
+
+bool DatabaseManager::deleteUser(int user_id)
+{
+    qDebug() << "deleteUser called:" << user_id;
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("DELETE FROM users WHERE user_id=?");
+    query.addBindValue(user_id);
+    return query.exec();
+}
+
+bool DatabaseManager::verifyUser(const QString& username, const QString& password, int& user_id, QString& role)
+{
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("SELECT user_id, password, role FROM users WHERE username = ?");
+    query.addBindValue(username);
+    if (!query.exec() || !query.next()) {
+        return false;
+    }
+    QByteArray hashedPassword = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex();
+    if (query.value(1).toString() == hashedPassword) {
+        user_id = query.value(0).toInt();
+        role = query.value(2).toString();
+        return true;
+    }
+    return false;
+}
+
+bool DatabaseManager::getUserInfo(int user_id, QString& username, QString& email,
+                    QString& phone, QString& nickname, QString& role)
+{
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("SELECT username, email, phone, nickname, role FROM users WHERE user_id = ?");
+    query.addBindValue(user_id);
+    if (!query.exec() || !query.next()) {
+        return false;
+    }
+    username = query.value(0).toString();
+    email = query.value(1).toString();
+    phone = query.value(2).toString();
+    nickname = query.value(3).toString();
+    role = query.value(4).toString();
+    return true;
+}
+
+bool DatabaseManager::getUserIdByUsername(const QString& username, int& user_id)
+{
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("SELECT user_id FROM users WHERE username = ?");
+    query.addBindValue(username);
+    if (!query.exec() || !query.next()) {
+        return false;
+    }
+    user_id = query.value(0).toInt();
+    return true;
+}
+
+// 设备管理
+bool DatabaseManager::addDevice(const QString& name, const QString& type, const QString& location,
+                  const QString& manufacturer, const QString& model, const QString& installation_date)
+{
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("INSERT INTO devices (name, type, location, manufacturer, model, installation_date) "
+                  "VALUES (?, ?, ?, ?, ?, ?)");
+    query.addBindValue(name);
+    query.addBindValue(type);
+    query.addBindValue(location);
+    query.addBindValue(manufacturer);
+    query.addBindValue(model);
+    query.addBindValue(installation_date);
+    if (!query.exec()) {
+        return false;
+    }
+    invalidateDeviceCache();
+    return true;
+}
+
+bool DatabaseManager::updateDevice(int device_id, const QString& name, const QString& type, const QString& location,
+                     const QString& manufacturer, const QString& model, const QString& installation_date)
+{
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("UPDATE devices SET name=?, type=?, location=?, manufacturer=?, model=?, installation_date=? WHERE device_id=?");
+    query.addBindValue(name);
+    query.addBindValue(type);
+    query.addBindValue(location);
+    query.addBindValue(manufacturer);
+    query.addBindValue(model);
+    query.addBindValue(installation_date);
+    query.addBindValue(device_id);
+    if (!query.exec()) {
+        return false;
+    }
+    invalidateDeviceCache();
+    return true;
+}
+
+bool DatabaseManager::deleteDevice(int device_id)
+{
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("DELETE FROM devices WHERE device_id=?");
+    query.addBindValue(device_id);
+    if (!query.exec()) {
+        return false;
+    }
+    invalidateDeviceCache();
+    QWriteLocker locker(&latestLock);
+    latestSamples.remove(device_id);
+    return true;
+}
+
+QVariantList DatabaseManager::getDevices()
+{
+    QVariantList devices;
+    if (!loadDeviceCache()) {
+        return devices;
+    }
+    QReadLocker locker(&deviceLock);
+    for (auto it = deviceCache.constBegin(); it != deviceCache.constEnd(); ++it) {
+        devices.append(it.value());
+    }
+    return devices;
+}
+
+bool DatabaseManager::getDeviceIdByName(const QString& name, int& device_id)
+{
+    if (!loadDeviceCache()) {
+        return false;
+    }
+    QReadLocker locker(&deviceLock);
+    for (auto it = deviceCache.constBegin(); it != deviceCache.constEnd(); ++it) {
+        if (it.value().value("name").toString() == name) {
+            device_id = it.key();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DatabaseManager::getDeviceById(int device_id, QVariantMap& device)
+{
+    if (!loadDeviceCache()) {
+        return false;
+    }
+    QReadLocker locker(&deviceLock);
+    auto it = deviceCache.constFind(device_id);
+    if (it == deviceCache.constEnd()) {
+        return false;
+    }
+    device = it.value();
+    return true;
+}
+
+QString DatabaseManager::deviceName(int device_id)
+{
+    QVariantMap device;
+    return getDeviceById(device_id, device) ? device.value("name").toString() : QString("未知设备");
+}
+
+bool DatabaseManager::loadDeviceCache()
+{
+    {
+        QReadLocker locker(&deviceLock);
+        if (deviceCacheValid) return true;
+    }
+    QWriteLocker locker(&deviceLock);
+    if (deviceCacheValid) return true;
+
+    InstrumentedQuery query(connection(), statements());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT device_id, name, type, location, manufacturer, model, installation_date FROM devices")) {
+        setLastError("加载设备信息失败: " + query.lastError().text());
+        return false;
+    }
+    deviceCache.clear();
+    while (query.next()) {
+        QVariantMap device;
+        device["device_id"] = query.value(0).toInt();
+        device["name"] = query.value(1).toString();
+        device["type"] = query.value(2).toString();
+        device["location"] = query.value(3).toString();
+        device["manufacturer"] = query.value(4).toString();
+        device["model"] = query.value(5).toString();
+        device["installation_date"] = query.value(6).toString();
+        deviceCache.insert(device["device_id"].toInt(), device);
+    }
+    deviceCacheValid = true;
+    return true;
+}
+
+void DatabaseManager::invalidateDeviceCache()
+{
+    QWriteLocker locker(&deviceLock);
+    deviceCacheValid = false;
+    deviceCache.clear();
+}
+
+// 监控数据
+bool DatabaseManager::addMonitorData(int device_id, const QDateTime& timestamp,
+                       double temperature, double humidity, double light)
+{
+    MonitorSample sample;
+    sample.device_id = device_id;
+    sample.timestamp = timestamp.toMSecsSinceEpoch();
+    sample.temperature = temperature;
+    sample.humidity = humidity;
+    sample.light = light;
+
+    if (WriteBehindQueue* queue = writeQueue.loadAcquire()) {
+        PendingWrite write;
+        write.kind = PendingWrite::MonitorData;
+        write.sample = sample;
+        return queue->enqueue(write);
+    }
+
+    QSqlDatabase conn = connection();
+    // 原始数据和汇总表在同一事务中更新；调用方已用 beginTransaction() 开启事务时直接并入
+    const bool ownTransaction = !outerTransactions.localData();
+    if (ownTransaction && !conn.transaction()) {
+        setLastError("写入监控数据失败: 无法开启事务 " + conn.lastError().text());
+        return false;
+    }
+    InstrumentedQuery query(conn, statements());
+    query.prepare(insertMonitorDataSql);
+    query.addBindValue(device_id);
+    query.addBindValue(sample.timestamp);
+    query.addBindValue(temperature);
+    query.addBindValue(humidity);
+    query.addBindValue(light);
+
+    const QVector<MonitorSample> samples(1, sample);
+    if (!query.exec() || !updateRollups(samples)) {
+        if (ownTransaction) conn.rollback();
+        return false;
+    }
+    AlarmRuleEngine::Undo undo;
+    const QVector<AlarmHit> hits = alarmEngine->evaluate(samples, &undo);
+    if (!insertAlarmHits(hits) || (ownTransaction && !commitConnection(conn))) {
+        if (ownTransaction) conn.rollback();
+        alarmEngine->restore(undo);
+        return false;
+    }
+    updateLatestSamples(samples);
+    if (ownTransaction) {
+        announceAlarms(hits);
+        return true;
+    }
+    // 外层事务提交后才通知；规则状态的撤销记录并入外层事务，同一规则保留最早的状态
+    OuterAlarms& pending = outerAlarms.localData();
+    pending.hits += hits;
+    for (auto it = undo.active.constBegin(); it != undo.active.constEnd(); ++it) {
+        if (!pending.undo.active.contains(it.key())) pending.undo.active.insert(it.key(), it.value());
+    }
+    pending.undo.hits += undo.hits;
+    return true;
+}
+
+bool DatabaseManager::addMonitorDataBatch(const QVector<MonitorSample>& samples, QVector<int>* failedRows)
+{
+    WriteBehindQueue* queue = writeQueue.loadAcquire();
+    if (!queue) {
+        return writeMonitorDataBatch(samples, failedRows);
+    }
+    // 延迟写入：无效行和因积压被丢弃的行记入 failedRows，其余逐条入队
+    if (failedRows) failedRows->clear();
+    bool ok = true;
+    PendingWrite write;
+    write.kind = PendingWrite::MonitorData;
+    for (int i = 0; i < samples.size(); ++i) {
+        write.sample = samples[i];
+        if (write.sample.device_id <= 0 || write.sample.timestamp <= 0 || !queue->enqueue(write)) {
+            ok = false;
+            if (failedRows) failedRows->append(i);
+        }
+    }
+    return ok;
+}
+
+bool DatabaseManager::writeMonitorDataBatch(const QVector<MonitorSample>& samples, QVector<int>* failedRows)
+{
+    QSqlDatabase conn = connection();
+    if (failedRows) failedRows->clear();
+    if (!connected) {
+        setLastError("数据库未连接");
+        return false;
+    }
+    if (samples.isEmpty()) return true;
+
+    // 先过滤明显无效的行，避免整批失败
+    bool hasInvalid = false;
+    QVector<int> rowIndex;
+    QVector<MonitorSample> validSamples;
+    QVariantList deviceIds, timestamps, temperatures, humidities, lights;
+    rowIndex.reserve(samples.size());
+    for (int i = 0; i < samples.size(); ++i) {
+        const MonitorSample& s = samples[i];
+        if (s.device_id <= 0 || s.timestamp <= 0) {
+            hasInvalid = true;
+            if (failedRows) failedRows->append(i);
+            continue;
+        }
+        rowIndex.append(i);
+        validSamples.append(s);
+        deviceIds << s.device_id;
+        timestamps << s.timestamp;
+        temperatures << s.temperature;
+        humidities << s.humidity;
+        lights << s.light;
+    }
+    if (rowIndex.isEmpty()) {
+        setLastError("批量写入监控数据失败: 没有有效数据");
+        return false;
+    }
+
+    const QString sql = insertMonitorDataSql;
+
+    if (!conn.transaction()) {
+        setLastError("批量写入监控数据失败: 无法开启事务 " + conn.lastError().text());
+        return false;
+    }
+    InstrumentedQuery query(conn, statements());
+    if (!query.prepare(sql)) {
+        conn.rollback();
+        setLastError("批量写入监控数据失败: " + query.lastError().text());
+        return false;
+    }
+    query.addBindValue(deviceIds);
+    query.addBindValue(timestamps);
+    query.addBindValue(temperatures);
+    query.addBindValue(humidities);
+    query.addBindValue(lights);
+    if (query.execBatch() && updateRollups(validSamples)) {
+        AlarmRuleEngine::Undo undo;
+        const QVector<AlarmHit> hits = alarmEngine->evaluate(validSamples, &undo);
+        if (insertAlarmHits(hits) && commitConnection(conn)) {
+            updateLatestSamples(validSamples);
+            announceAlarms(hits);
+            return !hasInvalid;
+        }
+        alarmEngine->restore(undo);
+    }
+    conn.rollback();
+
+    // 整批失败时逐行重试，定位失败的行；仍复用同一条预编译语句和同一个事务
+    if (!conn.transaction()) {
+        setLastError("批量写入监控数据失败: 无法开启事务 " + conn.lastError().text());
+        return false;
+    }
+    query.prepare(sql);
+    QVector<int> failed;
+    QVector<MonitorSample> written;
+    for (int k = 0; k < rowIndex.size(); ++k) {
+        query.addBindValue(deviceIds[k]);
+        query.addBindValue(timestamps[k]);
+        query.addBindValue(temperatures[k]);
+        query.addBindValue(humidities[k]);
+        query.addBindValue(lights[k]);
+        if (!query.exec()) {
+            failed.append(rowIndex[k]);
+        } else {
+            written.append(validSamples[k]);
+        }
+    }
+    AlarmRuleEngine::Undo undo;
+    QVector<AlarmHit> hits;
+    bool committed = updateRollups(written);
+    if (committed) {
+        hits = alarmEngine->evaluate(written, &undo);
+        committed = insertAlarmHits(hits) && commitConnection(conn);
+    }
+    if (!committed) {
+        conn.rollback();
+        alarmEngine->restore(undo);
+        setLastError("批量写入监控数据失败: 提交事务失败 " + conn.lastError().text());
+        if (failedRows) {
+            failedRows->clear();
+            for (int i = 0; i < samples.size(); ++i) failedRows->append(i);
+        }
+        return false;
+    }
+    updateLatestSamples(written);
+    announceAlarms(hits);
+    if (!failed.isEmpty()) {
+        setLastError(QString("批量写入监控数据: %1 行写入失败").arg(failed.size()));
+        if (failedRows) {
+            *failedRows += failed;
+            std::sort(failedRows->begin(), failedRows->end());
+        }
+    }
+    return failed.isEmpty() && !hasInvalid;
+}
+
+void DatabaseManager::setChunkStorage(bool enabled, int compactIntervalMs)
+{
+    stopPeriodicThread(compactThread);
+    if (!enabled) return;
+
+    // 每个时间窗一个短事务，不长时间阻塞写入
+    compactThread = startPeriodicThread(compactIntervalMs, [this]() {
+        // 上一个小时仍可能收到迟到的数据，只压缩更早的时间窗
+        const int moved = compactMonitorData(QDateTime::currentMSecsSinceEpoch() - chunkSpanMs);
+        if (moved > 0) {
+            qDebug() << "已将" << moved << "条监控数据压缩为分块存储";
+        }
+    });
+}
+
+void DatabaseManager::setRetentionPolicy(const QString& table, int keepDays)
+{
+    QMutexLocker locker(&retentionMutex);
+    retentionDays.insert(table, keepDays);
+}
+
+int DatabaseManager::retentionPolicy(const QString& table) const
+{
+    QMutexLocker locker(&retentionMutex);
+    return retentionDays.value(table, 0);
+}
+
+void DatabaseManager::setPartitionMaintenance(bool enabled, int intervalMs)
+{
+    stopPeriodicThread(partitionThread);
+    if (!enabled) return;
+    partitionThread = startPeriodicThread(intervalMs, [this]() { maintainPartitions(); });
+}
+
+bool DatabaseManager::maintainPartitions()
+{
+    if (!connected) {
+        setLastError("数据库未连接");
+        return false;
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool ok = true;
+    for (const char* base : partitionedTables) {
+        ok = sealPartition(base, now - now % partitionSpanMs) && ok;
+    }
+    return applyRetention() && ok;
+}
+
+QStringList DatabaseManager::partitionTables(const QString& base, qint64 startMs, qint64 endMs)
+{
+    QStringList tables;
+    InstrumentedQuery query(connection(), statements());
+    query.setForwardOnly(true);
+    query.prepare("SELECT name FROM table_partitions WHERE base_table=? AND name<>base_table "
+                  "AND min_ts<=? AND max_ts>=? ORDER BY min_ts");
+    query.addBindValue(base);
+    query.addBindValue(endMs);
+    query.addBindValue(startMs);
+    if (query.exec()) {
+        while (query.next()) {
+            tables << query.value(0).toString();
+        }
+    }
+    tables << base;
+    return tables;
+}
+
+bool DatabaseManager::isInternalTable(const QString& table)
+{
+    if (table == "monitor_chunks" || table == "table_partitions" || table == "retention_cutoffs") return true;
+    for (const RollupTable& rollup : rollupTables) {
+        if (table == rollup.table) return true;
+    }
+    static const QRegularExpression partitionName("^(.+)_p\\d{8}$");
+    const QRegularExpressionMatch match = partitionName.match(table);
+    if (!match.hasMatch()) return false;
+    for (const char* base : partitionedTables) {
+        if (match.captured(1) == base) return true;
+    }
+    return false;
+}
+
+bool DatabaseManager::rebuildPartitionView(const QString& base)
+{
+    QStringList selects;
+    for (const QString& table : partitionTables(base, minTimestamp, maxTimestamp)) {
+        selects << "SELECT * FROM " + table;
+    }
+    return executeQuery(QString("DROP VIEW IF EXISTS %1_all").arg(base))
+        && executeQuery(QString("CREATE VIEW %1_all AS %2").arg(base, selects.join(" UNION ALL ")));
+}
+
+bool DatabaseManager::sealPartition(const QString& base, qint64 periodStart)
+{
+    QSqlDatabase conn = connection();
+    InstrumentedQuery query(conn, statements());
+    query.prepare("SELECT min_ts FROM table_partitions WHERE name=?");
+    query.addBindValue(base);
+    if (!query.exec()) {
+        setLastError("分区维护失败: " + query.lastError().text());
+        return false;
+    }
+    if (!query.next()) {
+        // 首次开启：现有的表作为当前分区，下一个自然日开始时封存
+        query.prepare("INSERT INTO table_partitions (name, base_table, min_ts, max_ts) VALUES (?, ?, ?, NULL)");
+        query.addBindValue(base);
+        query.addBindValue(base);
+        query.addBindValue(periodStart);
+        return query.exec();
+    }
+    const qint64 currentStart = query.value(0).toLongLong();
+    query.finish();
+    if (currentStart >= periodStart) return true;
+
+    const QString partition = QString("%1_p%2").arg(base,
+        QDateTime::fromMSecsSinceEpoch(currentStart, Qt::UTC).toString("yyyyMMdd"));
+    const QString suffix = QDateTime::fromMSecsSinceEpoch(periodStart, Qt::UTC).toString("yyyyMMdd");
+    const bool monitorData = (base == "monitor_data");
+
+    // 改名 + 建新表都只改 schema，事务很短；分区先按名义时间范围登记，随后再校正
+    if (!conn.transaction()) {
+        setLastError("分区维护失败: 无法开启事务 " + conn.lastError().text());
+        return false;
+    }
+    query.prepare("INSERT INTO table_partitions (name, base_table, min_ts, max_ts) VALUES (?, ?, ?, ?)");
+    query.addBindValue(partition);
+    query.addBindValue(base);
+    query.addBindValue(currentStart);
+    query.addBindValue(periodStart - 1);
+    bool ok = executeQuery(QString("ALTER TABLE %1 RENAME TO %2").arg(base, partition))
+        && executeQuery(monitorData ? monitorDataTableSql(base) : systemLogsTableSql(base))
+        // 自增主键接着旧表继续，跨分区的 data_id/log_id 保持唯一且递增
+        && executeQuery(QString("INSERT INTO sqlite_sequence (name, seq) SELECT '%1', seq FROM sqlite_sequence "
+                                "WHERE name='%2'").arg(base, partition))
+        && executeQuery(monitorData
+                        ? QString("CREATE INDEX idx_monitor_data_device_ts_%1 "
+                                  "ON monitor_data(device_id, timestamp, temperature, humidity, light)").arg(suffix)
+                        : QString("CREATE INDEX idx_system_logs_ts_%1 ON system_logs(timestamp)").arg(suffix))
+        && query.exec()
+        && executeQuery(QString("UPDATE table_partitions SET min_ts=%1 WHERE name='%2'").arg(periodStart).arg(base))
+        && rebuildPartitionView(base);
+    if (!ok || !commitConnection(conn)) {
+        conn.rollback();
+        setLastError(QString("封存分区 %1 失败: %2").arg(partition, query.lastError().isValid() ? query.lastError().text() : lastError()));
+        return false;
+    }
+
+    // 已封存的分区不再写入，在事务外读出实际时间范围（可能含迟到或超前的数据）
+    query.prepare(QString("SELECT MIN(timestamp), MAX(timestamp) FROM %1").arg(partition));
+    if (!query.exec() || !query.next()) {
+        setLastError(QString("统计分区 %1 范围失败: %2").arg(partition, query.lastError().text()));
+        return false;
+    }
+    const QVariant minTs = query.value(0);
+    const QVariant maxTs = query.value(1);
+    query.finish();
+    if (minTs.isNull()) {
+        // 空分区直接删除
+        return conn.transaction()
+            && executeQuery(QString("DROP TABLE %1").arg(partition))
+            && executeQuery(QString("DELETE FROM table_partitions WHERE name='%1'").arg(partition))
+            && rebuildPartitionView(base)
+            && commitConnection(conn);
+    }
+    query.prepare("UPDATE table_partitions SET min_ts=?, max_ts=? WHERE name=?");
+    query.addBindValue(minTs);
+    query.addBindValue(maxTs);
+    query.addBindValue(partition);
+    if (!query.exec()) {
+        setLastError(QString("更新分区 %1 范围失败: %2").arg(partition, query.lastError().text()));
+        return false;
+    }
+    qDebug() << "已封存分区" << partition;
+    return true;
+}
+
+bool DatabaseManager::dropExpiredPartitions(const QString& base, qint64 cutoff)
+{
+    QStringList expired;
+    QSqlDatabase conn = connection();
+    InstrumentedQuery query(conn, statements());
+    query.prepare("SELECT name FROM table_partitions WHERE base_table=? AND name<>base_table AND max_ts<?");
+    query.addBindValue(base);
+    query.addBindValue(cutoff);
+    if (!query.exec()) {
+        setLastError("执行保留策略失败: " + query.lastError().text());
+        return false;
+    }
+    while (query.next()) {
+        expired << query.value(0).toString();
+    }
+    query.finish();
+    for (const QString& partition : expired) {
+        // 整表 DROP，不产生逐行删除的开销和碎片
+        if (!conn.transaction()) return false;
+        if (!executeQuery(QString("DROP TABLE %1").arg(partition))
+            || !executeQuery(QString("DELETE FROM table_partitions WHERE name='%1'").arg(partition))
+            || !rebuildPartitionView(base)
+            || !commitConnection(conn)) {
+            conn.rollback();
+            return false;
+        }
+        qDebug() << "已删除过期分区" << partition;
+    }
+    return true;
+}
+
+bool DatabaseManager::applyRetention()
+{
+    QHash<QString, int> policies;
+    {
+        QMutexLocker locker(&retentionMutex);
+        policies = retentionDays;
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 dayMs = 24 * 60 * 60 * 1000LL;
+    bool ok = true;
+    for (const char* base : partitionedTables) {
+        const int days = policies.value(base, 0);
+        if (days > 0) {
+            const qint64 cutoff = now - days * dayMs;
+            ok = recordRetention(base, cutoff) && dropExpiredPartitions(base, cutoff) && ok;
+        }
+    }
+
+    // 分块存储和汇总表按设备分别删除，每次只是主键上的一段连续范围
+    struct KeyedTable {
+        const char* table;
+        const char* policy;
+        const char* sql;
+        qint64 lengthMs;   // 块/桶的时间长度，整块过期才删除
+    };
+    const KeyedTable keyedTables[] = {
+        { "monitor_chunks", "monitor_data", "DELETE FROM %1 WHERE device_id=? AND end_ts<?", 0 },
+        { rollupTables[0].table, rollupTables[0].table, "DELETE FROM %1 WHERE device_id=? AND bucket<=?", rollupTables[0].bucketMs },
+        { rollupTables[1].table, rollupTables[1].table, "DELETE FROM %1 WHERE device_id=? AND bucket<=?", rollupTables[1].bucketMs },
+        { rollupTables[2].table, rollupTables[2].table, "DELETE FROM %1 WHERE device_id=? AND bucket<=?", rollupTables[2].bucketMs }
+    };
+    const QVariantList devices = getDevices();
+    for (const KeyedTable& keyed : keyedTables) {
+        const int days = policies.value(keyed.policy, 0);
+        if (days <= 0) continue;
+        const qint64 cutoff = now - days * dayMs - keyed.lengthMs;
+        // 汇总表删除到 cutoff 所在的桶为止，之后的桶完整保留
+        if (!recordRetention(keyed.policy, keyed.lengthMs > 0 ? cutoff - cutoff % keyed.lengthMs + keyed.lengthMs : cutoff)) {
+            ok = false;
+            continue;
+        }
+        InstrumentedQuery query(connection(), statements());
+        query.prepare(QString(keyed.sql).arg(keyed.table));
+        for (const QVariant& device : devices) {
+            query.addBindValue(device.toMap().value("device_id").toInt());
+            query.addBindValue(cutoff);
+            if (!query.exec()) {
+                setLastError(QString("清理 %1 失败: %2").arg(keyed.table, query.lastError().text()));
+                ok = false;
+                break;
+            }
+            if (query.numRowsAffected() > 0) {
+                noteLocalCommit();   // 自动提交
+            }
+        }
     }
-    return false;
+    return ok;
 }
 
-bool DatabaseManager::getUserInfo(int user_id, QString& username, QString& email,
-                    QString& phone, QString& nickname, QString& role)
+bool DatabaseManager::recordRetention(const QString& table, qint64 retainedFrom)
 {
-    QSqlQuery query;
-    query.prepare("SELECT username, email, phone, nickname, role FROM users WHERE user_id = ?");
-    query.addBindValue(user_id);
-    if (!query.exec() || !query.next()) {
+    // 在删除之前记录：删除中途读取的一方最多多用一段汇总表，不会把已删除的时段当作完整的原始数据
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("INSERT INTO retention_cutoffs (table_name, retained_from) VALUES (?, ?) "
+                  "ON CONFLICT(table_name) DO UPDATE SET retained_from=MAX(retained_from, excluded.retained_from)");
+    query.addBindValue(table);
+    query.addBindValue(retainedFrom);
+    if (!query.exec()) {
+        setLastError(QString("记录 %1 的保留位置失败: %2").arg(table, query.lastError().text()));
         return false;
     }
-    username = query.value(0).toString();
-    email = query.value(1).toString();
-    phone = query.value(2).toString();
-    nickname = query.value(3).toString();
-    role = query.value(4).toString();
+    noteLocalCommit();   // 自动提交
     return true;
 }
 
-bool DatabaseManager::getUserIdByUsername(const QString& username, int& user_id)
+qint64 DatabaseManager::retainedFrom(const QString& table)
 {
-    QSqlQuery query;
-    query.prepare("SELECT user_id FROM users WHERE username = ?");
-    query.addBindValue(username);
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("SELECT retained_from FROM retention_cutoffs WHERE table_name=?");
+    query.addBindValue(table);
     if (!query.exec() || !query.next()) {
-        return false;
+        return minTimestamp;
     }
-    user_id = query.value(0).toInt();
-    return true;
+    return query.value(0).toLongLong();
 }
 
-// 设备管理
-bool DatabaseManager::addDevice(const QString& name, const QString& type, const QString& location,
-                  const QString& manufacturer, const QString& model, const QString& installation_date)
+int DatabaseManager::compactMonitorData(qint64 beforeMs)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO devices (name, type, location, manufacturer, model, installation_date) "
-                  "VALUES (?, ?, ?, ?, ?, ?)");
-    query.addBindValue(name);
-    query.addBindValue(type);
-    query.addBindValue(location);
-    query.addBindValue(manufacturer);
-    query.addBindValue(model);
-    query.addBindValue(installation_date);
-    return query.exec();
-}
+    if (!connected) {
+        setLastError("数据库未连接");
+        return -1;
+    }
+    const qint64 cutoff = chunkWindow(beforeMs);
+    InstrumentedQuery query(connection(), statements());
+    query.prepare("SELECT MIN(timestamp) FROM monitor_data WHERE device_id=? AND timestamp >= ? AND timestamp < ?");
 
-bool DatabaseManager::updateDevice(int device_id, const QString& name, const QString& type, const QString& location,
-                     const QString& manufacturer, const QString& model, const QString& installation_date)
-{
-    QSqlQuery query;
-    query.prepare("UPDATE devices SET name=?, type=?, location=?, manufacturer=?, model=?, installation_date=? WHERE device_id=?");
-    query.addBindValue(name);
-    query.addBindValue(type);
-    query.addBindValue(location);
-    query.addBindValue(manufacturer);
-    query.addBindValue(model);
-    query.addBindValue(installation_date);
-    query.addBindValue(device_id);
-    return query.exec();
+    int moved = 0;
+    const QVariantList devices = getDevices();
+    for (const QVariant& device : devices) {
+        const int device_id = device.toMap().value("device_id").toInt();
+        // 沿 (device_id, timestamp) 索引逐个找出有原始数据的时间窗
+        qint64 from = 0;
+        forever {
+            query.addBindValue(device_id);
+            query.addBindValue(from);
+            query.addBindValue(cutoff);
+            if (!query.exec() || !query.next()) {
+                setLastError("压缩监控数据失败: " + query.lastError().text());
+                return -1;
+            }
+            if (query.value(0).isNull()) break;
+            const qint64 window = chunkWindow(query.value(0).toLongLong());
+            query.finish();
+            const int count = compactChunkWindow(device_id, window);
+            if (count < 0) return -1;
+            moved += count;
+            from = window + chunkSpanMs;
+        }
+    }
+    return moved;
 }
 
-bool DatabaseManager::deleteDevice(int device_id)
+int DatabaseManager::compactChunkWindow(int device_id, qint64 windowStart)
 {
-    QSqlQuery query;
-    query.prepare("DELETE FROM devices WHERE device_id=?");
+    const qint64 windowEnd = windowStart + chunkSpanMs;
+    QSqlDatabase conn = connection();
+    if (!conn.transaction()) {
+        setLastError("压缩监控数据失败: 无法开启事务 " + conn.lastError().text());
+        return -1;
+    }
+    auto fail = [this, &conn](const QSqlQuery& query) -> int {
+        setLastError("压缩监控数据失败: " + query.lastError().text());
+        conn.rollback();
+        return -1;
+    };
+
+    // 该时间窗已有的块（之前压缩过、又收到迟到数据）先解出来，与原始数据合并后重新分块
+    QVector<MonitorSample> samples;
+    InstrumentedQuery query(conn, statements());
+    query.setForwardOnly(true);
+    query.prepare("SELECT data FROM monitor_chunks WHERE device_id=? AND start_ts >= ? AND start_ts < ? ORDER BY start_ts");
     query.addBindValue(device_id);
-    return query.exec();
-}
+    query.addBindValue(windowStart);
+    query.addBindValue(windowEnd);
+    if (!query.exec()) return fail(query);
+    while (query.next()) {
+        if (!ChunkCodec::decode(query.value(0).toByteArray(), device_id, samples)) {
+            qWarning() << "monitor_chunks 数据块损坏，设备" << device_id << "时间窗" << windowStart;
+        }
+    }
+    const int chunked = samples.size();
 
-QVariantList DatabaseManager::getDevices()
-{
-    QVariantList devices;
-    QSqlQuery query("SELECT device_id, name, type, location, manufacturer, model, installation_date FROM devices");
+    query.prepare("SELECT timestamp, temperature, humidity, light FROM monitor_data "
+                  "WHERE device_id=? AND timestamp >= ? AND timestamp < ? ORDER BY timestamp");
+    query.addBindValue(device_id);
+    query.addBindValue(windowStart);
+    query.addBindValue(windowEnd);
+    if (!query.exec()) return fail(query);
+    MonitorSample sample;
+    sample.device_id = device_id;
     while (query.next()) {
-        QVariantMap device;
-        device["device_id"] = query.value(0).toInt();
-        device["name"] = query.value(1).toString();
-        device["type"] = query.value(2).toString();
-        device["location"] = query.value(3).toString();
-        device["manufacturer"] = query.value(4).toString();
-        device["model"] = query.value(5).toString();
-        device["installation_date"] = query.value(6).toString();
-        devices.append(device);
+        sample.timestamp = query.value(0).toLongLong();
+        sample.temperature = query.value(1).toDouble();
+        sample.humidity = query.value(2).toDouble();
+        sample.light = query.value(3).toDouble();
+        samples.append(sample);
     }
-    return devices;
+    const int moved = samples.size() - chunked;
+    if (moved == 0) {
+        conn.rollback();
+        return 0;
+    }
+    if (chunked > 0) {
+        std::stable_sort(samples.begin(), samples.end(), [](const MonitorSample& a, const MonitorSample& b) {
+            return a.timestamp < b.timestamp;
+        });
+    }
+
+    query.prepare("DELETE FROM monitor_chunks WHERE device_id=? AND start_ts >= ? AND start_ts < ?");
+    query.addBindValue(device_id);
+    query.addBindValue(windowStart);
+    query.addBindValue(windowEnd);
+    if (!query.exec()) return fail(query);
+
+    // 按条数切块，相同时间戳不拆到两块，保证 (device_id, start_ts) 唯一
+    QVariantList deviceIds, starts, ends, counts, datas;
+    QVector<QVariantList> ranges(6);
+    for (int begin = 0; begin < samples.size();) {
+        int end = qMin(begin + maxChunkSamples, samples.size());
+        while (end < samples.size() && samples[end].timestamp == samples[end - 1].timestamp) ++end;
+        double minValue[3], maxValue[3];
+        for (int i = begin; i < end; ++i) {
+            const double values[3] = { samples[i].temperature, samples[i].humidity, samples[i].light };
+            for (int m = 0; m < 3; ++m) {
+                minValue[m] = (i == begin) ? values[m] : qMin(minValue[m], values[m]);
+                maxValue[m] = (i == begin) ? values[m] : qMax(maxValue[m], values[m]);
+            }
+        }
+        deviceIds << device_id;
+        starts << samples[begin].timestamp;
+        ends << samples[end - 1].timestamp;
+        counts << end - begin;
+        for (int m = 0; m < 3; ++m) {
+            ranges[m * 2] << minValue[m];
+            ranges[m * 2 + 1] << maxValue[m];
+        }
+        datas << ChunkCodec::encode(samples.constData() + begin, end - begin);
+        begin = end;
+    }
+    query.prepare("INSERT INTO monitor_chunks (device_id, start_ts, end_ts, count, temperature_min, temperature_max, "
+                  "humidity_min, humidity_max, light_min, light_max, data) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(deviceIds);
+    query.addBindValue(starts);
+    query.addBindValue(ends);
+    query.addBindValue(counts);
+    for (const QVariantList& range : ranges) {
+        query.addBindValue(range);
+    }
+    query.addBindValue(datas);
+    if (!query.execBatch()) return fail(query);
+
+    query.prepare("DELETE FROM monitor_data WHERE device_id=? AND timestamp >= ? AND timestamp < ?");
+    query.addBindValue(device_id);
+    query.addBindValue(windowStart);
+    query.addBindValue(windowEnd);
+    if (!query.exec()) return fail(query);
+    if (!commitConnection(conn)) {
+        setLastError("压缩监控数据失败: 提交事务失败 " + conn.lastError().text());
+        conn.rollback();
+        return -1;
+    }
+    return moved;
 }
 
-bool DatabaseManager::getDeviceIdByName(const QString& name, int& device_id)
+bool DatabaseManager::latestSample(int device_id, MonitorSample& sample) const
 {
-    QSqlQuery query;
-    query.prepare("SELECT device_id FROM devices WHERE name = ?");
-    query.addBindValue(name);
-    if (!query.exec() || !query.next()) {
+    QReadLocker locker(&latestLock);
+    auto it = latestSamples.constFind(device_id);
+    if (it == latestSamples.constEnd()) {
         return false;
     }
-    device_id = query.value(0).toInt();
+    sample = it.value();
     return true;
 }
 
-bool DatabaseManager::getDeviceById(int device_id, QVariantMap& device)
+QHash<int, MonitorSample> DatabaseManager::latestSamplesSnapshot() const
 {
-    QSqlQuery query;
-    query.prepare("SELECT device_id, name, type, location, manufacturer, model, installation_date FROM devices WHERE device_id=?");
-    query.addBindValue(device_id);
-    if (!query.exec() || !query.next()) {
-        return false;
+    QReadLocker locker(&latestLock);
+    return latestSamples;
+}
+
+void DatabaseManager::updateLatestSamples(const QVector<MonitorSample>& samples)
+{
+    // 每次成功写入监控数据后调用，顺带累计写入条数
+    writtenSamples.fetchAndAddRelaxed(samples.size());
+    // 只保留每台设备时间最新的一条；同一批次内每台设备最多通知一次
+    QVector<MonitorSample> changed;
+    QWriteLocker locker(&latestLock);
+    for (const MonitorSample& sample : samples) {
+        auto it = latestSamples.find(sample.device_id);
+        if (it == latestSamples.end()) {
+            latestSamples.insert(sample.device_id, sample);
+        } else if (sample.timestamp >= it.value().timestamp) {
+            it.value() = sample;
+        } else {
+            continue;
+        }
+        bool found = false;
+        for (MonitorSample& item : changed) {
+            if (item.device_id == sample.device_id) {
+                item = sample;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            changed.append(sample);
+        }
+    }
+    locker.unlock();
+    for (const MonitorSample& sample : changed) {
+        emit latestSampleChanged(sample.device_id, sample);
     }
-    device["device_id"] = query.value(0).toInt();
-    device["name"] = query.value(1).toString();
-    device["type"] = query.value(2).toString();
-    device["location"] = query.value(3).toString();
-    device["manufacturer"] = query.value(4).toString();
-    device["model"] = query.value(5).toString();
-    device["installation_date"] = query.value(6).toString();
-    return true;
 }
 
-// 监控数据
-bool DatabaseManager::addMonitorData(int device_id, const QDateTime& timestamp,
-                       double temperature, double humidity, double light)
+bool DatabaseManager::loadLatestSamples()
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO monitor_data (device_id, timestamp, temperature, humidity, light) "
-                  "VALUES (?, ?, ?, ?, ?)");
-    query.addBindValue(device_id);
-    query.addBindValue(timestamp);
-    query.addBindValue(temperature);
-    query.addBindValue(humidity);
-    query.addBindValue(light);
-    return query.exec();
+    QWriteLocker locker(&latestLock);
+    latestSamples.clear();
+    InstrumentedQuery query(connection(), statements());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT COUNT(*) FROM devices") || !query.next()) {
+        setLastError("加载设备最新数据失败: " + query.lastError().text());
+        return false;
+    }
+    const int deviceCount = query.value(0).toInt();
+
+    // 每台设备沿 (device_id, timestamp) 索引取最后一条；先查当前分区，
+    // 仍缺数据的设备再依次往更早的分区查
+    const QStringList tables = partitionTables("monitor_data", minTimestamp, maxTimestamp);
+    for (int i = tables.size() - 1; i >= 0 && latestSamples.size() < deviceCount; --i) {
+        QString sql = QString("SELECT m.device_id, m.timestamp, m.temperature, m.humidity, m.light "
+                              "FROM devices d JOIN %1 m ON m.data_id = "
+                              "(SELECT data_id FROM %1 WHERE device_id = d.device_id ORDER BY timestamp DESC LIMIT 1)")
+                      .arg(tables.at(i));
+        if (!latestSamples.isEmpty()) {
+            QStringList found;
+            for (auto it = latestSamples.constBegin(); it != latestSamples.constEnd(); ++it) {
+                found << QString::number(it.key());
+            }
+            sql += QString(" WHERE d.device_id NOT IN (%1)").arg(found.join(','));
+        }
+        if (!query.exec(sql)) {
+            setLastError("加载设备最新数据失败: " + query.lastError().text());
+            return false;
+        }
+        while (query.next()) {
+            MonitorSample sample;
+            sample.device_id = query.value(0).toInt();
+            sample.timestamp = query.value(1).toLongLong();
+            sample.temperature = query.value(2).toDouble();
+            sample.humidity = query.value(3).toDouble();
+            sample.light = query.value(4).toDouble();
+            latestSamples.insert(sample.device_id, sample);
+        }
+    }
+
+    // 原始数据已全部压缩的设备从最后一块中取；每台设备沿主键 (device_id, start_ts) 只定位最后一块，
+    // 不扫描其他块，只有块比原始数据新时才解码
+    if (!query.exec("SELECT c.device_id, c.start_ts, c.end_ts, c.data FROM devices d JOIN monitor_chunks c ON c.rowid = "
+                    "(SELECT rowid FROM monitor_chunks WHERE device_id = d.device_id ORDER BY start_ts DESC LIMIT 1)")) {
+        setLastError("加载设备最新数据失败: " + query.lastError().text());
+        return false;
+    }
+    QVector<MonitorSample> decoded;
+    while (query.next()) {
+        const int device_id = query.value(0).toInt();
+        auto it = latestSamples.constFind(device_id);
+        if (it != latestSamples.constEnd() && it.value().timestamp >= query.value(2).toLongLong()) continue;
+        decoded.clear();
+        if (ChunkCodec::decode(query.value(3).toByteArray(), device_id, decoded) && !decoded.isEmpty()) {
+            latestSamples.insert(device_id, decoded.last());
+        }
+    }
+    return true;
 }
 
-QVariantList DatabaseManager::getDeviceData(int device_id, const QDateTime& startTime, const QDateTime& endTime)
+QVariantList DatabaseManager::getDeviceData(int device_id, const QDateTime& startTime, const QDateTime& endTime, int maxPoints)
 {
     QVariantList dataList;
-    QSqlQuery query;
-    query.prepare("SELECT timestamp, temperature, humidity, light FROM monitor_data "
-                  "WHERE device_id=? AND timestamp BETWEEN ? AND ? ORDER BY timestamp DESC");
-    query.addBindValue(device_id);
-    query.addBindValue(startTime);
-    query.addBindValue(endTime);
-    while (query.next()) {
+    forEachDeviceSample(device_id, startTime, endTime, [&dataList](const MonitorSample& sample) {
         QVariantMap data;
-        data["timestamp"] = query.value(0).toString();
-        data["temperature"] = query.value(1).toDouble();
-        data["humidity"] = query.value(2).toDouble();
-        data["light"] = query.value(3).toDouble();
+        data["timestamp"] = QDateTime::fromMSecsSinceEpoch(sample.timestamp);
+        data["temperature"] = sample.temperature;
+        data["humidity"] = sample.humidity;
+        data["light"] = sample.light;
         dataList.append(data);
-    }
+        return true;
+    }, Qt::DescendingOrder, maxPoints);
     return dataList;
 }
 
+bool DatabaseManager::forEachDeviceSample(int device_id, const QDateTime& startTime, const QDateTime& endTime,
+                                          const MonitorSampleCallback& callback, Qt::SortOrder order, int maxPoints)
+{
+    const QString direction = order == Qt::AscendingOrder ? "ASC" : "DESC";
+    const Resolution resolution = pickResolution(startTime, endTime, maxPoints);
+    qint64 startMs = startTime.toMSecsSinceEpoch();
+
+    InstrumentedQuery query(connection(), statements());
+    query.setForwardOnly(true);
+    int arms = 1;
+    if (resolution == RawResolution) {
+        // 只查与范围重叠的分区，各分区按自己的索引有序输出，再由 ORDER BY 归并
+        const QStringList tables = partitionTables("monitor_data", startMs, endTime.toMSecsSinceEpoch());
+        QStringList selects;
+        for (const QString& table : tables) {
+            selects << QString("SELECT timestamp, temperature, humidity, light FROM %1 "
+                               "WHERE device_id=? AND timestamp BETWEEN ? AND ?").arg(table);
+        }
+        arms = tables.size();
+        query.prepare(QString("%1 ORDER BY timestamp %2").arg(selects.join(" UNION ALL "), direction));
+    } else {
+        // 汇总表按桶输出平均值，桶起始时间对齐到粒度
+        const RollupTable& rollup = rollupTables[resolution - 1];
+        startMs -= startMs % rollup.bucketMs;
+        query.prepare(QString("SELECT bucket, temperature_sum / count, humidity_sum / count, light_sum / count "
+                              "FROM %1 WHERE device_id=? AND bucket BETWEEN ? AND ? ORDER BY bucket %2")
+                      .arg(rollup.table, direction));
+    }
+    for (int i = 0; i < arms; ++i) {
+        query.addBindValue(device_id);
+        query.addBindValue(startMs);
+        query.addBindValue(endTime.toMSecsSinceEpoch());
+    }
+    if (!query.exec()) {
+        setLastError("获取监控数据失败: " + query.lastError().text());
+        return false;
+    }
+    // 直接从结果集解码到栈上的 MonitorSample，不构造中间容器
+    MonitorSample sample;
+    sample.device_id = device_id;
+    if (resolution == RawResolution) {
+        // 部分原始数据可能已压缩进 monitor_chunks，按时间归并两路，只解码与范围重叠的块
+        const bool ascending = (order == Qt::AscendingOrder);
+        ChunkCursor chunks(connection(), statements(), device_id, startMs, endTime.toMSecsSinceEpoch(), !ascending);
+        if (!chunks.exec()) {
+            setLastError("获取监控数据失败: " + chunks.lastError().text());
+            return false;
+        }
+        MonitorSample chunkSample;
+        bool haveChunk = chunks.next(chunkSample);
+        auto readRow = [&query, &sample]() -> bool {
+            if (!query.next()) return false;
+            sample.timestamp = query.value(0).toLongLong();
+            sample.temperature = query.value(1).toDouble();
+            sample.humidity = query.value(2).toDouble();
+            sample.light = query.value(3).toDouble();
+            return true;
+        };
+        bool haveRow = readRow();
+        while (haveRow || haveChunk) {
+            const bool takeRow = haveRow && (!haveChunk || (ascending ? sample.timestamp <= chunkSample.timestamp
+                                                                      : sample.timestamp >= chunkSample.timestamp));
+            if (!callback(takeRow ? sample : chunkSample)) {
+                break;
+            }
+            if (takeRow) {
+                haveRow = readRow();
+            } else {
+                haveChunk = chunks.next(chunkSample);
+            }
+        }
+        return true;
+    }
+    while (query.next()) {
+        sample.timestamp = query.value(0).toLongLong();
+        sample.temperature = query.value(1).toDouble();
+        sample.humidity = query.value(2).toDouble();
+        sample.light = query.value(3).toDouble();
+        if (!callback(sample)) {
+            break;
+        }
+    }
+    return true;
+}
+
+QVector<MetricStatistics> DatabaseManager::getMetricStatistics(const QString& metric, const QDateTime& startTime,
+                                                               const QDateTime& endTime, int device_id)
+{
+    QVector<MetricStatistics> stats;
+    // 列名无法绑定，只接受固定的三个指标
+    static const QStringList metrics = {"temperature", "humidity", "light"};
+    if (!metrics.contains(metric)) {
+        setLastError("不支持的统计指标: " + metric);
+        return stats;
+    }
+
+    // 各分区、分块、汇总表数据分别累加 count/min/max/sum/平方和，最后合并
+    struct Accumulator {
+        MetricStatistics item;
+        double sum;
+        double sumSquares;
+        bool fromRollup;   // 含汇总表数据，没有平方和
+    };
+    QMap<int, Accumulator> accumulators;
+    auto merge = [&accumulators](const Accumulator& acc) {
+        auto it = accumulators.find(acc.item.device_id);
+        if (it == accumulators.end()) {
+            accumulators.insert(acc.item.device_id, acc);
+            return;
+        }
+        it->item.count += acc.item.count;
+        it->item.min = qMin(it->item.min, acc.item.min);
+        it->item.max = qMax(it->item.max, acc.item.max);
+        it->sum += acc.sum;
+        it->sumSquares += acc.sumSquares;
+        it->fromRollup = it->fromRollup || acc.fromRollup;
+        it->item.approximate = it->item.approximate || acc.item.approximate;
+    };
+
+    const qint64 startMs = startTime.toMSecsSinceEpoch();
+    const qint64 endMs = endTime.toMSecsSinceEpoch();
+    InstrumentedQuery query(connection(), statements());
+    query.setForwardOnly(true);
+    const int metricIndex = metrics.indexOf(metric);
+
+    // 原始数据 [first, last]：各分区分别统计，再加上分块存储中的样本
+    auto addRaw = [&](qint64 first, qint64 last) -> bool {
+        // 以 devices 为外表，按设备走 (device_id, timestamp) 覆盖索引；每个分区单独统计，避免合并后物化
+        for (const QString& table : partitionTables("monitor_data", first, last)) {
+            QString sql = QString("SELECT d.device_id, d.name, COUNT(m.%1), MIN(m.%1), MAX(m.%1), AVG(m.%1), AVG(m.%1 * m.%1) "
+                                  "FROM devices d JOIN %2 m ON m.device_id = d.device_id "
+                                  "WHERE m.timestamp BETWEEN ? AND ?").arg(metric, table);
+            if (device_id != -1) {
+                sql += " AND d.device_id = ?";
+            }
+            sql += " GROUP BY d.device_id ORDER BY d.device_id";
+
+            query.prepare(sql);
+            query.addBindValue(first);
+            query.addBindValue(last);
+            if (device_id != -1) {
+                query.addBindValue(device_id);
+            }
+            if (!query.exec()) {
+                setLastError("统计监控数据失败: " + query.lastError().text());
+                return false;
+            }
+            while (query.next()) {
+                Accumulator acc;
+                acc.item.device_id = query.value(0).toInt();
+                acc.item.device_name = query.value(1).toString();
+                acc.item.count = query.value(2).toLongLong();
+                if (acc.item.count == 0) continue;   // 该指标全为 NULL
+                acc.item.min = query.value(3).toDouble();
+                acc.item.max = query.value(4).toDouble();
+                acc.sum = query.value(5).toDouble() * acc.item.count;
+                acc.sumSquares = query.value(6).toDouble() * acc.item.count;
+                acc.fromRollup = false;
+                merge(acc);
+            }
+        }
+
+        QString chunkSql = "SELECT device_id, data FROM monitor_chunks WHERE start_ts BETWEEN ? AND ? AND end_ts >= ? "
+                           "AND device_id IN (SELECT device_id FROM devices)";
+        if (device_id != -1) {
+            chunkSql += " AND device_id = ?";
+        }
+        query.prepare(chunkSql);
+        query.addBindValue(chunkWindow(first));
+        query.addBindValue(last);
+        query.addBindValue(first);
+        if (device_id != -1) {
+            query.addBindValue(device_id);
+        }
+        if (!query.exec()) {
+            setLastError("统计监控数据失败: " + query.lastError().text());
+            return false;
+        }
+        QVector<MonitorSample> decoded;
+        while (query.next()) {
+            const int id = query.value(0).toInt();
+            decoded.clear();
+            ChunkCodec::decode(query.value(1).toByteArray(), id, decoded);
+            auto it = accumulators.find(id);
+            for (const MonitorSample& sample : decoded) {
+                if (sample.timestamp < first || sample.timestamp > last) continue;
+                const double value = metricIndex == 0 ? sample.temperature
+                                   : metricIndex == 1 ? sample.humidity : sample.light;
+                if (it == accumulators.end()) {
+                    Accumulator acc;
+                    acc.item.device_id = id;
+                    acc.item.device_name = deviceName(id);
+                    acc.item.min = acc.item.max = value;
+                    acc.sum = acc.sumSquares = 0;
+                    acc.fromRollup = false;
+                    it = accumulators.insert(id, acc);
+                }
+                Accumulator& acc = it.value();
+                acc.item.count++;
+                acc.item.min = qMin(acc.item.min, value);
+                acc.item.max = qMax(acc.item.max, value);
+                acc.sum += value;
+                acc.sumSquares += value * value;
+            }
+        }
+        return true;
+    };
+
+    // 汇总表 level 中桶起点在 [firstBucket, lastBucket] 的整桶
+    auto addRollup = [&](int level, qint64 firstBucket, qint64 lastBucket, bool approximate) -> bool {
+        QString sql = QString("SELECT d.device_id, d.name, SUM(r.count), MIN(r.%1_min), MAX(r.%1_max), SUM(r.%1_sum) "
+                              "FROM devices d JOIN %2 r ON r.device_id = d.device_id "
+                              "WHERE r.bucket BETWEEN ? AND ?").arg(metric, rollupTables[level].table);
+        if (device_id != -1) {
+            sql += " AND d.device_id = ?";
+        }
+        sql += " GROUP BY d.device_id ORDER BY d.device_id";
+        query.prepare(sql);
+        query.addBindValue(firstBucket);
+        query.addBindValue(lastBucket);
+        if (device_id != -1) {
+            query.addBindValue(device_id);
+        }
+        if (!query.exec()) {
+            setLastError("统计监控数据失败: " + query.lastError().text());
+            return false;
+        }
+        while (query.next()) {
+            if (query.value(3).isNull()) continue;   // 该指标全为 NULL
+            Accumulator acc;
+            acc.item.device_id = query.value(0).toInt();
+            acc.item.device_name = query.value(1).toString();
+            acc.item.count = query.value(2).toLongLong();
+            acc.item.min = query.value(3).toDouble();
+            acc.item.max = query.value(4).toDouble();
+            acc.item.approximate = approximate;
+            acc.sum = query.value(5).toDouble();
+            acc.sumSquares = 0;
+            acc.fromRollup = true;
+            merge(acc);
+        }
+        return true;
+    };
+
+    // 数据源 0 为原始数据，1..3 为 1 分钟/1 小时/1 天汇总表。各自完整保留的起点取执行保留策略时记录的位置，
+    // 而不是按本进程的保留策略从当前时间推算：从未执行过保留策略的数据库全部使用原始数据
+    const int sourceCount = rollupTableCount + 1;
+    qint64 retained[sourceCount];
+    qint64 unitMs[sourceCount];
+    retained[0] = retainedFrom("monitor_data");
+    unitMs[0] = 1;
+    for (int level = 0; level < rollupTableCount; ++level) {
+        retained[level + 1] = retainedFrom(rollupTables[level].table);
+        unitMs[level + 1] = rollupTables[level].bucketMs;
+    }
+    const qint64 dayMs = rollupTables[rollupTableCount - 1].bucketMs;
+    auto alignUp = [](qint64 ms, qint64 unit) -> qint64 {
+        if (ms == minTimestamp) return ms;
+        const qint64 rest = ms % unit;
+        return rest == 0 ? ms : ms - rest + unit;
+    };
+
+    // 用数据源 source 统计 [a, b)：中间的整桶直接读取；两端不足一个桶的部分交给仍保留该时段的更细一级，
+    // 没有更细的数据时按整桶统计并标记为近似
+    std::function<bool(int, qint64, qint64)> cover;
+    cover = [&](int source, qint64 a, qint64 b) -> bool {
+        if (a >= b) return true;
+        if (source == 0) return addRaw(a, b - 1);
+        const qint64 unit = unitMs[source];
+        const qint64 first = alignUp(a, unit);
+        const qint64 last = b - b % unit;
+        if (first < last && !addRollup(source - 1, first, last - unit, false)) return false;
+        const QPair<qint64, qint64> edges[] = { qMakePair(a, qMin(first, b)), qMakePair(qMax(last, qMin(first, b)), b) };
+        for (const QPair<qint64, qint64>& edge : edges) {
+            if (edge.first >= edge.second) continue;
+            int finer = 0;
+            while (finer < source && retained[finer] > edge.first) ++finer;
+            const bool ok = finer < source
+                ? cover(finer, edge.first, edge.second)
+                : addRollup(source - 1, edge.first - edge.first % unit, edge.first - edge.first % unit, true);
+            if (!ok) return false;
+        }
+        return true;
+    };
+
+    // 从新到旧依次交给最细的数据源；相邻两级的分界对齐到整天（最粗一级的桶），
+    // 范围内部不会出现跨分界的桶，不足一个桶的部分只出现在范围两端
+    qint64 upper = endMs == maxTimestamp ? endMs : endMs + 1;
+    for (int source = 0; source < sourceCount && upper > startMs; ++source) {
+        qint64 lower = retained[source];
+        if (source + 1 < sourceCount) {
+            lower = alignUp(lower, dayMs);
+        }
+        lower = qMin(upper, qMax(startMs, lower));
+        if (!cover(source, lower, upper)) {
+            return stats;
+        }
+        upper = lower;
+    }
+
+    for (Accumulator& acc : accumulators) {
+        MetricStatistics& item = acc.item;
+        item.avg = acc.sum / item.count;
+        if (acc.fromRollup) {
+            item.stddev = -1;
+        } else {
+            // SQLite 没有 STDDEV，用 E[x^2] - E[x]^2 计算总体方差
+            double variance = acc.sumSquares / item.count - item.avg * item.avg;
+            item.stddev = variance > 0 ? std::sqrt(variance) : 0;
+        }
+        stats.append(item);
+    }
+    return stats;
+}
+
 // 告警规则
 bool DatabaseManager::addAlarmRule(int device_id, const QString& description, const QString& condition, const QString& action)
 {
-    QSqlQuery query;
+    QString error;
+    if (!AlarmCondition::validate(condition, &error)) {
+        setLastError("告警条件无效: " + error);
+        return false;
+    }
+    InstrumentedQuery query(connection(), statements());
     query.prepare("INSERT INTO alarm_rules (device_id, description, condition, action) VALUES (?, ?, ?, ?)");
     query.addBindValue(device_id);
     query.addBindValue(description);
     query.addBindValue(condition);
     query.addBindValue(action);
-    return query.exec();
+    if (!query.exec()) {
+        setLastError("添加告警规则失败: " + query.lastError().text());
+        return false;
+    }
+    loadAlarmRules();
+    return true;
 }
 
 bool DatabaseManager::updateAlarmRule(int rule_id, int device_id, const QString& description, const QString& condition, const QString& action)
 {
-    QSqlQuery query;
+    QString error;
+    if (!AlarmCondition::validate(condition, &error)) {
+        setLastError("告警条件无效: " + error);
+        return false;
+    }
+    InstrumentedQuery query(connection(), statements());
     query.prepare("UPDATE alarm_rules SET device_id=?, description=?, condition=?, action=? WHERE rule_id=?");
     query.addBindValue(device_id);
     query.addBindValue(description);
     query.addBindValue(condition);
     query.addBindValue(action);
     query.addBindValue(rule_id);
-    return query.exec();
+    if (!query.exec()) {
+        setLastError("更新告警规则失败: " + query.lastError().text());
+        return false;
+    }
+    loadAlarmRules();
+    return true;
 }
 
 bool DatabaseManager::deleteAlarmRule(int rule_id)
 {
-    QSqlQuery query;
+    InstrumentedQuery query(connection(), statements());
     query.prepare("DELETE FROM alarm_rules WHERE rule_id=?");
     query.addBindValue(rule_id);
-    return query.exec();
+    if (!query.exec()) {
+        setLastError("删除告警规则失败: " + query.lastError().text());
+        return false;
+    }
+    loadAlarmRules();
+    return true;
+}
+
+bool DatabaseManager::loadAlarmRules()
+{
+    InstrumentedQuery query(connection(), statements());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT rule_id, device_id, description, condition FROM alarm_rules")) {
+        setLastError("加载告警规则失败: " + query.lastError().text());
+        return false;
+    }
+    QVector<CompiledAlarmRule> rules;
+    while (query.next()) {
+        CompiledAlarmRule rule;
+        rule.rule_id = query.value(0).toInt();
+        rule.device_id = query.value(1).toInt();
+        rule.description = query.value(2).toString();
+        rule.condition = query.value(3).toString();
+        rules.append(rule);
+    }
+    QStringList errors;
+    alarmEngine->setRules(rules, &errors);
+    for (const QString& error : errors) {
+        qWarning() << "告警规则无法编译，已忽略:" << error;
+    }
+    return true;
+}
+
+bool DatabaseManager::insertAlarmHits(const QVector<AlarmHit>& hits)
+{
+    if (hits.isEmpty()) return true;
+
+    QVariantList deviceIds, timestamps, contents, statuses, notes;
+    for (const AlarmHit& hit : hits) {
+        deviceIds << hit.device_id;
+        timestamps << hit.timestamp;
+        contents << hit.content;
+        statuses << "unprocessed";
+        notes << QString();
+    }
+    InstrumentedQuery query(connection(), statements());
+    query.prepare(insertAlarmRecordSql);
+    query.addBindValue(deviceIds);
+    query.addBindValue(timestamps);
+    query.addBindValue(contents);
+    query.addBindValue(statuses);
+    query.addBindValue(notes);
+    if (!query.execBatch()) {
+        setLastError("写入告警记录失败: " + query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+void DatabaseManager::announceAlarms(const QVector<AlarmHit>& hits)
+{
+    for (const AlarmHit& hit : hits) {
+        emit alarmRaised(hit.device_id, hit.timestamp, hit.content);
+    }
+}
+
+DatabaseManager::AlarmStats DatabaseManager::alarmStats() const
+{
+    const AlarmRuleEngine::Counters counters = alarmEngine->counters();
+    AlarmStats stats;
+    stats.rules = alarmEngine->ruleCount();
+    stats.samples = counters.samples;
+    stats.evaluations = counters.evaluations;
+    stats.raised = counters.hits;
+    return stats;
 }
 
 QVariantList DatabaseManager::getAlarmRules(int device_id)
 {
     QVariantList rules;
-    QSqlQuery query;
-    query.prepare("SELECT rule_id, description, condition, action FROM alarm_rules WHERE device_id=?");
-    query.addBindValue(device_id);
+    InstrumentedQuery query(connection(), statements());
+    // 设备名称随规则一并查出，device_id=-1 表示所有设备
+    QString sql = "SELECT r.rule_id, r.device_id, COALESCE(d.name, '未知设备'), r.description, r.condition, r.action "
+                  "FROM alarm_rules r LEFT JOIN devices d ON d.device_id = r.device_id";
+    if (device_id != -1) {
+        sql += " WHERE r.device_id=?";
+    }
+    sql += " ORDER BY r.rule_id";
+    query.prepare(sql);
+    if (device_id != -1) {
+        query.addBindValue(device_id);
+    }
     if (query.exec()) {
         while (query.next()) {
             QVariantMap rule;
             rule["rule_id"] = query.value(0).toInt();
-            rule["description"] = query.value(1).toString();
-            rule["condition"] = query.value(2).toString();
-            rule["action"] = query.value(3).toString();
+            rule["device_id"] = query.value(1).toInt();
+            rule["device_name"] = query.value(2).toString();
+            rule["description"] = query.value(3).toString();
+            rule["condition"] = query.value(4).toString();
+            rule["action"] = query.value(5).toString();
             rules.append(rule);
         }
     }
@@ -464,27 +2731,33 @@ QVariantList DatabaseManager::getAlarmRules(int device_id)
 // 告警记录
 bool DatabaseManager::addAlarmRecord(int device_id, const QDateTime& timestamp, const QString& content, const QString& status, const QString& note)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO alarm_records (device_id, timestamp, content, status, note) VALUES (?, ?, ?, ?, ?)");
-    query.addBindValue(device_id);
-    query.addBindValue(timestamp);
-    query.addBindValue(content);
-    query.addBindValue(status);
-    query.addBindValue(note);
+    const QVariantList values = QVariantList() << device_id << timestamp.toMSecsSinceEpoch()
+                                               << content << status << note;
+    if (WriteBehindQueue* queue = writeQueue.loadAcquire()) {
+        PendingWrite write;
+        write.kind = PendingWrite::AlarmRecord;
+        write.values = values;
+        return queue->enqueue(write);
+    }
+    InstrumentedQuery query(connection(), statements());
+    query.prepare(insertAlarmRecordSql);
+    for (const QVariant& value : values) {
+        query.addBindValue(value);
+    }
     return query.exec();
 }
 
 QVariantList DatabaseManager::getAlarmRecords(int device_id)
 {
     QVariantList records;
-    QSqlQuery query;
+    InstrumentedQuery query(connection(), statements());
     query.prepare("SELECT alarm_id, timestamp, content, status, note FROM alarm_records WHERE device_id=?");
     query.addBindValue(device_id);
     if (query.exec()) {
         while (query.next()) {
             QVariantMap record;
             record["alarm_id"] = query.value(0).toInt();
-            record["timestamp"] = query.value(1).toString();
+            record["timestamp"] = QDateTime::fromMSecsSinceEpoch(query.value(1).toLongLong());
             record["content"] = query.value(2).toString();
             record["status"] = query.value(3).toString();
             record["note"] = query.value(4).toString();
@@ -494,24 +2767,31 @@ QVariantList DatabaseManager::getAlarmRecords(int device_id)
     return records;
 }
 
-QVariantList DatabaseManager::getAlarmRecordsFiltered(int device_id, const QString& status, const QDateTime& startTime, const QDateTime& endTime)
+QVariantList DatabaseManager::getAlarmRecordsFiltered(int device_id, const QString& status, const QDateTime& startTime, const QDateTime& endTime,
+                                                      int limit)
 {
     QVariantList records;
-    QString sql = "SELECT alarm_id, device_id, timestamp, content, status, note FROM alarm_records WHERE 1=1";
+    // 设备名称通过 JOIN 一并查出，避免逐行查询设备表
+    QString sql = "SELECT a.alarm_id, a.device_id, a.timestamp, a.content, a.status, a.note, "
+                  "COALESCE(d.name, '未知设备') AS device_name "
+                  "FROM alarm_records a LEFT JOIN devices d ON d.device_id = a.device_id WHERE 1=1";
     
     if (device_id != -1) {
-        sql += " AND device_id = :device_id";
+        sql += " AND a.device_id = :device_id";
     }
     if (!status.isEmpty()) {
-        sql += " AND status = :status";
+        sql += " AND a.status = :status";
     }
     if (startTime.isValid() && endTime.isValid()) {
-        sql += " AND timestamp BETWEEN :startTime AND :endTime";
+        sql += " AND a.timestamp BETWEEN :startTime AND :endTime";
     }
     
-    sql += " ORDER BY timestamp DESC";
+    sql += " ORDER BY a.timestamp DESC";
+    if (limit > 0) {
+        sql += QString(" LIMIT %1").arg(limit);
+    }
 
-    QSqlQuery query;
+    InstrumentedQuery query(connection(), statements());
     query.prepare(sql);
 
     if (device_id != -1) {
@@ -521,8 +2801,8 @@ QVariantList DatabaseManager::getAlarmRecordsFiltered(int device_id, const QStri
         query.bindValue(":status", status);
     }
     if (startTime.isValid() && endTime.isValid()) {
-        query.bindValue(":startTime", startTime);
-        query.bindValue(":endTime", endTime);
+        query.bindValue(":startTime", startTime.toMSecsSinceEpoch());
+        query.bindValue(":endTime", endTime.toMSecsSinceEpoch());
     }
 
     if (!query.exec()) {
@@ -534,10 +2814,11 @@ QVariantList DatabaseManager::getAlarmRecordsFiltered(int device_id, const QStri
         QVariantMap record;
         record["alarm_id"] = query.value("alarm_id");
         record["device_id"] = query.value("device_id");
-        record["timestamp"] = query.value("timestamp");
+        record["timestamp"] = QDateTime::fromMSecsSinceEpoch(query.value("timestamp").toLongLong());
         record["content"] = query.value("content");
         record["status"] = query.value("status");
         record["note"] = query.value("note");
+        record["device_name"] = query.value("device_name");
         records.append(record);
     }
 
@@ -548,34 +2829,53 @@ QVariantList DatabaseManager::getAlarmRecordsFiltered(int device_id, const QStri
 bool DatabaseManager::addLog(const QString& log_type, const QString& log_level, const QString& content,
                 int user_id, int device_id)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO system_logs (timestamp, log_type, log_level, content, user_id, device_id) "
-                  "VALUES (?, ?, ?, ?, ?, ?)");
-    query.addBindValue(QDateTime::currentDateTime());
-    query.addBindValue(log_type);
-    query.addBindValue(log_level);
-    query.addBindValue(content);
-    if (user_id == -1) query.addBindValue(QVariant(QVariant::Int)); else query.addBindValue(user_id);
-    if (device_id == -1) query.addBindValue(QVariant(QVariant::Int)); else query.addBindValue(device_id);
-    return query.exec();
+    // 时间戳取调用时刻，不受排队时间影响
+    LogEntry entry;
+    entry.timestamp = QDateTime::currentMSecsSinceEpoch();
+    entry.log_type = log_type;
+    entry.log_level = log_level;
+    entry.content = content;
+    entry.user_id = user_id;
+    entry.device_id = device_id;
+    if (logWriter) {
+        return logWriter->append(entry);
+    }
+    return writeLogs(QVector<LogEntry>(1, entry));
+}
+
+bool DatabaseManager::flushLogs(int timeoutMs)
+{
+    return !logWriter || logWriter->flush(timeoutMs);
+}
+
+DatabaseManager::LogStats DatabaseManager::logStats() const
+{
+    LogStats stats;
+    if (logWriter) {
+        stats.written = logWriter->writtenCount();
+        stats.failed = logWriter->failedCount();
+        stats.dropped = logWriter->droppedCount();
+    }
+    return stats;
 }
 
 QVariantList DatabaseManager::getLogs(const QDateTime& startTime, const QDateTime& endTime)
 {
     QVariantList logs;
-    QSqlQuery query;
+    flushLogs(1000);
+    InstrumentedQuery query(connection(), statements());
     if (startTime.isValid() && endTime.isValid()) {
-        query.prepare("SELECT log_id, timestamp, log_type, log_level, content, user_id, device_id FROM system_logs WHERE timestamp BETWEEN ? AND ? ORDER BY timestamp DESC");
-        query.addBindValue(startTime);
-        query.addBindValue(endTime);
+        query.prepare("SELECT log_id, timestamp, log_type, log_level, content, user_id, device_id FROM system_logs_all WHERE timestamp BETWEEN ? AND ? ORDER BY timestamp DESC");
+        query.addBindValue(startTime.toMSecsSinceEpoch());
+        query.addBindValue(endTime.toMSecsSinceEpoch());
     } else {
-        query.prepare("SELECT log_id, timestamp, log_type, log_level, content, user_id, device_id FROM system_logs ORDER BY timestamp DESC");
+        query.prepare("SELECT log_id, timestamp, log_type, log_level, content, user_id, device_id FROM system_logs_all ORDER BY timestamp DESC");
     }
     if (query.exec()) {
         while (query.next()) {
             QVariantMap log;
             log["log_id"] = query.value(0).toInt();
-            log["timestamp"] = query.value(1).toString();
+            log["timestamp"] = QDateTime::fromMSecsSinceEpoch(query.value(1).toLongLong());
             log["log_type"] = query.value(2).toString();
             log["log_level"] = query.value(3).toString();
             log["content"] = query.value(4).toString();
@@ -590,7 +2890,7 @@ QVariantList DatabaseManager::getLogs(const QDateTime& startTime, const QDateTim
 QVariantList DatabaseManager::getDeviceGroups(const QString& groupType)
 {
     QVariantList groups;
-    QSqlQuery query;
+    InstrumentedQuery query(connection(), statements());
     query.prepare("SELECT group_id, group_name FROM device_groups WHERE group_type=?");
     query.addBindValue(groupType);
     if (query.exec()) {
@@ -606,7 +2906,7 @@ QVariantList DatabaseManager::getDeviceGroups(const QString& groupType)
 
 bool DatabaseManager::addDeviceGroup(const QString& groupName, const QString& groupType)
 {
-    QSqlQuery query;
+    InstrumentedQuery query(connection(), statements());
     query.prepare("INSERT INTO device_groups (group_name, group_type) VALUES (?, ?)");
     query.addBindValue(groupName);
     query.addBindValue(groupType);
@@ -615,7 +2915,7 @@ bool DatabaseManager::addDeviceGroup(const QString& groupName, const QString& gr
 
 bool DatabaseManager::renameDeviceGroup(int groupId, const QString& newName)
 {
-    QSqlQuery query;
+    InstrumentedQuery query(connection(), statements());
     query.prepare("UPDATE device_groups SET group_name=? WHERE group_id=?");
     query.addBindValue(newName);
     query.addBindValue(groupId);
@@ -625,12 +2925,12 @@ bool DatabaseManager::renameDeviceGroup(int groupId, const QString& newName)
 bool DatabaseManager::deleteDeviceGroup(int groupId)
 {
     // 先将该分组下设备的group_id置空
-    QSqlQuery q1;
+    InstrumentedQuery q1(connection(), statements());
     q1.prepare("UPDATE devices SET group_id=NULL WHERE group_id=?");
     q1.addBindValue(groupId);
     q1.exec();
     // 再删除分组
-    QSqlQuery q2;
+    InstrumentedQuery q2(connection(), statements());
     q2.prepare("DELETE FROM device_groups WHERE group_id=?");
     q2.addBindValue(groupId);
     return q2.exec();
@@ -638,7 +2938,7 @@ bool DatabaseManager::deleteDeviceGroup(int groupId)
 
 bool DatabaseManager::setDeviceGroup(int deviceId, int groupId)
 {
-    QSqlQuery query;
+    InstrumentedQuery query(connection(), statements());
     query.prepare("UPDATE devices SET group_id=? WHERE device_id=?");
     query.addBindValue(groupId);
     query.addBindValue(deviceId);
@@ -648,7 +2948,7 @@ bool DatabaseManager::setDeviceGroup(int deviceId, int groupId)
 QVariantList DatabaseManager::getDevicesByGroup(int groupId, bool isNullGroup)
 {
     QVariantList devices;
-    QSqlQuery query;
+    InstrumentedQuery query(connection(), statements());
     if (isNullGroup) {
         query.prepare("SELECT device_id, name, type, location, manufacturer, model, installation_date FROM devices WHERE group_id IS NULL");
     } else {
@@ -674,7 +2974,8 @@ QVariantList DatabaseManager::getDevicesByGroup(int groupId, bool isNullGroup)
 QVariantList DatabaseManager::getAllDeviceGroups()
 {
     QVariantList groups;
-    QSqlQuery query("SELECT group_id, group_name, group_type FROM device_groups");
+    InstrumentedQuery query(connection(), statements());
+    query.exec("SELECT group_id, group_name, group_type FROM device_groups");
     while (query.next()) {
         QVariantMap group;
         group["group_id"] = query.value(0).toInt();
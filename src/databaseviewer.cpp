@@ -1,4 +1,5 @@
 #include "databaseviewer.h"
+#include "csvexporter.h"
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QFileDialog>
@@ -48,7 +49,8 @@ void DatabaseViewer::setupUI()
     QStringList tables = db.tables();
     tables.removeDuplicates();
     for (int i = tables.size() - 1; i >= 0; --i) {
-        if (tables[i].startsWith("sqlite_", Qt::CaseInsensitive)) {
+        // 分区、汇总表等由 DatabaseManager 维护，直接修改会破坏一致性
+        if (tables[i].startsWith("sqlite_", Qt::CaseInsensitive) || DatabaseManager::isInternalTable(tables[i])) {
             tables.removeAt(i);
         }
     }
@@ -77,14 +79,14 @@ void DatabaseViewer::setupUI()
     controlLayout->addStretch();
     controlLayout->addWidget(statusLabel);
 
-    dataTable = new QTableWidget(this);
+    tableModel = new KeysetTableModel(this);
+    dataTable = new QTableView(this);
+    dataTable->setModel(tableModel);
     dataTable->setAlternatingRowColors(true);
     dataTable->horizontalHeader()->setStretchLastSection(true);
     dataTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     dataTable->setSelectionMode(QAbstractItemView::SingleSelection);
-    if (m_readonly) {
-        dataTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    }
+    dataTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
     mainLayout->addLayout(controlLayout);
     mainLayout->addWidget(dataTable);
@@ -92,13 +94,16 @@ void DatabaseViewer::setupUI()
     connect(tableComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &DatabaseViewer::onTableChanged);
     connect(refreshButton, &QPushButton::clicked, this, &DatabaseViewer::onRefreshClicked);
     connect(exportButton, &QPushButton::clicked, this, &DatabaseViewer::onExportClicked);
+    connect(tableModel, &QAbstractItemModel::rowsInserted, this, &DatabaseViewer::updateStatus);
+    connect(tableModel, &QAbstractItemModel::modelReset, this, &DatabaseViewer::updateStatus);
     if (!m_readonly) {
         qDebug() << "addButton address:" << addButton;
         connect(addButton, &QPushButton::clicked, this, &DatabaseViewer::onAddClicked);
         connect(deleteButton, &QPushButton::clicked, this, &DatabaseViewer::onDeleteClicked);
         connect(saveButton, &QPushButton::clicked, this, &DatabaseViewer::onEditClicked);
-        connect(dataTable, &QTableWidget::cellChanged, this, &DatabaseViewer::onCellChanged);
-        connect(dataTable, &QTableWidget::cellDoubleClicked, this, &DatabaseViewer::onCellDoubleClicked);
+        connect(dataTable, &QTableView::doubleClicked, this, [this](const QModelIndex& index) {
+            onCellDoubleClicked(index.row(), index.column());
+        });
         connect(addButton, &QPushButton::clicked, [](){ qDebug() << "addButton clicked!"; });
     }
 }
@@ -125,52 +130,30 @@ void DatabaseViewer::onRefreshClicked()
 
 void DatabaseViewer::onExportClicked()
 {
-    QString fileName = QFileDialog::getSaveFileName(this, "导出数据", 
-                                                   "database_export.csv", 
-                                                   "CSV文件 (*.csv)");
-    if (fileName.isEmpty()) return;
-
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "错误", "无法创建文件");
-        return;
-    }
-
-    QTextStream out(&file);
-    out.setCodec("UTF-8");
-
-    // 写入表头
-    QStringList headers;
-    for (int i = 0; i < dataTable->columnCount(); ++i) {
-        headers << dataTable->horizontalHeaderItem(i)->text();
-    }
-    out << headers.join(",") << "\n";
-
-    // 写入数据
-    for (int row = 0; row < dataTable->rowCount(); ++row) {
-        QStringList rowData;
-        for (int col = 0; col < dataTable->columnCount(); ++col) {
-            QTableWidgetItem *item = dataTable->item(row, col);
-            rowData << (item ? item->text() : "");
-        }
-        out << rowData.join(",") << "\n";
-    }
-
-    file.close();
-    QMessageBox::information(this, "成功", "数据已导出到: " + fileName);
+    const QString sql = tableModel->fullSql();
+    if (sql.isEmpty()) return;
+
+    // 导出整张表（不只是已加载到界面的行），按与界面相同的列和顺序流式读取
+    CsvExporter::Request request;
+    request.headers = tableModel->headerLabels();
+    request.source = CsvExporter::querySource(sql);
+    CsvExporter::exportWithDialog(this, "导出数据", request);
 }
 
 void DatabaseViewer::loadTableData(const QString& tableName)
 {
-    disconnect(dataTable, &QTableWidget::cellChanged, this, &DatabaseViewer::onCellChanged);
-    
     statusLabel->setText("正在加载数据...");
+    currentTable = tableName;
 
     bool showEditButtons = (tableName == "users");
     addButton->setVisible(showEditButtons);
     deleteButton->setVisible(showEditButtons);
     saveButton->setVisible(showEditButtons);
 
+    for (int col = 0; col < tableModel->columnCount(); ++col) {
+        dataTable->setColumnHidden(col, false);
+    }
+
     if (tableName == "users") {
         displayUsers();
     } else if (tableName == "devices") {
@@ -186,149 +169,74 @@ void DatabaseViewer::loadTableData(const QString& tableName)
     } else if (tableName == "device_groups") {
         displayDeviceGroups();
     }
+}
 
-    connect(dataTable, &QTableWidget::cellChanged, this, &DatabaseViewer::onCellChanged);
+void DatabaseViewer::updateStatus()
+{
+    statusLabel->setText(tableModel->canFetchMore(QModelIndex())
+                             ? QString("已加载 %1 条记录，滚动到底部继续加载").arg(tableModel->rowCount())
+                             : QString("已加载 %1 条记录").arg(tableModel->rowCount()));
+}
 
-    statusLabel->setText(QString("已加载 %1 条记录").arg(dataTable->rowCount()));
+QString DatabaseViewer::cellText(int row, int column) const
+{
+    return tableModel->data(tableModel->index(row, column)).toString();
 }
 
 void DatabaseViewer::displayUsers()
 {
-    dataTable->clear();
-    dataTable->setColumnCount(7);
-    dataTable->setHorizontalHeaderLabels({"用户ID", "用户名", "密码", "邮箱", "手机号", "昵称", "角色"});
+    tableModel->setQuery("users", "user_id",
+                         {"user_id", "username", "password", "email", "phone", "nickname", "role"},
+                         {"用户ID", "用户名", "密码", "邮箱", "手机号", "昵称", "角色"});
     dataTable->setColumnHidden(0, true);
     dataTable->setColumnHidden(2, true);
-
-    QSqlQuery query("SELECT user_id, username, password, email, phone, nickname, role FROM users");
-    
-    int row = 0;
-    while (query.next()) {
-        dataTable->insertRow(row);
-        for (int col = 0; col < 7; ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
-            if (col == 0 || col == 6) {
-                item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-            }
-            dataTable->setItem(row, col, item);
-        }
-        dataTable->item(row, 0)->setData(Qt::UserRole, query.value(0));
-        row++;
-    }
 }
 
 void DatabaseViewer::displayDeviceGroups()
 {
-    dataTable->clear();
-    dataTable->setColumnCount(3);
-    dataTable->setHorizontalHeaderLabels({"分组ID", "分组名", "分组类型"});
-
-    QSqlQuery query("SELECT group_id, group_name, group_type FROM device_groups");
-
-    int row = 0;
-    while (query.next()) {
-        dataTable->insertRow(row);
-        for (int col = 0; col < 3; ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
-            dataTable->setItem(row, col, item);
-        }
-        row++;
-    }
+    tableModel->setQuery("device_groups", "group_id",
+                         {"group_id", "group_name", "group_type"},
+                         {"分组ID", "分组名", "分组类型"});
 }
 
 void DatabaseViewer::displayDevices()
 {
-    dataTable->clear();
-    dataTable->setColumnCount(7);
-    dataTable->setHorizontalHeaderLabels({"设备ID", "名称", "类型", "位置", "制造商", "型号", "安装日期"});
-
-    QSqlQuery query("SELECT device_id, name, type, location, manufacturer, model, installation_date FROM devices");
-    
-    int row = 0;
-    while (query.next()) {
-        dataTable->insertRow(row);
-        for (int col = 0; col < 7; ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
-            dataTable->setItem(row, col, item);
-        }
-        row++;
-    }
+    tableModel->setQuery("devices", "device_id",
+                         {"device_id", "name", "type", "location", "manufacturer", "model", "installation_date"},
+                         {"设备ID", "名称", "类型", "位置", "制造商", "型号", "安装日期"});
 }
 
+// 时间类的表按主键倒序分页：主键随写入递增，最新的记录在前；
+// 监控数据和日志经 *_all 视图读取，包含已封存的分区
 void DatabaseViewer::displayMonitorData()
 {
-    dataTable->clear();
-    dataTable->setColumnCount(6);
-    dataTable->setHorizontalHeaderLabels({"数据ID", "设备ID", "时间戳", "温度", "湿度", "光照"});
-
-    QSqlQuery query("SELECT data_id, device_id, timestamp, temperature, humidity, light FROM monitor_data ORDER BY timestamp DESC LIMIT 100");
-    
-    int row = 0;
-    while (query.next()) {
-        dataTable->insertRow(row);
-        for (int col = 0; col < 6; ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
-            dataTable->setItem(row, col, item);
-        }
-        row++;
-    }
+    tableModel->setQuery("monitor_data_all", "data_id",
+                         {"data_id", "device_id", "strftime('%Y-%m-%d %H:%M:%S', timestamp / 1000, 'unixepoch', 'localtime')",
+                          "temperature", "humidity", "light"},
+                         {"数据ID", "设备ID", "时间戳", "温度", "湿度", "光照"}, Qt::DescendingOrder);
 }
 
 void DatabaseViewer::displayAlarmRules()
 {
-    dataTable->clear();
-    dataTable->setColumnCount(5);
-    dataTable->setHorizontalHeaderLabels({"规则ID", "设备ID", "描述", "条件", "动作"});
-
-    QSqlQuery query("SELECT rule_id, device_id, description, condition, action FROM alarm_rules");
-    
-    int row = 0;
-    while (query.next()) {
-        dataTable->insertRow(row);
-        for (int col = 0; col < 5; ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
-            dataTable->setItem(row, col, item);
-        }
-        row++;
-    }
+    tableModel->setQuery("alarm_rules", "rule_id",
+                         {"rule_id", "device_id", "description", "condition", "action"},
+                         {"规则ID", "设备ID", "描述", "条件", "动作"});
 }
 
 void DatabaseViewer::displayAlarmRecords()
 {
-    dataTable->clear();
-    dataTable->setColumnCount(6);
-    dataTable->setHorizontalHeaderLabels({"告警ID", "设备ID", "时间戳", "内容", "状态", "备注"});
-
-    QSqlQuery query("SELECT alarm_id, device_id, timestamp, content, status, note FROM alarm_records ORDER BY timestamp DESC");
-    
-    int row = 0;
-    while (query.next()) {
-        dataTable->insertRow(row);
-        for (int col = 0; col < 6; ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
-            dataTable->setItem(row, col, item);
-        }
-        row++;
-    }
+    tableModel->setQuery("alarm_records", "alarm_id",
+                         {"alarm_id", "device_id", "strftime('%Y-%m-%d %H:%M:%S', timestamp / 1000, 'unixepoch', 'localtime')",
+                          "content", "status", "note"},
+                         {"告警ID", "设备ID", "时间戳", "内容", "状态", "备注"}, Qt::DescendingOrder);
 }
 
 void DatabaseViewer::displaySystemLogs()
 {
-    dataTable->clear();
-    dataTable->setColumnCount(7);
-    dataTable->setHorizontalHeaderLabels({"日志ID", "时间戳", "类型", "级别", "内容", "用户ID", "设备ID"});
-
-    QSqlQuery query("SELECT log_id, timestamp, log_type, log_level, content, user_id, device_id FROM system_logs ORDER BY timestamp DESC LIMIT 100");
-    
-    int row = 0;
-    while (query.next()) {
-        dataTable->insertRow(row);
-        for (int col = 0; col < 7; ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
-            dataTable->setItem(row, col, item);
-        }
-        row++;
-    }
+    tableModel->setQuery("system_logs_all", "log_id",
+                         {"log_id", "strftime('%Y-%m-%d %H:%M:%S', timestamp / 1000, 'unixepoch', 'localtime')",
+                          "log_type", "log_level", "content", "user_id", "device_id"},
+                         {"日志ID", "时间戳", "类型", "级别", "内容", "用户ID", "设备ID"}, Qt::DescendingOrder);
 }
 
 void DatabaseViewer::onAddClicked()
@@ -357,20 +265,20 @@ void DatabaseViewer::onAddClicked()
 
 void DatabaseViewer::onDeleteClicked()
 {
-    if (tableComboBox->currentText() != "users") return;
-    int row = dataTable->currentRow();
+    if (currentTable != "users") return;
+    int row = dataTable->currentIndex().row();
     if (row < 0) {
         QMessageBox::warning(this, "警告", "请先选中要删除的用户行。");
         return;
     }
-    QTableWidgetItem* idItem = dataTable->item(row, 0);
-    if (!idItem) {
+    QVariant idValue = tableModel->data(tableModel->index(row, 0), Qt::UserRole);
+    if (!idValue.isValid()) {
         QMessageBox::warning(this, "警告", "无法获取用户ID。");
         return;
     }
-    int userId = idItem->data(Qt::UserRole).toInt();
+    int userId = idValue.toInt();
     qDebug() << "delete userId:" << userId;
-    QString username = dataTable->item(row, 1) ? dataTable->item(row, 1)->text() : "";
+    QString username = cellText(row, 1);
     if (userId <= 0) {
         QMessageBox::warning(this, "警告", "只能删除已保存到数据库的用户。");
         return;
@@ -389,22 +297,17 @@ void DatabaseViewer::onDeleteClicked()
 
 void DatabaseViewer::onEditClicked()
 {
-    if (tableComboBox->currentText() != "users") return;
-    int row = dataTable->currentRow();
+    if (currentTable != "users") return;
+    int row = dataTable->currentIndex().row();
     if (row < 0) {
         QMessageBox::warning(this, "警告", "请先选中要修改的用户行。");
         return;
     }
-    int userId = dataTable->item(row, 0)->data(Qt::UserRole).toInt();
+    int userId = tableModel->data(tableModel->index(row, 0), Qt::UserRole).toInt();
     qDebug() << "edit userId:" << userId;
     UserEditDialog dlg(this);
-    dlg.setUserInfo(
-        dataTable->item(row, 1) ? dataTable->item(row, 1)->text() : "",
-        dataTable->item(row, 3) ? dataTable->item(row, 3)->text() : "",
-        dataTable->item(row, 4) ? dataTable->item(row, 4)->text() : "",
-        dataTable->item(row, 5) ? dataTable->item(row, 5)->text() : "",
-        dataTable->item(row, 6) ? dataTable->item(row, 6)->text() : "user"
-    );
+    dlg.setUserInfo(cellText(row, 1), cellText(row, 3), cellText(row, 4), cellText(row, 5),
+                    cellText(row, 6).isEmpty() ? "user" : cellText(row, 6));
     if (dlg.exec() == QDialog::Accepted) {
         auto info = dlg.getUserInfo();
         if (info.email.isEmpty() || info.phone.isEmpty()) {
@@ -424,27 +327,14 @@ void DatabaseViewer::onEditClicked()
     }
 }
 
-void DatabaseViewer::onCellChanged(int row, int column)
-{
-    Q_UNUSED(row);
-    Q_UNUSED(column);
-    // 空实现
-}
-
 void DatabaseViewer::onCellDoubleClicked(int row, int column)
 {
-    Q_UNUSED(row);
     Q_UNUSED(column);
-    if (tableComboBox->currentText() != "users") return;
-    int userId = dataTable->item(row, 0)->data(Qt::UserRole).toInt();
+    if (currentTable != "users") return;
+    int userId = tableModel->data(tableModel->index(row, 0), Qt::UserRole).toInt();
     UserEditDialog dlg(this);
-    dlg.setUserInfo(
-        dataTable->item(row, 1) ? dataTable->item(row, 1)->text() : "",
-        dataTable->item(row, 3) ? dataTable->item(row, 3)->text() : "",
-        dataTable->item(row, 4) ? dataTable->item(row, 4)->text() : "",
-        dataTable->item(row, 5) ? dataTable->item(row, 5)->text() : "",
-        dataTable->item(row, 6) ? dataTable->item(row, 6)->text() : "user"
-    );
+    dlg.setUserInfo(cellText(row, 1), cellText(row, 3), cellText(row, 4), cellText(row, 5),
+                    cellText(row, 6).isEmpty() ? "user" : cellText(row, 6));
     if (dlg.exec() == QDialog::Accepted) {
         auto info = dlg.getUserInfo();
         if (info.email.isEmpty() || info.phone.isEmpty()) {
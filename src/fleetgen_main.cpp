@@ -0,0 +1,98 @@
+#include "databasemanager.h"
+#include "fleetgenerator.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QDebug>
+
+// 合成设备群数据库：相同的参数和种子总是生成逐行相同的数据，用于压测和界面测试
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("FleetGenerator");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("生成可复现的合成设备群数据库");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "输出的数据库文件", "path", "fleet.db");
+    QCommandLineOption forceOption("force", "数据库文件已存在时删除后重新生成");
+    QCommandLineOption seedOption("seed", "随机种子", "n", "42");
+    QCommandLineOption groupsOption("groups", "设备分组数", "n", "20");
+    QCommandLineOption devicesOption("devices", "设备数", "n", "1000");
+    QCommandLineOption endOption("end", "数据结束日期（UTC，不含当天），默认为今天", "yyyy-MM-dd");
+    QCommandLineOption daysOption("days", "生成的天数", "days", "30");
+    QCommandLineOption intervalOption("interval-ms", "每台设备的采样间隔（毫秒）", "ms", "60000");
+    QCommandLineOption windowOption("window-minutes", "每批生成和写入的时间窗口，0 表示自动", "min", "0");
+    QCommandLineOption gapOption("gap-rate", "每台设备每天出现离线的概率", "p", "0.05");
+    QCommandLineOption lateOption("late-rate", "延迟到达（乱序写入）的样本比例", "p", "0.01");
+    QCommandLineOption spikeOption("spike-rate", "温度毛刺的样本比例", "p", "0.0005");
+    QCommandLineOption offsetOption("utc-offset", "昼夜曲线使用的时区（小时）", "hours", "8");
+    QCommandLineOption threadsOption("threads", "生成线程数，0 表示全部核心", "n", "0");
+    QCommandLineOption profileOption("profile", "SQLite 运行参数：" + DatabaseManager::tuningProfileNames().join('/'), "name", "bulk");
+    parser.addOptions({dbOption, forceOption, seedOption, groupsOption, devicesOption, endOption, daysOption,
+                       intervalOption, windowOption, gapOption, lateOption, spikeOption, offsetOption, threadsOption,
+                       profileOption});
+    parser.process(app);
+
+    // 结束时间固定到 UTC 零点：不指定 --end 时同一天内多次运行结果相同
+    QDate endDate = QDateTime::currentDateTimeUtc().date();
+    if (parser.isSet(endOption)) {
+        endDate = QDate::fromString(parser.value(endOption), "yyyy-MM-dd");
+        if (!endDate.isValid()) {
+            qCritical() << "无效的日期:" << parser.value(endOption);
+            return -1;
+        }
+    }
+
+    FleetGenerator::Options options;
+    options.seed = parser.value(seedOption).toULongLong();
+    options.groups = qMax(1, parser.value(groupsOption).toInt());
+    options.devices = qMax(1, parser.value(devicesOption).toInt());
+    options.endMs = QDateTime(endDate, QTime(0, 0), Qt::UTC).toMSecsSinceEpoch();
+    options.startMs = options.endMs - qMax(1, parser.value(daysOption).toInt()) * 24 * 60 * 60 * 1000LL;
+    options.intervalMs = qMax(1, parser.value(intervalOption).toInt());
+    options.windowMinutes = qMax(0, parser.value(windowOption).toInt());
+    options.gapRate = qBound(0.0, parser.value(gapOption).toDouble(), 1.0);
+    options.lateRate = qBound(0.0, parser.value(lateOption).toDouble(), 1.0);
+    options.spikeRate = qBound(0.0, parser.value(spikeOption).toDouble(), 1.0);
+    options.utcOffsetHours = parser.value(offsetOption).toInt();
+    options.threads = qMax(0, parser.value(threadsOption).toInt());
+
+    const QString path = parser.value(dbOption);
+    if (QFile::exists(path)) {
+        if (!parser.isSet(forceOption)) {
+            qCritical() << "数据库文件已存在，使用 --force 覆盖:" << path;
+            return -1;
+        }
+        for (const QString& suffix : {QString(), QString("-wal"), QString("-shm")}) {
+            QFile::remove(path + suffix);
+        }
+    }
+
+    // 默认的 bulk 配置：生成失败时直接删除文件重来，不需要掉电保护
+    DatabaseManager::TuningProfile profile;
+    if (!DatabaseManager::findTuningProfile(parser.value(profileOption), profile)) {
+        qCritical() << "未知的运行参数配置:" << parser.value(profileOption);
+        return -1;
+    }
+    DatabaseManager& database = DatabaseManager::instance();
+    database.setTuningProfile(profile);
+    if (!database.initDatabase(path)) {
+        qCritical() << "数据库初始化失败:" << database.lastError();
+        return -1;
+    }
+
+    FleetGenerator generator(options);
+    const bool ok = generator.run();
+    if (!ok) {
+        qCritical() << "生成失败:" << generator.lastError();
+        return -1;
+    }
+    const FleetGenerator::Stats& stats = generator.stats();
+    qInfo().noquote() << QString("完成：%1 条样本，%2 条告警，%3 条日志，用时 %4 秒，%5 条/秒")
+                         .arg(stats.samples).arg(stats.alarms).arg(stats.logs)
+                         .arg(stats.elapsedMs / 1000.0, 0, 'f', 1)
+                         .arg(stats.samples * 1000 / qMax<qint64>(1, stats.elapsedMs));
+    return 0;
+}
@@ -0,0 +1,420 @@
+#include "fleetgenerator.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QFuture>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const qint64 dayMs = 24 * 60 * 60 * 1000LL;
+const double pi = 3.14159265358979323846;
+
+// 随机数流的用途，区分同一设备不同用途的序列
+enum Stream : quint64 { ProfileStream = 1, SampleStream, OutageStream, MetadataStream };
+
+// 自实现的 splitmix64 和分布：标准库的分布在不同实现上结果不同，会破坏跨平台的确定性
+quint64 mix64(quint64 x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+class Random
+{
+public:
+    explicit Random(quint64 seed) : state(seed) {}
+
+    quint64 next()
+    {
+        state += 0x9E3779B97F4A7C15ULL;
+        quint64 x = state;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+    // [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    double uniform(double low, double high) { return low + (high - low) * uniform(); }
+    // 标准正态分布（Box-Muller）
+    double normal()
+    {
+        const double u = 1.0 - uniform();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(2 * pi * uniform());
+    }
+
+private:
+    quint64 state;
+};
+
+double round2(double value)
+{
+    return std::round(value * 100) / 100;
+}
+
+const char* const manufacturers[] = { "海康威视", "大华", "华为", "研华", "西门子" };
+
+} // namespace
+
+FleetGenerator::FleetGenerator(const Options& options)
+    : options(options)
+{
+    if (this->options.threads <= 0) {
+        this->options.threads = QThread::idealThreadCount();
+    }
+    if (this->options.windowMinutes <= 0) {
+        // 每个窗口约 50 万条样本：足够让线程池和批量写入都跑满，内存占用又不大
+        const qint64 perMinute = qMax<qint64>(1, qint64(this->options.devices) * 60000 / qMax(1, this->options.intervalMs));
+        this->options.windowMinutes = int(qBound<qint64>(1, 500000 / perMinute, 24 * 60));
+    }
+
+    profiles.resize(options.devices);
+    for (int i = 0; i < options.devices; ++i) {
+        Random random(streamSeed(ProfileStream, quint64(i), 0));
+        Profile& profile = profiles[i];
+        profile.deviceId = i + 1;
+        profile.outdoor = random.uniform() < 0.3;
+        profile.baseTemperature = profile.outdoor ? random.uniform(12, 22) : random.uniform(20, 26);
+        profile.temperatureAmplitude = profile.outdoor ? random.uniform(4, 9) : random.uniform(0.5, 2.5);
+        profile.baseHumidity = random.uniform(40, 70);
+        profile.humidityAmplitude = profile.outdoor ? random.uniform(10, 20) : random.uniform(2, 6);
+        profile.lightPeak = profile.outdoor ? random.uniform(20000, 80000) : random.uniform(300, 800);
+        profile.noise = random.uniform(0.05, 0.4);
+        profile.alarmThreshold = profile.outdoor ? 35 : 30;
+        profile.phaseMinutes = int(random.uniform(-60, 60));
+        profile.offsetMs = int(random.uniform(0, options.intervalMs));
+    }
+}
+
+quint64 FleetGenerator::streamSeed(quint64 a, quint64 b, quint64 c) const
+{
+    return mix64(mix64(mix64(options.seed ^ a) ^ b) ^ c);
+}
+
+bool FleetGenerator::run()
+{
+    QElapsedTimer clock;
+    clock.start();
+    totals = Stats();
+    if (options.devices <= 0 || options.groups <= 0 || options.intervalMs <= 0 || options.endMs <= options.startMs) {
+        error = "参数无效";
+        return false;
+    }
+    if (!writeFleet()) {
+        return false;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.threads);
+    const qint64 windowMs = options.windowMinutes * 60000LL;
+    const int chunkCount = qMin(options.devices, options.threads * 4);
+
+    // 一个窗口拆成若干设备段并行生成；写入当前窗口时下一个窗口已在后台生成
+    auto launch = [&](qint64 windowStart) -> QVector<QFuture<QVector<Slice>>> {
+        QVector<QFuture<QVector<Slice>>> futures;
+        const qint64 windowEnd = qMin(windowStart + windowMs, options.endMs);
+        for (int c = 0; c < chunkCount; ++c) {
+            const int first = int(qint64(options.devices) * c / chunkCount);
+            const int last = int(qint64(options.devices) * (c + 1) / chunkCount);
+            futures.append(QtConcurrent::run(&pool, [this, first, last, windowStart, windowEnd]() -> QVector<Slice> {
+                QVector<Slice> slices;
+                slices.reserve(last - first);
+                for (int i = first; i < last; ++i) {
+                    slices.append(generateSlice(i, windowStart, windowEnd));
+                }
+                return slices;
+            }));
+        }
+        return futures;
+    };
+
+    QVector<QFuture<QVector<Slice>>> pending = launch(options.startMs);
+    for (qint64 windowStart = options.startMs; windowStart < options.endMs; windowStart += windowMs) {
+        QVector<Slice> slices;
+        slices.reserve(options.devices);
+        for (QFuture<QVector<Slice>>& future : pending) {
+            slices += future.result();
+        }
+        pending.clear();
+        const Window window = mergeSlices(slices);
+        slices.clear();
+        if (windowStart + windowMs < options.endMs) {
+            pending = launch(windowStart + windowMs);
+        }
+        if (!writeWindow(window)) {
+            for (QFuture<QVector<Slice>>& future : pending) future.waitForFinished();
+            return false;
+        }
+
+        const qint64 done = qMin(windowStart + windowMs, options.endMs) - options.startMs;
+        const qint64 elapsed = qMax<qint64>(1, clock.elapsed());
+        qInfo().noquote() << QString("%1%  %2 条样本  %3 条/秒")
+                             .arg(100.0 * done / (options.endMs - options.startMs), 0, 'f', 1)
+                             .arg(totals.samples)
+                             .arg(totals.samples * 1000 / elapsed);
+    }
+    totals.elapsedMs = clock.elapsed();
+    return true;
+}
+
+bool FleetGenerator::writeFleet()
+{
+    QVector<QVariantList> groupColumns(3);
+    for (int g = 0; g < options.groups; ++g) {
+        groupColumns[0] << g + 1;
+        groupColumns[1] << QString("园区 %1").arg(g + 1, 3, 10, QChar('0'));
+        groupColumns[2] << "位置";
+    }
+
+    QVector<QVariantList> deviceColumns(8);
+    for (const Profile& profile : profiles) {
+        Random random(streamSeed(MetadataStream, quint64(profile.deviceId), 0));
+        const int group = int(random.next() % quint64(options.groups)) + 1;
+        const qint64 installed = options.startMs - qint64(random.uniform(0, 3 * 365)) * dayMs;
+        deviceColumns[0] << profile.deviceId;
+        deviceColumns[1] << QString("传感器-%1").arg(profile.deviceId, 6, 10, QChar('0'));
+        deviceColumns[2] << (profile.outdoor ? "室外温湿度光照" : "室内温湿度光照");
+        // 先取出随机数再拼接：链式 arg() 的实参求值顺序在 C++11 中未指定
+        const int building = int(random.next() % 20) + 1;
+        const int storey = int(random.next() % 30) + 1;
+        deviceColumns[3] << QString("园区 %1 / %2 号楼 / %3 层").arg(group, 3, 10, QChar('0')).arg(building).arg(storey);
+        deviceColumns[4] << manufacturers[random.next() % (sizeof(manufacturers) / sizeof(manufacturers[0]))];
+        deviceColumns[5] << QString("TH-%1").arg(100 + random.next() % 5 * 100);
+        deviceColumns[6] << QDateTime::fromMSecsSinceEpoch(installed, Qt::UTC).date().toString("yyyy-MM-dd");
+        deviceColumns[7] << group;
+    }
+
+    QSqlDatabase conn = DatabaseManager::instance().connection();
+    if (!conn.transaction()) {
+        error = "无法开启事务: " + conn.lastError().text();
+        return false;
+    }
+    if (!insertRows("INSERT INTO device_groups (group_id, group_name, group_type) VALUES (?, ?, ?)", groupColumns)
+        || !insertRows("INSERT INTO devices (device_id, name, type, location, manufacturer, model, installation_date, group_id) "
+                       "VALUES (?, ?, ?, ?, ?, ?, ?, ?)", deviceColumns)) {
+        conn.rollback();
+        return false;
+    }
+    if (!conn.commit()) {
+        error = "提交失败: " + conn.lastError().text();
+        conn.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool FleetGenerator::outage(int deviceIndex, qint64 day, qint64& begin, qint64& end) const
+{
+    Random random(streamSeed(OutageStream, quint64(deviceIndex), quint64(day)));
+    if (random.uniform() >= options.gapRate) {
+        return false;
+    }
+    begin = day * dayMs + qint64(random.uniform() * dayMs);
+    // 离线时长 10 分钟 ~ 6 小时，短时离线居多
+    end = begin + qint64(10 * std::pow(36.0, random.uniform()) * 60000);
+    return true;
+}
+
+FleetGenerator::Sample FleetGenerator::sampleAt(int deviceIndex, qint64 k) const
+{
+    const Profile& profile = profiles[deviceIndex];
+    Random random(streamSeed(SampleStream, quint64(deviceIndex), quint64(k)));
+
+    Sample sample;
+    MonitorSample& value = sample.sample;
+    value.device_id = profile.deviceId;
+    value.timestamp = options.startMs + k * options.intervalMs + profile.offsetMs
+                      + qint64(random.uniform() * options.intervalMs / 4);
+
+    const qint64 local = value.timestamp + options.utcOffsetHours * 3600000LL;
+    const double minuteOfDay = double(((local % dayMs) + dayMs) % dayMs) / 60000;
+    const double dayOfYear = std::fmod(double(local) / dayMs, 365.2425);
+    // 日变化：14 点附近最高；季节变化：1 月中旬最低
+    const double daily = std::cos(2 * pi * (minuteOfDay - 14 * 60 - profile.phaseMinutes) / 1440);
+    const double season = -std::cos(2 * pi * (dayOfYear - 15) / 365.25) * (profile.outdoor ? 8 : 1.5);
+    double temperature = profile.baseTemperature + season + profile.temperatureAmplitude * daily
+                         + profile.noise * random.normal();
+    const double humidity = profile.baseHumidity - profile.humidityAmplitude * daily + 1.5 * random.normal();
+
+    // 光照：室外按日出日落的半正弦并叠加云层遮挡，室内主要来自工作时间的照明
+    const double sun = std::max(0.0, std::sin(pi * (minuteOfDay - 6 * 60) / (12 * 60)));
+    double light;
+    if (profile.outdoor) {
+        light = profile.lightPeak * sun * random.uniform(0.4, 1.0);
+    } else {
+        const bool working = minuteOfDay >= 8 * 60 && minuteOfDay < 20 * 60;
+        light = (working ? profile.lightPeak : 5) + 100 * sun + 10 * random.normal();
+    }
+
+    if (random.uniform() < options.spikeRate) {
+        temperature += random.uniform(10, 20);
+    }
+    value.temperature = round2(temperature);
+    value.humidity = round2(qBound(5.0, humidity, 100.0));
+    value.light = round2(std::max(0.0, light));
+
+    // 网络传输延迟；少量样本延迟 1~10 个采样间隔才到达，写入时与其他样本乱序
+    sample.arrival = value.timestamp + qint64(random.uniform(50, 2000));
+    if (random.uniform() < options.lateRate) {
+        sample.arrival += qint64(random.uniform(1, 10) * options.intervalMs);
+    }
+    return sample;
+}
+
+FleetGenerator::Slice FleetGenerator::generateSlice(int deviceIndex, qint64 windowStart, qint64 windowEnd) const
+{
+    const Profile& profile = profiles[deviceIndex];
+    Slice slice;
+
+    // 与窗口相交的离线区间（前一天开始的离线可能延续到当天）
+    QVector<QPair<qint64, qint64>> outages;
+    const qint64 firstDay = windowStart / dayMs - 1;
+    const qint64 lastDay = (windowEnd - 1) / dayMs;
+    for (qint64 day = firstDay; day <= lastDay; ++day) {
+        qint64 begin, end;
+        if (!outage(deviceIndex, day, begin, end) || end <= windowStart || begin >= windowEnd || begin < options.startMs) {
+            continue;
+        }
+        outages.append(qMakePair(begin, end));
+        if (begin >= windowStart) {
+            slice.logs.append(QVariantList() << begin << "设备状态" << "WARN"
+                              << QString("设备 %1 离线").arg(profile.deviceId) << QVariant(QVariant::Int) << profile.deviceId);
+        }
+        if (end < windowEnd && end < options.endMs) {
+            slice.logs.append(QVariantList() << end << "设备状态" << "INFO"
+                              << QString("设备 %1 恢复在线，离线 %2 分钟").arg(profile.deviceId).arg((end - begin) / 60000)
+                              << QVariant(QVariant::Int) << profile.deviceId);
+        }
+    }
+
+    // 窗口内的采样序号：名义时刻 startMs + k * intervalMs 落在 [windowStart, windowEnd)
+    const qint64 interval = options.intervalMs;
+    const qint64 firstK = (windowStart - options.startMs + interval - 1) / interval;
+    const qint64 endK = (windowEnd - options.startMs + interval - 1) / interval;
+    slice.samples.reserve(int(endK - firstK));
+    double previous = firstK > 0 ? sampleAt(deviceIndex, firstK - 1).sample.temperature : 0;
+    for (qint64 k = firstK; k < endK; ++k) {
+        const Sample sample = sampleAt(deviceIndex, k);
+        const double temperature = sample.sample.temperature;
+        bool offline = false;
+        for (const QPair<qint64, qint64>& range : outages) {
+            offline = offline || (sample.sample.timestamp >= range.first && sample.sample.timestamp < range.second);
+        }
+        // 告警按温度上穿阈值判断，离线期间不上报也就不产生告警
+        const bool crossed = k > 0 && temperature > profile.alarmThreshold && previous <= profile.alarmThreshold;
+        previous = temperature;
+        if (offline) {
+            continue;
+        }
+        slice.samples.append(sample);
+        if (crossed) {
+            Random random(streamSeed(SampleStream, quint64(deviceIndex), quint64(k)) ^ 0xA1A2);
+            const double roll = random.uniform();
+            const QString content = QString("温度过高：%1℃（阈值 %2℃）").arg(temperature).arg(profile.alarmThreshold);
+            slice.alarms.append(QVariantList() << profile.deviceId << sample.sample.timestamp << content
+                                << (roll < 0.75 ? "resolved" : roll < 0.9 ? "processing" : "unprocessed")
+                                << (roll < 0.75 ? "已现场确认" : ""));
+            slice.logs.append(QVariantList() << sample.arrival << "告警" << "WARN" << content
+                              << QVariant(QVariant::Int) << profile.deviceId);
+        }
+    }
+    return slice;
+}
+
+FleetGenerator::Window FleetGenerator::mergeSlices(const QVector<Slice>& slices) const
+{
+    QVector<Sample> samples;
+    int alarms = 0;
+    int logs = 0;
+    int total = 0;
+    for (const Slice& slice : slices) {
+        total += slice.samples.size();
+        alarms += slice.alarms.size();
+        logs += slice.logs.size();
+    }
+    samples.reserve(total);
+    for (const Slice& slice : slices) {
+        samples += slice.samples;
+    }
+    // 按到达时间写入，模拟采集服务实际收到的顺序；并列时按设备号，保证结果确定
+    std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) {
+        return a.arrival != b.arrival ? a.arrival < b.arrival : a.sample.device_id < b.sample.device_id;
+    });
+
+    Window window;
+    window.samples.reserve(total);
+    for (const Sample& sample : samples) {
+        window.samples.append(sample.sample);
+    }
+    window.alarmColumns.resize(5);
+    window.logColumns.resize(6);
+    for (QVariantList& column : window.alarmColumns) column.reserve(alarms);
+    for (QVariantList& column : window.logColumns) column.reserve(logs);
+    for (const Slice& slice : slices) {
+        for (const QVariantList& row : slice.alarms) {
+            for (int c = 0; c < row.size(); ++c) window.alarmColumns[c] << row[c];
+        }
+        for (const QVariantList& row : slice.logs) {
+            for (int c = 0; c < row.size(); ++c) window.logColumns[c] << row[c];
+        }
+    }
+    return window;
+}
+
+bool FleetGenerator::writeWindow(const Window& window)
+{
+    DatabaseManager& database = DatabaseManager::instance();
+    // 走与采集服务相同的批量写入路径，汇总表随之更新
+    if (!database.addMonitorDataBatch(window.samples)) {
+        error = "写入监测数据失败: " + database.lastError();
+        return false;
+    }
+    QSqlDatabase conn = database.connection();
+    if (!conn.transaction()) {
+        error = "无法开启事务: " + conn.lastError().text();
+        return false;
+    }
+    if (!insertRows("INSERT INTO alarm_records (device_id, timestamp, content, status, note) VALUES (?, ?, ?, ?, ?)",
+                    window.alarmColumns)
+        || !insertRows("INSERT INTO system_logs (timestamp, log_type, log_level, content, user_id, device_id) "
+                       "VALUES (?, ?, ?, ?, ?, ?)", window.logColumns)) {
+        conn.rollback();
+        return false;
+    }
+    if (!conn.commit()) {
+        error = "提交失败: " + conn.lastError().text();
+        conn.rollback();
+        return false;
+    }
+    totals.samples += window.samples.size();
+    totals.alarms += window.alarmColumns.first().size();
+    totals.logs += window.logColumns.first().size();
+    return true;
+}
+
+bool FleetGenerator::insertRows(const char* sql, const QVector<QVariantList>& columns)
+{
+    if (columns.isEmpty() || columns.first().isEmpty()) return true;
+    QSqlQuery query(DatabaseManager::instance().connection());
+    if (!query.prepare(sql)) {
+        error = "写入失败: " + query.lastError().text();
+        return false;
+    }
+    for (const QVariantList& column : columns) {
+        query.addBindValue(column);
+    }
+    if (!query.execBatch()) {
+        error = "写入失败: " + query.lastError().text() + "\nSQL语句: " + sql;
+        return false;
+    }
+    return true;
+}
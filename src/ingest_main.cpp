@@ -0,0 +1,158 @@
+#include "databasemanager.h"
+#include "ingestserver.h"
+#include "metricsserver.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_UNIX
+// 信号处理函数中只能调用异步信号安全的函数：写一个字节到 socketpair，由事件循环中的 QSocketNotifier 读出后退出
+int signalFds[2] = {-1, -1};
+
+void handleSignal(int)
+{
+    const char byte = 1;
+    ssize_t ignored = ::write(signalFds[0], &byte, sizeof(byte));
+    Q_UNUSED(ignored);
+}
+
+bool installQuitHandler(QCoreApplication& app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalFds) != 0) {
+        return false;
+    }
+    QSocketNotifier *notifier = new QSocketNotifier(signalFds[1], QSocketNotifier::Read, &app);
+    QObject::connect(notifier, &QSocketNotifier::activated, &app, [notifier]() {
+        notifier->setEnabled(false);
+        char byte;
+        ssize_t ignored = ::read(signalFds[1], &byte, sizeof(byte));
+        Q_UNUSED(ignored);
+        QCoreApplication::quit();
+    });
+    struct sigaction action = {};
+    action.sa_handler = handleSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return ::sigaction(SIGINT, &action, nullptr) == 0 && ::sigaction(SIGTERM, &action, nullptr) == 0;
+}
+#elif defined(Q_OS_WIN)
+// 控制台事件在系统创建的线程中回调，通过排队调用回到主线程退出
+BOOL WINAPI handleConsoleEvent(DWORD)
+{
+    QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+    return TRUE;
+}
+
+bool installQuitHandler(QCoreApplication&)
+{
+    return SetConsoleCtrlHandler(handleConsoleEvent, TRUE) != 0;
+}
+#else
+bool installQuitHandler(QCoreApplication&)
+{
+    return false;
+}
+#endif
+
+} // namespace
+
+// 无界面的传感器数据采集服务，与界面程序共用同一个数据库文件（WAL 模式下可同时读写）
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("IngestServer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("传感器数据采集服务");
+    parser.addHelpOption();
+    QCommandLineOption dbOption("db", "数据库文件路径（默认当前目录下的 internetmonitoring.db）", "path");
+    QCommandLineOption bindOption("bind", "监听地址", "address", "0.0.0.0");
+    QCommandLineOption tcpOption("tcp-port", "TCP 端口，0 表示不启用", "port", "9500");
+    QCommandLineOption udpOption("udp-port", "UDP 端口，0 表示不启用", "port", "9501");
+    QCommandLineOption batchOption("batch", "每个事务最多写入的条数", "rows", "4096");
+    QCommandLineOption flushOption("flush-ms", "组提交最长等待时间（毫秒）", "ms", "50");
+    QCommandLineOption profileOption("profile", "SQLite 运行参数：" + DatabaseManager::tuningProfileNames().join('/'), "name", "ingest");
+    QCommandLineOption syncOption("sync", "同步级别 full/normal/off，默认取 --profile 的设置；WAL 模式下 normal 掉电时最多丢失最近的事务", "level");
+    QCommandLineOption compactOption("compact", "开启分块存储：定期把一小时前的原始数据压缩进 monitor_chunks");
+    QCommandLineOption maintainOption("maintain", "开启分区维护：按天（UTC）封存 monitor_data/system_logs 并执行保留策略");
+    QCommandLineOption rawDaysOption("raw-days", "原始数据保留天数，0 表示永久保留", "days", "30");
+    QCommandLineOption minuteDaysOption("minute-days", "分钟汇总保留天数，0 表示永久保留", "days", "365");
+    QCommandLineOption logDaysOption("log-days", "系统日志保留天数，0 表示永久保留", "days", "90");
+    QCommandLineOption metricsPortOption("metrics-port", "Prometheus 指标端口（GET /metrics），0 表示不启用", "port", "0");
+    QCommandLineOption metricsBindOption("metrics-bind", "指标服务监听地址", "address", "127.0.0.1");
+    parser.addOptions({dbOption, bindOption, tcpOption, udpOption, batchOption, flushOption, profileOption, syncOption, compactOption,
+                       maintainOption, rawDaysOption, minuteDaysOption, logDaysOption, metricsPortOption, metricsBindOption});
+    parser.process(app);
+
+    DatabaseManager::TuningProfile profile;
+    if (!DatabaseManager::findTuningProfile(parser.value(profileOption), profile)) {
+        qCritical() << "未知的运行参数配置:" << parser.value(profileOption);
+        return -1;
+    }
+    if (parser.isSet(syncOption)) {
+        const QString sync = parser.value(syncOption).toLower();
+        if (sync != "full" && sync != "normal" && sync != "off") {
+            qCritical() << "未知的同步级别:" << sync;
+            return -1;
+        }
+        profile.durability = sync == "full" ? DatabaseManager::DurabilityFull
+                             : sync == "off" ? DatabaseManager::DurabilityOff : DatabaseManager::DurabilityNormal;
+    }
+
+    DatabaseManager& database = DatabaseManager::instance();
+    database.setTuningProfile(profile);
+    if (!database.initDatabase(parser.value(dbOption))) {
+        qCritical() << "数据库初始化失败:" << database.lastError();
+        return -1;
+    }
+    database.setWriteBehind(true, qMax(1, parser.value(batchOption).toInt()), qMax(1, parser.value(flushOption).toInt()));
+    if (parser.isSet(compactOption)) {
+        database.setChunkStorage(true);
+    }
+    if (parser.isSet(maintainOption)) {
+        database.setRetentionPolicy("monitor_data", parser.value(rawDaysOption).toInt());
+        database.setRetentionPolicy("monitor_rollup_1m", parser.value(minuteDaysOption).toInt());
+        database.setRetentionPolicy("system_logs", parser.value(logDaysOption).toInt());
+        database.setPartitionMaintenance(true);
+    }
+
+    IngestServer server;
+    if (!server.listen(QHostAddress(parser.value(bindOption)),
+                       static_cast<quint16>(parser.value(tcpOption).toUInt()),
+                       static_cast<quint16>(parser.value(udpOption).toUInt()))) {
+        database.setWriteBehind(false);
+        return -1;
+    }
+
+    MetricsServer metrics;
+    const quint16 metricsPort = static_cast<quint16>(parser.value(metricsPortOption).toUInt());
+    if (metricsPort != 0 && !metrics.listen(QHostAddress(parser.value(metricsBindOption)), metricsPort)) {
+        database.setWriteBehind(false);
+        return -1;
+    }
+
+    // Ctrl+C / kill 时退出事件循环，写完队列中的数据后再结束
+    if (!installQuitHandler(app)) {
+        qWarning() << "无法注册退出信号处理，Ctrl+C 将直接结束进程";
+    }
+
+    int ret = app.exec();
+    metrics.close();
+    database.setPartitionMaintenance(false);
+    database.setChunkStorage(false);
+    database.flushWrites();
+    const quint64 written = database.writeBehindStats().committed;
+    database.setWriteBehind(false);
+    qInfo() << "采集服务已停止，共写入" << written << "条";
+    return ret;
+}
@@ -0,0 +1,150 @@
+#include "ingestserver.h"
+#include "sensorprotocol.h"
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+const int DeviceReloadIntervalMs = 30000;   // 定期刷新设备表
+const int UnknownDeviceRetryMs = 5000;      // 遇到未知设备时最快的刷新间隔
+const int StatsIntervalMs = 10000;
+const int MaxTcpBuffer = 4 * 1024 * 1024;   // 单个连接未处理数据上限
+}
+
+IngestServer::IngestServer(QObject *parent)
+    : QObject(parent), received(0), malformedCount(0), unknownDeviceCount(0), lastWritten(0)
+{
+    connect(&tcpServer, &QTcpServer::newConnection, this, &IngestServer::onNewConnection);
+    connect(&udpSocket, &QUdpSocket::readyRead, this, &IngestServer::onUdpReadyRead);
+    connect(&deviceTimer, &QTimer::timeout, this, &IngestServer::reloadDevices);
+    connect(&statsTimer, &QTimer::timeout, this, &IngestServer::printStats);
+}
+
+bool IngestServer::listen(const QHostAddress& address, quint16 tcpPort, quint16 udpPort)
+{
+    reloadDevices();
+
+    if (tcpPort && !tcpServer.listen(address, tcpPort)) {
+        qCritical() << "TCP 端口监听失败:" << tcpPort << tcpServer.errorString();
+        return false;
+    }
+    if (udpPort && !udpSocket.bind(address, udpPort)) {
+        qCritical() << "UDP 端口绑定失败:" << udpPort << udpSocket.errorString();
+        return false;
+    }
+    // 突发流量时避免内核丢弃 UDP 数据报
+    udpSocket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 8 * 1024 * 1024);
+
+    deviceTimer.start(DeviceReloadIntervalMs);
+    statsTimer.start(StatsIntervalMs);
+    qInfo() << "采集服务已启动 TCP:" << tcpPort << "UDP:" << udpPort << "已知设备:" << knownDevices.size();
+    return true;
+}
+
+void IngestServer::reloadDevices()
+{
+    DatabaseManager::instance().invalidateDeviceCache();
+    QSet<int> devices;
+    const QVariantList list = DatabaseManager::instance().getDevices();
+    for (const QVariant& device : list) {
+        devices.insert(device.toMap().value("device_id").toInt());
+    }
+    knownDevices.swap(devices);
+    deviceReloadClock.start();
+}
+
+void IngestServer::onNewConnection()
+{
+    while (QTcpSocket *socket = tcpServer.nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        buffers.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readTcp(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            readTcp(socket);
+            buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void IngestServer::readTcp(QTcpSocket *socket)
+{
+    auto it = buffers.find(socket);
+    if (it == buffers.end()) return;
+
+    QByteArray& buffer = it.value();
+    buffer.append(socket->readAll());
+
+    int malformed = 0;
+    parsed.clear();
+    SensorProtocol::parse(buffer, parsed, false, &malformed);
+    if (buffer.size() > MaxTcpBuffer) {
+        // 对端持续发送无法解析的数据
+        qWarning() << "连接数据无法解析，断开:" << socket->peerAddress().toString();
+        buffer.clear();
+        socket->abort();
+        ++malformed;
+    }
+    accept(parsed, malformed);
+}
+
+void IngestServer::onUdpReadyRead()
+{
+    QByteArray datagram;
+    int malformed = 0;
+    parsed.clear();
+    while (udpSocket.hasPendingDatagrams()) {
+        datagram.resize(static_cast<int>(udpSocket.pendingDatagramSize()));
+        const qint64 size = udpSocket.readDatagram(datagram.data(), datagram.size());
+        if (size <= 0) continue;
+        datagram.resize(static_cast<int>(size));
+        // 每个数据报自成一体，末尾不完整的内容不会等到下一个数据报
+        SensorProtocol::parse(datagram, parsed, true, &malformed);
+    }
+    accept(parsed, malformed);
+}
+
+void IngestServer::accept(QVector<MonitorSample>& samples, int malformed)
+{
+    malformedCount += malformed;
+    if (samples.isEmpty()) return;
+    received += samples.size();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int kept = 0;
+    bool sawUnknown = false;
+    for (int i = 0; i < samples.size(); ++i) {
+        MonitorSample& sample = samples[i];
+        if (!knownDevices.contains(sample.device_id)) {
+            sawUnknown = true;
+            continue;
+        }
+        if (sample.timestamp <= 0) {
+            sample.timestamp = now;
+        }
+        if (kept != i) {
+            samples[kept] = sample;
+        }
+        ++kept;
+    }
+    unknownDeviceCount += samples.size() - kept;
+    samples.resize(kept);
+
+    if (!samples.isEmpty()) {
+        DatabaseManager::instance().addMonitorDataBatch(samples);
+    }
+    // 可能是刚在界面中新增的设备，稍后重新读取设备表
+    if (sawUnknown && deviceReloadClock.elapsed() > UnknownDeviceRetryMs) {
+        reloadDevices();
+    }
+}
+
+void IngestServer::printStats()
+{
+    const DatabaseManager::WriteBehindStats stats = DatabaseManager::instance().writeBehindStats();
+    const double rate = (stats.committed - lastWritten) * 1000.0 / StatsIntervalMs;
+    lastWritten = stats.committed;
+    qInfo().noquote() << QString("收到 %1，写入 %2 (%3 条/秒，%4 个事务)，排队 %5，失败 %6，丢弃 %7，格式错误 %8，未知设备 %9，连接 %10")
+                         .arg(received).arg(stats.committed).arg(rate, 0, 'f', 0).arg(stats.transactions)
+                         .arg(stats.pending).arg(stats.failed).arg(stats.dropped).arg(malformedCount)
+                         .arg(unknownDeviceCount).arg(buffers.size());
+}
@@ -0,0 +1,214 @@
+#include "keysettablemodel.h"
+#include "databasemanager.h"
+#include "querystats.h"
+#include <QSqlError>
+#include <QDebug>
+
+KeysetTableModel::KeysetTableModel(QObject *parent)
+    : QAbstractTableModel(parent), order(Qt::AscendingOrder), lastKey(0), rows(0), atEnd(true),
+      fetching(false)
+{
+}
+
+void KeysetTableModel::setQuery(const QString& table, const QString& keyColumn, const QStringList& columns,
+                                const QStringList& headers, Qt::SortOrder order)
+{
+    this->table = table;
+    this->keyColumn = keyColumn;
+    this->columns = columns;
+    this->headers = headers;
+    this->order = order;
+    refresh();
+}
+
+void KeysetTableModel::refresh()
+{
+    beginResetModel();
+    pageFirstKeys.clear();
+    pages.clear();
+    recentPages.clear();
+    reloadingPages.clear();
+    lastKey = 0;
+    rows = 0;
+    atEnd = table.isEmpty();
+    fetching = false;
+    generation = queries.next();
+    endResetModel();
+
+    // 先读第一页，视图再按需调用 fetchMore
+    if (!atEnd) {
+        fetchMore(QModelIndex());
+    }
+}
+
+int KeysetTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+int KeysetTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : columns.size();
+}
+
+QVariant KeysetTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::UserRole)) {
+        return QVariant();
+    }
+    const PageRows* rowsOfPage = page(index.row() / PageSize);
+    const int offset = index.row() % PageSize;
+    // 页被重新读取时若期间有行被删除，末尾可能不足一页；正在重新读取的页暂时为空
+    if (!rowsOfPage || offset >= rowsOfPage->size()) {
+        return QVariant();
+    }
+    const QVariant& value = rowsOfPage->at(offset).value(index.column());
+    return role == Qt::UserRole ? value : QVariant(value.toString());
+}
+
+QVariant KeysetTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Horizontal) {
+        return headers.value(section);
+    }
+    return section + 1;
+}
+
+bool KeysetTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !atEnd;
+}
+
+void KeysetTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || atEnd || fetching) return;
+    fetching = true;
+
+    const QString table = this->table;
+    const bool bounded = !pageFirstKeys.isEmpty();
+    const QString sql = pageSql(bounded, false);
+    const qint64 bound = lastKey;
+    const int columnCount = columns.size();
+    AsyncQueryExecutor::instance().submit<PageResult>(this, generation,
+        [table, sql, bounded, bound, columnCount]() { return queryPage(table, sql, bounded, bound, columnCount); },
+        [this](const PageResult& result) { appendPage(result); });
+}
+
+void KeysetTableModel::appendPage(const PageResult& result)
+{
+    fetching = false;
+    const PageRows& fetched = result.rows;
+    if (!result.ok || fetched.size() < PageSize) {
+        atEnd = true;
+    }
+    if (fetched.isEmpty()) return;
+
+    const int index = pageFirstKeys.size();
+    pageFirstKeys.append(fetched.first().at(0).toLongLong());
+    lastKey = fetched.last().at(0).toLongLong();
+
+    beginInsertRows(QModelIndex(), rows, rows + fetched.size() - 1);
+    rows += fetched.size();
+    cachePage(index, fetched);
+    endInsertRows();
+}
+
+QString KeysetTableModel::fullSql() const
+{
+    if (table.isEmpty()) return QString();
+    return QString("SELECT %1 FROM %2 ORDER BY %3 %4").arg(columns.join(", "), table, keyColumn,
+                                                          order == Qt::DescendingOrder ? "DESC" : "ASC");
+}
+
+QString KeysetTableModel::pageSql(bool bounded, bool inclusive) const
+{
+    const bool desc = (order == Qt::DescendingOrder);
+    QString sql = QString("SELECT %1 FROM %2").arg(columns.join(", "), table);
+    if (bounded) {
+        const char* op = desc ? (inclusive ? "<=" : "<") : (inclusive ? ">=" : ">");
+        sql += QString(" WHERE %1 %2 ?").arg(keyColumn, QString::fromLatin1(op));
+    }
+    sql += QString(" ORDER BY %1 %2 LIMIT %3").arg(keyColumn, desc ? "DESC" : "ASC").arg(PageSize);
+    return sql;
+}
+
+KeysetTableModel::PageResult KeysetTableModel::queryPage(const QString& table, const QString& sql, bool bounded,
+                                                         qint64 bound, int columnCount)
+{
+    PageResult result;
+    // 与 DatabaseManager 内部的查询一样计入查询统计，并复用该线程连接上缓存的预编译语句
+    DatabaseManager& database = DatabaseManager::instance();
+    InstrumentedQuery query(database.connection(), database.statements());
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    if (bounded) {
+        query.addBindValue(bound);
+    }
+    if (!query.exec()) {
+        qDebug() << "读取表数据失败:" << table << query.lastError().text();
+        return result;
+    }
+    result.rows.reserve(PageSize);
+    while (query.next()) {
+        QVariantList row;
+        row.reserve(columnCount);
+        for (int col = 0; col < columnCount; ++col) {
+            row.append(query.value(col));
+        }
+        result.rows.append(row);
+    }
+    result.ok = true;
+    return result;
+}
+
+const KeysetTableModel::PageRows* KeysetTableModel::page(int index) const
+{
+    auto it = pages.constFind(index);
+    if (it != pages.constEnd()) {
+        if (recentPages.first() != index) {
+            recentPages.removeOne(index);
+            recentPages.prepend(index);
+        }
+        return &it.value();
+    }
+    if (index < 0 || index >= pageFirstKeys.size() || reloadingPages.contains(index)) {
+        return nullptr;
+    }
+
+    // 已被淘汰的页：从该页首行主键开始重新读取一页，返回后通知视图刷新这些行
+    reloadingPages.insert(index);
+    KeysetTableModel* self = const_cast<KeysetTableModel*>(this);
+    const QString table = this->table;
+    const QString sql = pageSql(true, true);
+    const qint64 bound = pageFirstKeys.at(index);
+    const int columnCount = columns.size();
+    AsyncQueryExecutor::instance().submit<PageResult>(self, generation,
+        [table, sql, bound, columnCount]() { return queryPage(table, sql, true, bound, columnCount); },
+        [self, index](const PageResult& result) { self->reloadPage(index, result); });
+    return nullptr;
+}
+
+void KeysetTableModel::reloadPage(int index, const PageResult& result)
+{
+    reloadingPages.remove(index);
+    if (!result.ok) return;
+    cachePage(index, result.rows);
+    const int first = index * PageSize;
+    const int last = qMin(rows, first + PageSize) - 1;
+    if (first <= last) {
+        emit dataChanged(this->index(first, 0), this->index(last, columns.size() - 1));
+    }
+}
+
+void KeysetTableModel::cachePage(int index, const PageRows& rowsOfPage) const
+{
+    pages.insert(index, rowsOfPage);
+    recentPages.removeOne(index);
+    recentPages.prepend(index);
+    while (recentPages.size() > MaxCachedPages) {
+        pages.remove(recentPages.takeLast());
+    }
+}
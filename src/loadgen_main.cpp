@@ -0,0 +1,40 @@
+#include "loadgenerator.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+// IngestServer 压测工具：设备编号需已在 devices 表中存在，否则会被采集服务拒绝
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("LoadGenerator");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("模拟多台传感器向采集服务发送数据");
+    parser.addHelpOption();
+    QCommandLineOption hostOption("host", "采集服务地址", "address", "127.0.0.1");
+    QCommandLineOption portOption("port", "采集服务端口", "port", "9500");
+    QCommandLineOption udpOption("udp", "使用 UDP 发送（端口通常为 9501）");
+    QCommandLineOption binaryOption("binary", "使用二进制协议");
+    QCommandLineOption devicesOption("devices", "模拟的设备数", "n", "100");
+    QCommandLineOption firstOption("first-device", "第一台设备的编号", "id", "1");
+    QCommandLineOption rateOption("rate", "每台设备每秒发送条数", "n", "10");
+    QCommandLineOption durationOption("duration", "运行秒数，0 表示一直运行", "sec", "60");
+    parser.addOptions({hostOption, portOption, udpOption, binaryOption, devicesOption,
+                       firstOption, rateOption, durationOption});
+    parser.process(app);
+
+    LoadGenerator::Options options;
+    options.host = parser.value(hostOption);
+    options.port = static_cast<quint16>(parser.value(portOption).toUInt());
+    options.udp = parser.isSet(udpOption);
+    options.binary = parser.isSet(binaryOption);
+    options.devices = qMax(1, parser.value(devicesOption).toInt());
+    options.firstDevice = qMax(1, parser.value(firstOption).toInt());
+    options.rate = qMax(0.0, parser.value(rateOption).toDouble());
+    options.durationSec = qMax(0, parser.value(durationOption).toInt());
+
+    LoadGenerator generator(options);
+    QObject::connect(&generator, &LoadGenerator::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+    generator.start();
+    return app.exec();
+}
@@ -0,0 +1,139 @@
+#include "loadgenerator.h"
+#include "sensorprotocol.h"
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+const int TickMs = 10;
+const qint64 MaxTcpBacklog = 8 * 1024 * 1024;  // 发送缓冲超过该值时暂停生成
+const int MaxDatagramSize = 1400;              // 不超过常见 MTU，避免 IP 分片
+}
+
+LoadGenerator::LoadGenerator(const Options& options, QObject *parent)
+    : QObject(parent), options(options), sent(0), skipped(0), lastReportMs(0), lastReportSent(0),
+      nextDevice(0), random(std::random_device()())
+{
+    state.resize(qMax(1, options.devices));
+    std::uniform_real_distribution<double> temperature(15, 30), humidity(30, 70), light(100, 800);
+    for (int i = 0; i < state.size(); ++i) {
+        state[i].device_id = options.firstDevice + i;
+        state[i].temperature = temperature(random);
+        state[i].humidity = humidity(random);
+        state[i].light = light(random);
+    }
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &LoadGenerator::tick);
+}
+
+void LoadGenerator::start()
+{
+    address = QHostAddress(options.host);
+    if (!options.udp) {
+        tcpSocket.connectToHost(options.host, options.port);
+        if (!tcpSocket.waitForConnected(5000)) {
+            qCritical() << "无法连接采集服务:" << tcpSocket.errorString();
+            emit finished();
+            return;
+        }
+        tcpSocket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    }
+    qInfo() << "开始发送:" << state.size() << "台设备，每台" << options.rate << "条/秒，"
+            << (options.udp ? "UDP" : "TCP") << (options.binary ? "二进制" : "文本");
+    clock.start();
+    timer.start(TickMs);
+}
+
+void LoadGenerator::tick()
+{
+    const qint64 elapsed = clock.elapsed();
+    if (options.durationSec > 0 && elapsed >= options.durationSec * 1000LL) {
+        timer.stop();
+        if (!options.udp) {
+            tcpSocket.flush();
+            tcpSocket.waitForBytesWritten(5000);
+            tcpSocket.disconnectFromHost();
+        }
+        report(true);
+        emit finished();
+        return;
+    }
+
+    // 按经过的时间计算应发送的总数，定时器抖动不会累积误差
+    const qint64 due = static_cast<qint64>(elapsed * options.rate * state.size() / 1000.0) - sent - skipped;
+    if (due > 0) {
+        if (!options.udp && tcpSocket.bytesToWrite() > MaxTcpBacklog) {
+            skipped += due;
+        } else {
+            const qint64 now = QDateTime::currentMSecsSinceEpoch();
+            std::normal_distribution<double> step(0, 0.1);
+            QVector<MonitorSample> samples;
+            samples.reserve(static_cast<int>(due));
+            for (qint64 i = 0; i < due; ++i) {
+                MonitorSample& device = state[nextDevice];
+                nextDevice = (nextDevice + 1) % state.size();
+                device.timestamp = now;
+                device.temperature += step(random);
+                device.humidity = qBound(0.0, device.humidity + step(random), 100.0);
+                device.light = qMax(0.0, device.light + step(random) * 10);
+                samples.append(device);
+            }
+            send(samples);
+            sent += due;
+        }
+    }
+
+    if (elapsed - lastReportMs >= 5000) {
+        report(false);
+    }
+}
+
+void LoadGenerator::send(const QVector<MonitorSample>& samples)
+{
+    if (!options.udp) {
+        QByteArray payload;
+        if (options.binary) {
+            SensorProtocol::appendBinary(payload, samples.constData(), samples.size());
+        } else {
+            for (const MonitorSample& sample : samples) {
+                SensorProtocol::appendLine(payload, sample);
+            }
+        }
+        tcpSocket.write(payload);
+        return;
+    }
+
+    // UDP：按数据报大小切分，每个数据报都是完整的消息
+    const int perDatagram = options.binary
+        ? (MaxDatagramSize - SensorProtocol::BinaryHeaderSize) / SensorProtocol::BinaryRecordSize
+        : 0;
+    QByteArray datagram;
+    for (int i = 0; i < samples.size();) {
+        datagram.clear();
+        if (options.binary) {
+            const int n = qMin(perDatagram, samples.size() - i);
+            SensorProtocol::appendBinary(datagram, samples.constData() + i, n);
+            i += n;
+        } else {
+            while (i < samples.size() && datagram.size() < MaxDatagramSize - SensorProtocol::MaxLineLength) {
+                SensorProtocol::appendLine(datagram, samples.at(i++));
+            }
+        }
+        udpSocket.writeDatagram(datagram, address, options.port);
+    }
+}
+
+void LoadGenerator::report(bool final)
+{
+    const qint64 elapsed = qMax<qint64>(1, clock.elapsed());
+    const qint64 interval = qMax<qint64>(1, elapsed - lastReportMs);
+    if (final) {
+        qInfo().noquote() << QString("共发送 %1 条，用时 %2 秒，平均 %3 条/秒，因积压少发 %4 条")
+                             .arg(sent).arg(elapsed / 1000.0, 0, 'f', 1)
+                             .arg(sent * 1000.0 / elapsed, 0, 'f', 0).arg(skipped);
+    } else {
+        qInfo().noquote() << QString("已发送 %1 条，当前 %2 条/秒")
+                             .arg(sent).arg((sent - lastReportSent) * 1000.0 / interval, 0, 'f', 0);
+    }
+    lastReportMs = elapsed;
+    lastReportSent = sent;
+}
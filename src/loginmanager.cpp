@@ -8,6 +8,8 @@
 #include <QTimer>
 #include <QDateTime>
 
+QAtomicInt LoginManager::activeSessions;
+
 LoginManager::LoginManager(QObject *parent)
     : QObject(parent), loginAttempts(0), sessionTimer(new QTimer(this)),
       sessionTimeoutMinutes(DEFAULT_SESSION_TIMEOUT), sessionWarningEmitted(false)
@@ -19,6 +21,7 @@ LoginManager::LoginManager(QObject *parent)
 
 LoginManager::~LoginManager()
 {
+    if (isLoggedIn()) activeSessions.deref();
     sessionTimer->stop();
     delete sessionTimer;
 }
@@ -164,6 +167,7 @@ void LoginManager::handleLogin(const QString& username, const QString& password)
     int user_id;
     QString role;
     if (DatabaseManager::instance().verifyUser(username, password, user_id, role)) {
+        if (!isLoggedIn()) activeSessions.ref();
         currentUsername = username;
         currentUserRole = role;
         resetSessionTimer();
@@ -273,6 +277,7 @@ void LoginManager::logout()
         if (DatabaseManager::instance().getUserIdByUsername(currentUsername, user_id)) {
             DatabaseManager::instance().addLog("登出", "INFO", QString("用户 %1 登出系统").arg(currentUsername), user_id);
         }
+        activeSessions.deref();
     }
     currentUsername.clear();
     currentUserRole.clear();
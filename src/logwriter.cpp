@@ -0,0 +1,133 @@
+#include "logwriter.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+LogWriter::LogWriter(const CommitFunction& commit, int capacity, int flushIntervalMs, QObject *parent)
+    : QThread(parent), commit(commit), flushIntervalMs(qMax(1, flushIntervalMs)), capacity(2),
+      enqueuePos(0), dequeuePos(0), flushedPos(0), flushRequests(0), stopping(false),
+      written(0), failed(0), dropped(0)
+{
+    while (this->capacity < static_cast<quint64>(qMax(2, capacity))) {
+        this->capacity <<= 1;
+    }
+    mask = this->capacity - 1;
+    ring.reset(new Cell[this->capacity]);
+    for (quint64 i = 0; i < this->capacity; ++i) {
+        ring[i].sequence.storeRelease(i);
+    }
+}
+
+LogWriter::~LogWriter()
+{
+    stop();
+}
+
+bool LogWriter::append(const LogEntry& entry)
+{
+    // 先抢占一个空闲位置，再填入内容并发布；抢到的位置只属于当前线程
+    quint64 pos = enqueuePos.loadAcquire();
+    Cell *cell;
+    forever {
+        cell = &ring[pos & mask];
+        const qint64 diff = static_cast<qint64>(cell->sequence.loadAcquire() - pos);
+        if (diff == 0) {
+            if (enqueuePos.testAndSetOrdered(pos, pos + 1)) break;
+            pos = enqueuePos.loadAcquire();
+        } else if (diff < 0) {
+            // 后台线程还没取走一整圈之前的日志：缓冲已满
+            dropped.fetchAndAddOrdered(1);
+            return false;
+        } else {
+            pos = enqueuePos.loadAcquire();
+        }
+    }
+    cell->entry = entry;
+    cell->sequence.storeRelease(pos + 1);
+
+    // 写满一半时提前唤醒后台线程，其余情况等定时刷新
+    if (((pos + 1) & (mask >> 1)) == 0) {
+        QMutexLocker locker(&mutex);
+        wakeup.wakeOne();
+    }
+    return true;
+}
+
+bool LogWriter::flush(int timeoutMs)
+{
+    if (QThread::currentThread() == this || !isRunning()) {
+        return true;
+    }
+    const quint64 target = enqueuePos.loadAcquire();
+    QElapsedTimer timer;
+    timer.start();
+    QMutexLocker locker(&mutex);
+    ++flushRequests;
+    wakeup.wakeOne();
+    bool done = true;
+    while (flushedPos.loadAcquire() < target) {
+        if (timeoutMs < 0) {
+            flushed.wait(&mutex);
+            continue;
+        }
+        const qint64 remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0 || !flushed.wait(&mutex, static_cast<unsigned long>(remaining))) {
+            done = flushedPos.loadAcquire() >= target;
+            break;
+        }
+    }
+    --flushRequests;
+    return done;
+}
+
+void LogWriter::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        wakeup.wakeOne();
+    }
+    wait();
+}
+
+bool LogWriter::hasPending() const
+{
+    return ring[dequeuePos & mask].sequence.loadAcquire() == dequeuePos + 1;
+}
+
+void LogWriter::drain(QVector<LogEntry>& batch)
+{
+    while (hasPending()) {
+        Cell& cell = ring[dequeuePos & mask];
+        batch.append(cell.entry);
+        cell.entry = LogEntry();   // 及时释放字符串
+        cell.sequence.storeRelease(dequeuePos + capacity);
+        ++dequeuePos;
+    }
+}
+
+void LogWriter::run()
+{
+    QVector<LogEntry> batch;
+    batch.reserve(static_cast<int>(capacity));
+    forever {
+        drain(batch);
+        if (!batch.isEmpty()) {
+            if (commit(batch)) {
+                written.fetchAndAddOrdered(batch.size());
+            } else {
+                failed.fetchAndAddOrdered(batch.size());
+            }
+            batch.clear();
+        }
+
+        QMutexLocker locker(&mutex);
+        flushedPos.storeRelease(dequeuePos);
+        flushed.wakeAll();
+        // 已抢占位置但尚未发布的日志也要等它写完
+        const bool idle = enqueuePos.loadAcquire() == dequeuePos;
+        if (stopping && idle) break;
+        if (!hasPending() && !stopping && (flushRequests == 0 || idle)) {
+            wakeup.wait(&mutex, static_cast<unsigned long>(flushIntervalMs));
+        }
+    }
+}
@@ -1,17 +1,43 @@
 #include "mainwindow.h"
 #include "databasemanager.h"
+#include "metricsserver.h"
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QDebug>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    // 可选的 Prometheus 指标端点：--metrics-port 9464（只监听本机，可用 --metrics-bind 修改）
+    // --profile 选择 SQLite 运行参数（见 DatabaseManager::findTuningProfile）
+    QCommandLineParser parser;
+    QCommandLineOption metricsPortOption("metrics-port", "指标服务端口，0 表示不启用", "port", "0");
+    QCommandLineOption metricsBindOption("metrics-bind", "指标服务监听地址", "address", "127.0.0.1");
+    QCommandLineOption profileOption("profile", "SQLite 运行参数配置", "name", "interactive");
+    parser.addOptions({metricsPortOption, metricsBindOption, profileOption});
+    parser.parse(QCoreApplication::arguments());
+
+    DatabaseManager::TuningProfile profile;
+    if (!DatabaseManager::findTuningProfile(parser.value(profileOption), profile)) {
+        qDebug() << "未知的运行参数配置:" << parser.value(profileOption);
+        DatabaseManager::findTuningProfile("interactive", profile);
+    }
+    DatabaseManager::instance().setTuningProfile(profile);
+
     // 初始化数据库
     if (!DatabaseManager::instance().initDatabase()) {
         qDebug() << "数据库初始化失败!";
         return -1;
     }
+    // 采集服务（IngestServer）在独立进程中写入，界面据此刷新实时数据
+    DatabaseManager::instance().watchExternalChanges(1000);
+
+    MetricsServer metrics;
+    const quint16 metricsPort = static_cast<quint16>(parser.value(metricsPortOption).toUInt());
+    if (metricsPort != 0) {
+        metrics.listen(QHostAddress(parser.value(metricsBindOption)), metricsPort);
+    }
 
     // 检查并创建初始管理员账户
     int admin_id;
@@ -33,5 +59,8 @@ int main(int argc, char *argv[])
 
     MainWindow w;
     w.show();
-    return a.exec();
+    int ret = a.exec();
+    // 系统日志由后台线程批量写入，退出前写完缓冲中的日志
+    DatabaseManager::instance().flushLogs(3000);
+    return ret;
 }
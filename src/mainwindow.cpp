@@ -4,12 +4,19 @@
 #include <QRegularExpressionValidator>
 #include <QApplication>
 #include <QIcon>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDebug>
+#include <QLoggingCategory>
 #include "loginmanager.h"
 #include "adminwindow.h"
 #include "userwindow.h"
 #include "registerwindow.h"
 #include "forgetpasswordwindow.h"
 
+// 启动耗时日志，默认关闭；QT_LOGGING_RULES="internetmonitoring.startup.debug=true" 开启
+Q_LOGGING_CATEGORY(lcStartup, "internetmonitoring.startup", QtInfoMsg)
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
@@ -255,9 +262,18 @@ void MainWindow::onLoginSuccess(bool isAdmin)
             adminWindow->close();
             delete adminWindow;
         }
+        // 记录从登录成功到管理员窗口首次绘制完成的耗时
+        QElapsedTimer startup;
+        startup.start();
         adminWindow = new AdminWindow(currentUsername, this);
         connect(adminWindow, &AdminWindow::windowClosed, this, &MainWindow::showLoginWindow);
         adminWindow->show();
+        if (lcStartup().isDebugEnabled()) {
+            const qint64 constructed = startup.elapsed();
+            QTimer::singleShot(0, this, [startup, constructed]() {
+                qCDebug(lcStartup) << "管理员窗口启动耗时" << startup.elapsed() << "ms（构造" << constructed << "ms）";
+            });
+        }
     } else {
         if (!userWindow) {
             userWindow = new UserWindow(currentUsername);
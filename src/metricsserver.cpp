@@ -0,0 +1,357 @@
+#include "metricsserver.h"
+#include "databasemanager.h"
+#include "loginmanager.h"
+#include "statementcache.h"
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QSqlQuery>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+const int lagProbeIntervalMs = 100;
+const int maxRequestBytes = 8192;
+const int requestTimeoutMs = 5000;
+
+// 直方图上界（微秒），与 Prometheus 默认的秒级分桶相近并向下延伸到 0.1 ms
+const QVector<quint64> latencyBoundsMicros = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000
+};
+
+QByteArray escapeLabel(const QString& value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+
+QByteArray number(double value)
+{
+    return QByteArray::number(value, 'g', 12);
+}
+
+// Prometheus 文本格式（0.0.4）
+class Exposition
+{
+public:
+    void family(const char* name, const char* type, const char* help)
+    {
+        text += QByteArray("# HELP ") + name + ' ' + help + "\n# TYPE " + name + ' ' + type + '\n';
+    }
+    void sample(const QByteArray& name, const QByteArray& value, const QByteArray& labels = QByteArray())
+    {
+        text += name;
+        if (!labels.isEmpty()) text += '{' + labels + '}';
+        text += ' ' + value + '\n';
+    }
+    void sample(const QByteArray& name, quint64 value, const QByteArray& labels = QByteArray())
+    {
+        sample(name, QByteArray::number(value), labels);
+    }
+    // counts 为各上界的累计次数，总次数作为 +Inf 桶，sumMicros 为记录值之和
+    void histogram(const QByteArray& name, const QVector<quint64>& counts, quint64 total, quint64 sumMicros,
+                   const QByteArray& labels = QByteArray())
+    {
+        const QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ',';
+        for (int i = 0; i < latencyBoundsMicros.size(); ++i) {
+            sample(name + "_bucket", counts.value(i),
+                   prefix + "le=\"" + number(latencyBoundsMicros.at(i) / 1e6) + '"');
+        }
+        sample(name + "_bucket", total, prefix + "le=\"+Inf\"");
+        sample(name + "_sum", number(sumMicros / 1e6), labels);
+        sample(name + "_count", total, labels);
+    }
+    void histogram(const QByteArray& name, const LatencyHistogram& source)
+    {
+        QVector<quint64> counts;
+        const quint64 total = source.cumulativeCounts(latencyBoundsMicros, counts);
+        histogram(name, counts, total, source.sum());
+    }
+
+    QByteArray text;
+};
+
+QByteArray label(const char* key, const QString& value)
+{
+    return QByteArray(key) + "=\"" + escapeLabel(value) + '"';
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent), thread(nullptr), server(nullptr)
+{
+    lagTimer.setInterval(lagProbeIntervalMs);
+    connect(&lagTimer, &QTimer::timeout, this, &MetricsServer::probeEventLoop);
+}
+
+MetricsServer::~MetricsServer()
+{
+    close();
+}
+
+LatencyHistogram& MetricsServer::uiFrameTimes()
+{
+    static LatencyHistogram histogram;
+    return histogram;
+}
+
+bool MetricsServer::listen(const QHostAddress& address, quint16 port)
+{
+    close();
+    thread = new QThread;
+    thread->setObjectName("MetricsServer");
+    server = new QTcpServer;
+    server->moveToThread(thread);
+    // 以 server 为接收者，连接处理和序列化都在 thread 中执行
+    connect(server, &QTcpServer::newConnection, server, [this]() {
+        while (QTcpSocket* socket = server->nextPendingConnection()) {
+            handleConnection(socket);
+        }
+    });
+    thread->start();
+
+    bool ok = false;
+    QString error;
+    QMetaObject::invokeMethod(server, [&]() {
+        ok = server->listen(address, port);
+        if (!ok) error = server->errorString();
+    }, Qt::BlockingQueuedConnection);
+    if (!ok) {
+        qWarning() << "指标服务监听失败:" << error;
+        close();
+        return false;
+    }
+    lagClock.start();
+    lagTimer.start();
+    qInfo().noquote() << QString("指标服务已启动: http://%1:%2/metrics").arg(address.toString()).arg(port);
+    return true;
+}
+
+void MetricsServer::close()
+{
+    lagTimer.stop();
+    if (!thread) return;
+    QMetaObject::invokeMethod(server, [this]() { server->close(); }, Qt::BlockingQueuedConnection);
+    thread->quit();
+    thread->wait();
+    // 线程已结束，未关闭的连接作为 server 的子对象一并删除
+    delete server;
+    server = nullptr;
+    delete thread;
+    thread = nullptr;
+}
+
+void MetricsServer::probeEventLoop()
+{
+    const qint64 elapsedMicros = lagClock.nsecsElapsed() / 1000;
+    lagClock.restart();
+    eventLoopLag.record(quint64(qMax<qint64>(0, elapsedMicros - lagProbeIntervalMs * 1000LL)));
+}
+
+void MetricsServer::handleConnection(QTcpSocket *socket)
+{
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    QTimer::singleShot(requestTimeoutMs, socket, &QTcpSocket::abort);
+    connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+        if (socket->property("answered").toBool()) {
+            socket->readAll();
+            return;
+        }
+        const QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+        // 只需要请求行，收到完整的请求头（或超过上限）就回应
+        if (request.contains("\r\n\r\n") || request.contains("\n\n") || request.size() > maxRequestBytes) {
+            socket->setProperty("answered", true);
+            respond(socket, request);
+        } else {
+            socket->setProperty("request", request);
+        }
+    });
+}
+
+void MetricsServer::respond(QTcpSocket *socket, const QByteArray& request)
+{
+    const QList<QByteArray> requestLine = request.left(request.indexOf('\n')).trimmed().split(' ');
+    const QByteArray method = requestLine.value(0);
+    const QByteArray path = requestLine.value(1).split('?').value(0);
+
+    QByteArray status = "200 OK";
+    QByteArray contentType = "text/plain; version=0.0.4; charset=utf-8";
+    QByteArray body;
+    if (method != "GET" && method != "HEAD") {
+        status = "405 Method Not Allowed";
+        contentType = "text/plain; charset=utf-8";
+        body = "method not allowed\n";
+    } else if (path == "/metrics") {
+        body = render();
+    } else {
+        status = "404 Not Found";
+        contentType = "text/plain; charset=utf-8";
+        body = "see /metrics\n";
+    }
+
+    QByteArray response = "HTTP/1.1 " + status + "\r\n"
+                          "Content-Type: " + contentType + "\r\n"
+                          "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                          "Connection: close\r\n\r\n";
+    if (method != "HEAD") response += body;
+    socket->write(response);
+    // 写完缓冲区后关闭
+    socket->disconnectFromHost();
+}
+
+void MetricsServer::refreshRowCounts()
+{
+    // 调用方持有 rowCountMutex
+    if (rowCountAge.isValid() && rowCountAge.elapsed() < RowCountCacheMs) return;
+    static const QRegularExpression sealedPartition("_p\\d{8}$");
+
+    QSqlDatabase conn = DatabaseManager::instance().connection();
+    QSqlQuery query(conn);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%' ORDER BY name")) {
+        return;
+    }
+    QStringList tables;
+    while (query.next()) {
+        tables << query.value(0).toString();
+    }
+
+    QHash<QString, qint64> counts;
+    QHash<QString, qint64> sealed;
+    for (const QString& table : tables) {
+        const bool isSealed = sealedPartition.match(table).hasMatch();
+        if (isSealed && sealedRowCounts.contains(table)) {
+            sealed.insert(table, sealedRowCounts.value(table));
+            continue;
+        }
+        QSqlQuery count(conn);
+        if (!count.exec(QString("SELECT COUNT(*) FROM \"%1\"").arg(table)) || !count.next()) continue;
+        if (isSealed) {
+            sealed.insert(table, count.value(0).toLongLong());
+        } else {
+            counts.insert(table, count.value(0).toLongLong());
+        }
+    }
+    // 已被保留策略删除的分区随之移除
+    sealedRowCounts.swap(sealed);
+    rowCounts.swap(counts);
+    rowCountAge.start();
+}
+
+QByteArray MetricsServer::render()
+{
+    QElapsedTimer clock;
+    clock.start();
+    DatabaseManager& database = DatabaseManager::instance();
+    Exposition out;
+
+    out.family("internetmonitoring_samples_written_total", "counter", "Monitor samples committed by this process.");
+    out.sample("internetmonitoring_samples_written_total", database.samplesWritten());
+
+    const DatabaseManager::WriteBehindStats queue = database.writeBehindStats();
+    out.family("internetmonitoring_write_behind_rows_total", "counter", "Rows handled by the write-behind queue.");
+    out.sample("internetmonitoring_write_behind_rows_total", queue.committed, label("result", "committed"));
+    out.sample("internetmonitoring_write_behind_rows_total", queue.failed, label("result", "failed"));
+    out.sample("internetmonitoring_write_behind_rows_total", queue.dropped, label("result", "dropped"));
+    out.family("internetmonitoring_write_behind_transactions_total", "counter", "Write-behind transactions committed.");
+    out.sample("internetmonitoring_write_behind_transactions_total", queue.transactions);
+    out.family("internetmonitoring_write_behind_pending", "gauge", "Rows waiting in the write-behind queue.");
+    out.sample("internetmonitoring_write_behind_pending", quint64(qMax(0, queue.pending)));
+
+    const DatabaseManager::LogStats logs = database.logStats();
+    out.family("internetmonitoring_log_entries_total", "counter", "System log entries handled by the log writer.");
+    out.sample("internetmonitoring_log_entries_total", logs.written, label("result", "written"));
+    out.sample("internetmonitoring_log_entries_total", logs.failed, label("result", "failed"));
+    out.sample("internetmonitoring_log_entries_total", logs.dropped, label("result", "dropped"));
+
+    if (database.isConnected()) {
+        {
+            QMutexLocker locker(&rowCountMutex);
+            refreshRowCounts();
+            out.family("internetmonitoring_table_rows", "gauge", "Rows per table (cached for up to a minute).");
+            QStringList tables = rowCounts.keys() + sealedRowCounts.keys();
+            tables.sort();
+            for (const QString& table : tables) {
+                out.sample("internetmonitoring_table_rows",
+                           quint64(rowCounts.value(table, sealedRowCounts.value(table))), label("table", table));
+            }
+        }
+
+        const QString path = database.databasePath();
+        out.family("internetmonitoring_database_file_bytes", "gauge", "Size of the SQLite database and WAL files.");
+        out.sample("internetmonitoring_database_file_bytes", quint64(QFileInfo(path).size()), label("file", "db"));
+        out.sample("internetmonitoring_database_file_bytes", quint64(QFileInfo(path + "-wal").size()), label("file", "wal"));
+
+        const DatabaseManager::CheckpointStats checkpoints = database.checkpointStats();
+        out.family("internetmonitoring_wal_checkpoints_total", "counter", "WAL checkpoints run by the checkpoint thread.");
+        out.sample("internetmonitoring_wal_checkpoints_total", checkpoints.passive, label("mode", "passive"));
+        out.sample("internetmonitoring_wal_checkpoints_total", checkpoints.truncate, label("mode", "truncate"));
+        out.family("internetmonitoring_wal_checkpoints_busy_total", "counter", "Checkpoints that could not complete because of readers or writers.");
+        out.sample("internetmonitoring_wal_checkpoints_busy_total", checkpoints.busy);
+    }
+
+    const QVector<QueryStatsEntry> queries = QueryStats::global().snapshot(latencyBoundsMicros);
+    out.family("internetmonitoring_query_duration_seconds", "histogram", "Query execution time per statement template.");
+    for (const QueryStatsEntry& entry : queries) {
+        out.histogram("internetmonitoring_query_duration_seconds", entry.buckets, entry.bucketTotal,
+                      quint64(entry.totalMs * 1000), label("statement", entry.statement));
+    }
+    out.family("internetmonitoring_query_errors_total", "counter", "Failed executions per statement template.");
+    for (const QueryStatsEntry& entry : queries) {
+        out.sample("internetmonitoring_query_errors_total", entry.errors, label("statement", entry.statement));
+    }
+    out.family("internetmonitoring_query_rows_total", "counter", "Rows returned or affected per statement template.");
+    for (const QueryStatsEntry& entry : queries) {
+        out.sample("internetmonitoring_query_rows_total", entry.rows, label("statement", entry.statement));
+    }
+    out.family("internetmonitoring_query_decoded_bytes_total", "counter", "Result bytes decoded per statement template.");
+    for (const QueryStatsEntry& entry : queries) {
+        out.sample("internetmonitoring_query_decoded_bytes_total", entry.bytes, label("statement", entry.statement));
+    }
+
+    const StatementCache::Stats statements = StatementCache::stats();
+    out.family("internetmonitoring_statement_cache_total", "counter", "Prepared statement cache lookups and evictions.");
+    out.sample("internetmonitoring_statement_cache_total", statements.hits, label("result", "hit"));
+    out.sample("internetmonitoring_statement_cache_total", statements.misses, label("result", "miss"));
+    out.sample("internetmonitoring_statement_cache_total", statements.evictions, label("result", "eviction"));
+
+    const DatabaseManager::AlarmStats alarms = database.alarmStats();
+    out.family("internetmonitoring_alarm_rules", "gauge", "Compiled alarm rules.");
+    out.sample("internetmonitoring_alarm_rules", quint64(alarms.rules));
+    out.family("internetmonitoring_alarm_samples_evaluated_total", "counter", "Samples checked against alarm rules.");
+    out.sample("internetmonitoring_alarm_samples_evaluated_total", alarms.samples);
+    out.family("internetmonitoring_alarm_rule_evaluations_total", "counter", "Alarm rule condition evaluations.");
+    out.sample("internetmonitoring_alarm_rule_evaluations_total", alarms.evaluations);
+    out.family("internetmonitoring_alarms_raised_total", "counter", "Alarms raised by the rule engine.");
+    out.sample("internetmonitoring_alarms_raised_total", alarms.raised);
+
+    out.family("internetmonitoring_active_sessions", "gauge", "Logged-in user sessions in this process.");
+    out.sample("internetmonitoring_active_sessions", quint64(qMax(0, LoginManager::activeSessionCount())));
+
+    out.family("internetmonitoring_ui_frame_seconds", "histogram", "Time spent redrawing realtime charts.");
+    out.histogram("internetmonitoring_ui_frame_seconds", uiFrameTimes());
+    out.family("internetmonitoring_event_loop_lag_seconds", "histogram", "Main thread event loop delay.");
+    out.histogram("internetmonitoring_event_loop_lag_seconds", eventLoopLag);
+
+    const QHash<int, MonitorSample> latest = database.latestSamplesSnapshot();
+    QList<int> devices = latest.keys();
+    std::sort(devices.begin(), devices.end());
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    out.family("internetmonitoring_device_last_seen_age_seconds", "gauge", "Seconds since the newest sample of each device.");
+    for (int device : devices) {
+        out.sample("internetmonitoring_device_last_seen_age_seconds",
+                   number((now - latest.value(device).timestamp) / 1000.0), label("device_id", QString::number(device)));
+    }
+
+    out.family("internetmonitoring_scrape_duration_seconds", "gauge", "Time spent rendering this response.");
+    out.sample("internetmonitoring_scrape_duration_seconds", number(clock.nsecsElapsed() / 1e9));
+    return out.text;
+}
@@ -0,0 +1,140 @@
+#include "performancepage.h"
+#include "databasemanager.h"
+#include <QLabel>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+namespace {
+
+enum Column {
+    StatementColumn, CallsColumn, RateColumn, ErrorsColumn, MeanColumn, P50Column, P90Column, P99Column,
+    MaxColumn, RowsColumn, BytesColumn, ColumnCount
+};
+
+QString formatBytes(quint64 bytes)
+{
+    if (bytes >= 1024ULL * 1024 * 1024) return QString::number(bytes / (1024.0 * 1024 * 1024), 'f', 2) + " GB";
+    if (bytes >= 1024ULL * 1024) return QString::number(bytes / (1024.0 * 1024), 'f', 2) + " MB";
+    if (bytes >= 1024ULL) return QString::number(bytes / 1024.0, 'f', 1) + " KB";
+    return QString::number(bytes) + " B";
+}
+
+QTableWidgetItem* numberItem(const QString& text)
+{
+    QTableWidgetItem* item = new QTableWidgetItem(text);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+} // namespace
+
+PerformancePage::PerformancePage(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    QHBoxLayout* toolbar = new QHBoxLayout;
+    summaryLabel = new QLabel(this);
+    toolbar->addWidget(summaryLabel, 1);
+    toolbar->addWidget(new QLabel("慢查询阈值", this));
+    thresholdSpinBox = new QSpinBox(this);
+    thresholdSpinBox->setRange(0, 60000);
+    thresholdSpinBox->setSuffix(" ms");
+    thresholdSpinBox->setSpecialValueText("关闭");
+    thresholdSpinBox->setValue(DatabaseManager::instance().slowQueryThreshold());
+    toolbar->addWidget(thresholdSpinBox);
+    QPushButton* resetButton = new QPushButton("清零", this);
+    toolbar->addWidget(resetButton);
+    layout->addLayout(toolbar);
+
+    table = new QTableWidget(0, ColumnCount, this);
+    table->setHorizontalHeaderLabels(QStringList() << "语句" << "次数" << "次/秒" << "错误" << "平均(ms)"
+                                     << "P50(ms)" << "P90(ms)" << "P99(ms)" << "最大(ms)" << "行数" << "解码字节");
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setWordWrap(false);
+    table->verticalHeader()->setVisible(false);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->horizontalHeader()->setSectionResizeMode(StatementColumn, QHeaderView::Stretch);
+    layout->addWidget(table);
+
+    connect(thresholdSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), [](int ms) {
+        DatabaseManager::instance().setSlowQueryThreshold(ms);
+    });
+    connect(resetButton, &QPushButton::clicked, this, &PerformancePage::onResetClicked);
+    refreshTimer.setInterval(1000);
+    connect(&refreshTimer, &QTimer::timeout, this, &PerformancePage::refresh);
+}
+
+void PerformancePage::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer.start();
+}
+
+void PerformancePage::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    refreshTimer.stop();
+    // 隐藏期间不计算每秒次数
+    sinceLastRefresh.invalidate();
+    lastCalls.clear();
+}
+
+void PerformancePage::onResetClicked()
+{
+    DatabaseManager::instance().resetQueryStatistics();
+    lastCalls.clear();
+    refresh();
+}
+
+void PerformancePage::refresh()
+{
+    DatabaseManager& database = DatabaseManager::instance();
+    const QVector<QueryStatsEntry> entries = database.queryStatistics();
+    // 第一次刷新或清零后没有上一次的计数，不显示每秒次数
+    const double seconds = sinceLastRefresh.isValid() ? sinceLastRefresh.restart() / 1000.0 : 0;
+    if (!sinceLastRefresh.isValid()) sinceLastRefresh.start();
+
+    QHash<QString, quint64> calls;
+    quint64 totalCalls = 0;
+    double totalRate = 0;
+    table->setUpdatesEnabled(false);
+    table->setRowCount(entries.size());
+    for (int row = 0; row < entries.size(); ++row) {
+        const QueryStatsEntry& entry = entries.at(row);
+        calls.insert(entry.statement, entry.calls);
+        totalCalls += entry.calls;
+        double rate = -1;
+        const auto previous = lastCalls.constFind(entry.statement);
+        if (seconds > 0 && previous != lastCalls.constEnd() && entry.calls >= previous.value()) {
+            rate = (entry.calls - previous.value()) / seconds;
+            totalRate += rate;
+        }
+
+        QTableWidgetItem* statement = new QTableWidgetItem(entry.statement);
+        statement->setToolTip(entry.statement);
+        table->setItem(row, StatementColumn, statement);
+        table->setItem(row, CallsColumn, numberItem(QString::number(entry.calls)));
+        table->setItem(row, RateColumn, numberItem(rate < 0 ? QString("-") : QString::number(rate, 'f', 1)));
+        table->setItem(row, ErrorsColumn, numberItem(QString::number(entry.errors)));
+        table->setItem(row, MeanColumn, numberItem(QString::number(entry.totalMs / entry.calls, 'f', 3)));
+        table->setItem(row, P50Column, numberItem(QString::number(entry.p50Ms, 'f', 3)));
+        table->setItem(row, P90Column, numberItem(QString::number(entry.p90Ms, 'f', 3)));
+        table->setItem(row, P99Column, numberItem(QString::number(entry.p99Ms, 'f', 3)));
+        table->setItem(row, MaxColumn, numberItem(QString::number(entry.maxMs, 'f', 3)));
+        table->setItem(row, RowsColumn, numberItem(QString::number(entry.rows)));
+        table->setItem(row, BytesColumn, numberItem(formatBytes(entry.bytes)));
+    }
+    table->setUpdatesEnabled(true);
+    lastCalls = calls;
+
+    const DatabaseManager::LogStats logs = database.logStats();
+    summaryLabel->setText(QString("%1 条语句，共 %2 次，%3 次/秒；日志已写入 %4 条，丢弃 %5 条")
+                          .arg(entries.size()).arg(totalCalls).arg(totalRate, 0, 'f', 1)
+                          .arg(logs.written).arg(logs.dropped));
+}
@@ -0,0 +1,412 @@
+#include "querystats.h"
+#include "statementcache.h"
+#include <QRegularExpression>
+#include <QDateTime>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+{
+}
+
+int LatencyHistogram::bucketIndex(quint64 micros)
+{
+    if (micros < quint64(SubBuckets)) {
+        return int(micros);
+    }
+    // 最高位以下保留 4 位作为桶内序号
+    const int shift = 63 - int(qCountLeadingZeroBits(micros)) - 4;
+    if (shift > MaxShift) {
+        return BucketCount - 1;
+    }
+    return (shift + 1) * SubBuckets + int((micros >> shift) - SubBuckets);
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SubBuckets) {
+        return quint64(index);
+    }
+    const int shift = index / SubBuckets - 1;
+    const quint64 sub = quint64(index % SubBuckets + SubBuckets);
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(quint64 micros)
+{
+    counts[bucketIndex(micros)].fetchAndAddRelaxed(1);
+    total.fetchAndAddRelaxed(micros);
+}
+
+void LatencyHistogram::reset()
+{
+    for (QAtomicInteger<quint32>& count : counts) {
+        count.storeRelaxed(0);
+    }
+    total.storeRelaxed(0);
+}
+
+quint64 LatencyHistogram::count() const
+{
+    quint64 total = 0;
+    for (const QAtomicInteger<quint32>& count : counts) {
+        total += count.loadRelaxed();
+    }
+    return total;
+}
+
+quint64 LatencyHistogram::percentile(double p) const
+{
+    // 先取一份计数再计算，避免并发记录导致累计值超过总数
+    quint32 snapshot[BucketCount];
+    quint64 total = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        snapshot[i] = counts[i].loadRelaxed();
+        total += snapshot[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const quint64 target = qMax<quint64>(1, quint64(std::ceil(total * qBound(0.0, p, 100.0) / 100)));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += snapshot[i];
+        if (seen >= target) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(BucketCount - 1);
+}
+
+quint64 LatencyHistogram::cumulativeCounts(const QVector<quint64>& boundsMicros, QVector<quint64>& counts) const
+{
+    counts.fill(0, boundsMicros.size());
+    quint64 seen = 0;
+    int bound = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        const quint64 upper = bucketUpperBound(i);
+        while (bound < boundsMicros.size() && boundsMicros.at(bound) < upper) {
+            counts[bound++] = seen;
+        }
+        seen += this->counts[i].loadRelaxed();
+    }
+    while (bound < boundsMicros.size()) {
+        counts[bound++] = seen;
+    }
+    return seen;
+}
+
+QueryStats::QueryStats()
+    : slowThresholdMs(0)
+{
+}
+
+QueryStats::~QueryStats()
+{
+    qDeleteAll(byTemplate);
+}
+
+QueryStats& QueryStats::global()
+{
+    static QueryStats instance;
+    return instance;
+}
+
+QString QueryStats::normalize(const QString& sql)
+{
+    static const QRegularExpression stringLiteral("'(?:[^']|'')*'");
+    static const QRegularExpression partitionSuffix("_p\\d{8}\\b");
+    static const QRegularExpression number("\\b\\d+(?:\\.\\d+)?\\b");
+    static const QRegularExpression placeholderList("\\(\\s*\\?(?:\\s*,\\s*\\?)+\\s*\\)");
+    static const QRegularExpression whitespace("\\s+");
+
+    QString statement = sql;
+    statement.replace(stringLiteral, "?");
+    // 各日分区使用同一个模板
+    statement.replace(partitionSuffix, "_p*");
+    statement.replace(number, "?");
+    statement.replace(placeholderList, "(?, ...)");
+    statement.replace(whitespace, " ");
+    return statement.trimmed();
+}
+
+QueryStats::Counters* QueryStats::counters(const QString& sql)
+{
+    {
+        QReadLocker locker(&lock);
+        Counters* found = byStatement.value(sql);
+        if (found) return found;
+    }
+    const QString statement = normalize(sql);
+    QWriteLocker locker(&lock);
+    Counters*& counters = byTemplate[statement];
+    if (!counters) {
+        counters = new Counters(statement);
+    }
+    // 拼接了字面量的语句各不相同，只缓存前若干条，之后的每次归一化
+    if (byStatement.size() < MaxRawStatements) {
+        byStatement.insert(sql, counters);
+    }
+    return counters;
+}
+
+bool QueryStats::record(Counters* counters, qint64 micros, quint64 rows, quint64 bytes, bool ok)
+{
+    const quint64 elapsed = quint64(qMax<qint64>(0, micros));
+    counters->calls.fetchAndAddRelaxed(1);
+    if (!ok) counters->errors.fetchAndAddRelaxed(1);
+    counters->rows.fetchAndAddRelaxed(rows);
+    counters->bytes.fetchAndAddRelaxed(bytes);
+    counters->totalMicros.fetchAndAddRelaxed(elapsed);
+    quint64 max = counters->maxMicros.loadRelaxed();
+    while (elapsed > max && !counters->maxMicros.testAndSetRelaxed(max, elapsed, max)) {
+    }
+    counters->histogram.record(elapsed);
+
+    const int threshold = slowThresholdMs.loadAcquire();
+    if (!ok || threshold <= 0 || micros < threshold * 1000LL) {
+        return false;
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 last = counters->lastSlowReportMs.loadAcquire();
+    return now - last >= SlowReportIntervalMs && counters->lastSlowReportMs.testAndSetOrdered(last, now);
+}
+
+void QueryStats::reportSlowQuery(const QString& sql, const QVariantList& bindValues, qint64 micros)
+{
+    SlowQueryHandler handler;
+    {
+        QReadLocker locker(&lock);
+        handler = slowHandler;
+    }
+    if (handler) {
+        handler(sql, bindValues, micros);
+    }
+}
+
+QVector<QueryStatsEntry> QueryStats::snapshot(const QVector<quint64>& bucketBoundsMicros) const
+{
+    QVector<QueryStatsEntry> entries;
+    QReadLocker locker(&lock);
+    entries.reserve(byTemplate.size());
+    for (const Counters* counters : byTemplate) {
+        QueryStatsEntry entry;
+        entry.statement = counters->statement;
+        entry.calls = counters->calls.loadRelaxed();
+        if (entry.calls == 0) continue;
+        entry.errors = counters->errors.loadRelaxed();
+        entry.rows = counters->rows.loadRelaxed();
+        entry.bytes = counters->bytes.loadRelaxed();
+        entry.totalMs = counters->totalMicros.loadRelaxed() / 1000.0;
+        entry.maxMs = counters->maxMicros.loadRelaxed() / 1000.0;
+        entry.p50Ms = counters->histogram.percentile(50) / 1000.0;
+        entry.p90Ms = counters->histogram.percentile(90) / 1000.0;
+        entry.p99Ms = counters->histogram.percentile(99) / 1000.0;
+        if (!bucketBoundsMicros.isEmpty()) {
+            entry.bucketTotal = counters->histogram.cumulativeCounts(bucketBoundsMicros, entry.buckets);
+        }
+        entries.append(entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const QueryStatsEntry& a, const QueryStatsEntry& b) {
+        return a.totalMs > b.totalMs;
+    });
+    return entries;
+}
+
+void QueryStats::reset()
+{
+    QReadLocker locker(&lock);
+    for (Counters* counters : byTemplate) {
+        counters->calls.storeRelaxed(0);
+        counters->errors.storeRelaxed(0);
+        counters->rows.storeRelaxed(0);
+        counters->bytes.storeRelaxed(0);
+        counters->totalMicros.storeRelaxed(0);
+        counters->maxMicros.storeRelaxed(0);
+        counters->histogram.reset();
+    }
+}
+
+void QueryStats::setSlowQueryThreshold(int thresholdMs)
+{
+    slowThresholdMs.storeRelease(qMax(0, thresholdMs));
+}
+
+int QueryStats::slowQueryThreshold() const
+{
+    return slowThresholdMs.loadAcquire();
+}
+
+void QueryStats::setSlowQueryHandler(const SlowQueryHandler& handler)
+{
+    QWriteLocker locker(&lock);
+    slowHandler = handler;
+}
+
+namespace {
+
+quint64 decodedBytes(const QVariant& value)
+{
+    switch (value.type()) {
+    case QVariant::Invalid:
+        return 0;
+    case QVariant::String:
+        return quint64(value.toString().size()) * sizeof(QChar);
+    case QVariant::ByteArray:
+        return quint64(value.toByteArray().size());
+    default:
+        return value.isNull() ? 0 : sizeof(qint64);
+    }
+}
+
+} // namespace
+
+InstrumentedQuery::InstrumentedQuery(const QSqlDatabase& db, StatementCache* cache)
+    : QSqlQuery(db), cache(cache), leasedExecuted(false), current(nullptr), elapsedNs(0), bytes(0), rows(0), ok(true)
+{
+}
+
+InstrumentedQuery::~InstrumentedQuery()
+{
+    stop();
+    releaseStatement();
+}
+
+void InstrumentedQuery::releaseStatement()
+{
+    if (leasedSql.isEmpty()) return;
+    // 缓存中的语句只读了一部分结果时仍持有读快照，归还前先结束
+    QSqlQuery::finish();
+    cache->release(leasedSql, leasedExecuted);
+    leasedSql.clear();
+}
+
+void InstrumentedQuery::start(const QString& sql)
+{
+    stop();
+    current = QueryStats::global().counters(sql);
+    currentSql = sql;
+    elapsedNs = 0;
+    bytes = 0;
+    rows = 0;
+    ok = true;
+}
+
+void InstrumentedQuery::stop()
+{
+    if (!current) return;
+    QueryStats::Counters* counters = current;
+    current = nullptr;
+    const qint64 micros = elapsedNs / 1000;
+    if (QueryStats::global().record(counters, micros, rows, bytes, ok)) {
+        QVariantList bindValues;
+        const int count = boundValues().size();
+        for (int i = 0; i < count; ++i) {
+            bindValues << boundValue(i);
+        }
+        QueryStats::global().reportSlowQuery(currentSql, bindValues, micros);
+    }
+}
+
+bool InstrumentedQuery::prepare(const QString& query)
+{
+    stop();
+    releaseStatement();
+    preparedSql = query;
+    if (cache) {
+        // 与缓存共享语句句柄；之后 QSqlQuery::prepare/exec(sql) 发现句柄被共享时会自动换成新的结果对象
+        const bool forwardOnly = isForwardOnly();
+        if (QSqlQuery* statement = cache->acquire(driver(), query)) {
+            QSqlQuery::operator=(*statement);
+            setForwardOnly(forwardOnly);
+            leasedSql = query;
+            leasedExecuted = false;
+            return true;
+        }
+    }
+    return QSqlQuery::prepare(query);
+}
+
+bool InstrumentedQuery::exec(const QString& query)
+{
+    stop();
+    releaseStatement();
+    preparedSql = query;
+    start(query);
+    QElapsedTimer timer;
+    timer.start();
+    ok = QSqlQuery::exec(query);
+    elapsedNs += timer.nsecsElapsed();
+    if (ok && !isSelect()) {
+        rows = quint64(qMax(0, numRowsAffected()));
+    }
+    return ok;
+}
+
+bool InstrumentedQuery::exec()
+{
+    start(preparedSql);
+    leasedExecuted = true;
+    QElapsedTimer timer;
+    timer.start();
+    ok = QSqlQuery::exec();
+    elapsedNs += timer.nsecsElapsed();
+    if (ok && !isSelect()) {
+        rows = quint64(qMax(0, numRowsAffected()));
+    }
+    return ok;
+}
+
+bool InstrumentedQuery::execBatch(BatchExecutionMode mode)
+{
+    start(preparedSql);
+    leasedExecuted = true;
+    const QVariant first = boundValue(0);
+    QElapsedTimer timer;
+    timer.start();
+    ok = QSqlQuery::execBatch(mode);
+    elapsedNs += timer.nsecsElapsed();
+    if (ok) {
+        rows = quint64(first.toList().size());
+    }
+    // 批量执行没有结果集，立即计入
+    stop();
+    return ok;
+}
+
+bool InstrumentedQuery::next()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const bool hasRow = QSqlQuery::next();
+    elapsedNs += timer.nsecsElapsed();
+    if (hasRow) {
+        ++rows;
+    } else {
+        stop();
+    }
+    return hasRow;
+}
+
+QVariant InstrumentedQuery::value(int index) const
+{
+    const QVariant result = QSqlQuery::value(index);
+    if (current) bytes += decodedBytes(result);
+    return result;
+}
+
+QVariant InstrumentedQuery::value(const QString& name) const
+{
+    const QVariant result = QSqlQuery::value(name);
+    if (current) bytes += decodedBytes(result);
+    return result;
+}
+
+void InstrumentedQuery::finish()
+{
+    stop();
+    QSqlQuery::finish();
+}
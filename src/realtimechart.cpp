@@ -0,0 +1,160 @@
+#include "realtimechart.h"
+#include "metricsserver.h"
+#include <QtCharts/QDateTimeAxis>
+#include <QtCharts/QValueAxis>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+RingSeries::RingSeries(int capacity)
+    : ring(qMax(1, capacity)), head(0), count(0), appended(0)
+{
+}
+
+void RingSeries::append(const QPointF& point)
+{
+    const quint64 seq = appended++;
+    const int capacity = ring.size();
+    if (count == capacity) {
+        ring[head] = point;
+        head = (head + 1) % capacity;
+    } else {
+        ring[(head + count) % capacity] = point;
+        ++count;
+    }
+
+    // 移出窗口的点
+    const quint64 oldestSeq = appended - static_cast<quint64>(count);
+    while (!minQueue.empty() && minQueue.front().first < oldestSeq) minQueue.pop_front();
+    while (!maxQueue.empty() && maxQueue.front().first < oldestSeq) maxQueue.pop_front();
+
+    // 被新点支配的旧点不可能再成为最小/最大值
+    const double value = point.y();
+    while (!minQueue.empty() && minQueue.back().second >= value) minQueue.pop_back();
+    while (!maxQueue.empty() && maxQueue.back().second <= value) maxQueue.pop_back();
+    minQueue.emplace_back(seq, value);
+    maxQueue.emplace_back(seq, value);
+}
+
+void RingSeries::clear()
+{
+    head = 0;
+    count = 0;
+    minQueue.clear();
+    maxQueue.clear();
+}
+
+void RingSeries::copyTo(QVector<QPointF>& out) const
+{
+    out.resize(count);
+    const int capacity = ring.size();
+    for (int i = 0; i < count; ++i) {
+        out[i] = ring.at((head + i) % capacity);
+    }
+}
+
+RealtimeChart::RealtimeChart(const QString& title, const QStringList& seriesNames, int capacity,
+                             int refreshIntervalMs, QWidget *parent)
+    : QChartView(parent), buffers(seriesNames.size(), RingSeries(capacity)), dirty(false)
+{
+    QChart *chart = new QChart();
+    chart->setTitle(title);
+    setChart(chart);
+
+    QDateTimeAxis *axisX = new QDateTimeAxis;
+    axisX->setTickCount(10);
+    axisX->setFormat("hh:mm:ss");
+    chart->addAxis(axisX, Qt::AlignBottom);
+    QValueAxis *axisY = new QValueAxis;
+    axisY->setLabelFormat("%f");
+    chart->addAxis(axisY, Qt::AlignLeft);
+
+    for (const QString& name : seriesNames) {
+        QLineSeries *line = new QLineSeries();
+        line->setName(name);
+        // 大量点时由 GPU 绘制
+        line->setUseOpenGL(true);
+        chart->addSeries(line);
+        line->attachAxis(axisX);
+        line->attachAxis(axisY);
+        series.append(line);
+    }
+
+    refreshTimer.setInterval(refreshIntervalMs);
+    connect(&refreshTimer, &QTimer::timeout, this, &RealtimeChart::refresh);
+}
+
+void RealtimeChart::showEvent(QShowEvent *event)
+{
+    QChartView::showEvent(event);
+    refreshTimer.start();
+}
+
+void RealtimeChart::hideEvent(QHideEvent *event)
+{
+    QChartView::hideEvent(event);
+    // 不可见时只缓存数据，不重绘
+    refreshTimer.stop();
+}
+
+void RealtimeChart::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer clock;
+    clock.start();
+    QChartView::paintEvent(event);
+    MetricsServer::uiFrameTimes().record(quint64(clock.nsecsElapsed() / 1000));
+}
+
+void RealtimeChart::append(qint64 timestamp, const QVector<double>& values)
+{
+    const int n = qMin(values.size(), buffers.size());
+    for (int i = 0; i < n; ++i) {
+        buffers[i].append(QPointF(timestamp, values.at(i)));
+    }
+    dirty = true;
+}
+
+void RealtimeChart::clear()
+{
+    for (int i = 0; i < buffers.size(); ++i) {
+        buffers[i].clear();
+        series.at(i)->clear();
+    }
+    dirty = false;
+}
+
+void RealtimeChart::refresh()
+{
+    if (!dirty) return;
+    dirty = false;
+
+    bool hasRange = false;
+    qint64 first = 0, last = 0;
+    double minVal = 0, maxVal = 0;
+    for (int i = 0; i < buffers.size(); ++i) {
+        const RingSeries& buffer = buffers.at(i);
+        // 一次性替换，整帧只触发一次重绘
+        buffer.copyTo(scratch);
+        series.at(i)->replace(scratch);
+        if (buffer.isEmpty()) continue;
+
+        const qint64 oldest = static_cast<qint64>(buffer.oldest().x());
+        const qint64 newest = static_cast<qint64>(buffer.newest().x());
+        if (!hasRange) {
+            first = oldest;
+            last = newest;
+            minVal = buffer.minimum();
+            maxVal = buffer.maximum();
+            hasRange = true;
+        } else {
+            first = qMin(first, oldest);
+            last = qMax(last, newest);
+            minVal = qMin(minVal, buffer.minimum());
+            maxVal = qMax(maxVal, buffer.maximum());
+        }
+    }
+    if (!hasRange) return;
+
+    chart()->axes(Qt::Horizontal).first()->setRange(QDateTime::fromMSecsSinceEpoch(first),
+                                                    QDateTime::fromMSecsSinceEpoch(last));
+    chart()->axes(Qt::Vertical).first()->setRange(minVal - 10, maxVal + 10);
+}
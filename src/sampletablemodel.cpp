@@ -0,0 +1,130 @@
+#include "sampletablemodel.h"
+
+SampleTableModel::SampleTableModel(QObject *parent)
+    : QAbstractTableModel(parent), device_id(-1), startMs(0), cursorMs(0), cursorTies(0), atEnd(true),
+      fetching(false)
+{
+}
+
+void SampleTableModel::setRange(int device_id, const QDateTime& startTime, const QDateTime& endTime)
+{
+    beginResetModel();
+    this->device_id = device_id;
+    startMs = startTime.toMSecsSinceEpoch();
+    cursorMs = endTime.toMSecsSinceEpoch();
+    cursorTies = 0;
+    atEnd = device_id < 0 || startMs > cursorMs;
+    fetching = false;
+    generation = queries.next();
+    samples.clear();
+    endResetModel();
+
+    if (!atEnd) {
+        fetchMore(QModelIndex());
+    }
+}
+
+void SampleTableModel::clear()
+{
+    setRange(-1, QDateTime(), QDateTime());
+}
+
+int SampleTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : samples.size();
+}
+
+int SampleTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 4;
+}
+
+QVariant SampleTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= samples.size() || (role != Qt::DisplayRole && role != Qt::UserRole)) {
+        return QVariant();
+    }
+    const MonitorSample& sample = samples.at(index.row());
+    switch (index.column()) {
+    case 0:
+        if (role == Qt::UserRole) return sample.timestamp;
+        return QDateTime::fromMSecsSinceEpoch(sample.timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz");
+    case 1:
+        return sample.temperature;
+    case 2:
+        return sample.humidity;
+    case 3:
+        return sample.light;
+    default:
+        return QVariant();
+    }
+}
+
+QVariant SampleTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const char* const headers[4] = { "时间戳", "温度 (°C)", "湿度 (%)", "光照 (lux)" };
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+    return section >= 0 && section < 4 ? QString(headers[section]) : QVariant();
+}
+
+bool SampleTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !atEnd;
+}
+
+void SampleTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || atEnd || fetching) return;
+    fetching = true;
+
+    // 同一毫秒可能有多条数据：上界取含，跳过上一页已读到的同一时间戳的行
+    const int device = device_id;
+    const qint64 start = startMs;
+    const qint64 cursor = cursorMs;
+    const int ties = cursorTies;
+    AsyncQueryExecutor::instance().submit<Page>(this, generation,
+        [device, start, cursor, ties]() -> Page {
+            Page page;
+            page.samples.reserve(PageSize);
+            int skip = ties;
+            page.ok = DatabaseManager::instance().forEachDeviceSample(device,
+                QDateTime::fromMSecsSinceEpoch(start), QDateTime::fromMSecsSinceEpoch(cursor),
+                [&page, &skip, cursor](const MonitorSample& sample) -> bool {
+                    if (skip > 0 && sample.timestamp == cursor) {
+                        --skip;
+                        return true;
+                    }
+                    page.samples.append(sample);
+                    return page.samples.size() < PageSize;
+                }, Qt::DescendingOrder, 0);
+            return page;
+        },
+        [this](const Page& page) { appendPage(page); });
+}
+
+void SampleTableModel::appendPage(const Page& page)
+{
+    fetching = false;
+    const QVector<MonitorSample>& fetched = page.samples;
+    if (!page.ok || fetched.size() < PageSize) {
+        atEnd = true;
+    }
+    if (fetched.isEmpty()) return;
+
+    const qint64 last = fetched.last().timestamp;
+    int ties = 0;
+    for (int i = fetched.size() - 1; i >= 0 && fetched.at(i).timestamp == last; --i) {
+        ++ties;
+    }
+    cursorTies = (last == cursorMs ? cursorTies : 0) + ties;
+    cursorMs = last;
+
+    beginInsertRows(QModelIndex(), samples.size(), samples.size() + fetched.size() - 1);
+    samples += fetched;
+    endInsertRows();
+}
@@ -0,0 +1,236 @@
+#include "sensorprotocol.h"
+#include <QtEndian>
+#include <cstring>
+#include <cmath>
+#include <climits>
+
+namespace {
+
+// 不依赖 locale 的数值解析（QCoreApplication 会按环境设置 C 库 locale，strtod 可能把逗号当小数点）
+bool parseNumber(const char*& p, const char* end, double& value)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    const char* start = p;
+    double result = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10 + (*p - '0');
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        double scale = 0.1;
+        while (p < end && *p >= '0' && *p <= '9') {
+            result += (*p - '0') * scale;
+            scale *= 0.1;
+            ++p;
+        }
+    }
+    if (p == start || (p == start + 1 && *start == '.')) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExp = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExp = (*p == '-');
+            ++p;
+        }
+        int exponent = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            exponent = qMin(exponent * 10 + (*p - '0'), 400);
+            ++p;
+        }
+        result *= std::pow(10.0, negativeExp ? -exponent : exponent);
+    }
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    value = negative ? -result : result;
+    return true;
+}
+
+bool parseInteger(const char*& p, const char* end, qint64& value, bool allowEmpty)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    const char* start = p;
+    qint64 result = 0;
+    while (p < end && *p >= '0' && *p <= '9' && p - start < 18) {
+        result = result * 10 + (*p - '0');
+        ++p;
+    }
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    if (p == start && !allowEmpty) {
+        return false;
+    }
+    value = result;
+    return true;
+}
+
+bool expectComma(const char*& p, const char* end)
+{
+    if (p < end && *p == ',') {
+        ++p;
+        return true;
+    }
+    return false;
+}
+
+// 返回 1 表示解析出一条，0 表示空行/注释，-1 表示格式错误
+int parseLine(const char* p, const char* end, MonitorSample& sample)
+{
+    if (end > p && end[-1] == '\r') --end;
+    const char* q = p;
+    while (q < end && (*q == ' ' || *q == '\t')) ++q;
+    if (q == end || *q == '#') {
+        return 0;
+    }
+
+    qint64 deviceId = 0, timestamp = 0;
+    if (!parseInteger(p, end, deviceId, false) || !expectComma(p, end)
+        || !parseInteger(p, end, timestamp, true) || !expectComma(p, end)
+        || !parseNumber(p, end, sample.temperature) || !expectComma(p, end)
+        || !parseNumber(p, end, sample.humidity) || !expectComma(p, end)
+        || !parseNumber(p, end, sample.light) || p != end
+        || deviceId <= 0 || deviceId > INT_MAX) {
+        return -1;
+    }
+    sample.device_id = static_cast<int>(deviceId);
+    sample.timestamp = timestamp;
+    return 1;
+}
+
+float readFloat(const char* p)
+{
+    quint32 bits = qFromLittleEndian<quint32>(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void appendFloat(QByteArray& out, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char buf[4];
+    qToLittleEndian<quint32>(bits, buf);
+    out.append(buf, 4);
+}
+
+}
+
+int SensorProtocol::parse(QByteArray& buffer, QVector<MonitorSample>& samples, bool final, int* malformed)
+{
+    const char* data = buffer.constData();
+    const int size = buffer.size();
+    int pos = 0;
+    int parsed = 0;
+    int bad = 0;
+
+    while (pos < size) {
+        if (static_cast<quint8>(data[pos]) == BinaryMagic) {
+            if (size - pos < BinaryHeaderSize) {
+                if (final) { ++bad; pos = size; }
+                break;
+            }
+            const int count = qFromLittleEndian<quint16>(data + pos + 2);
+            if (static_cast<quint8>(data[pos + 1]) != BinaryVersion || count == 0 || count > MaxBinaryRecords) {
+                // 帧头错误时无法重新定位帧边界，丢弃缓冲区中剩余的数据
+                ++bad;
+                pos = size;
+                break;
+            }
+            const int frameSize = BinaryHeaderSize + count * BinaryRecordSize;
+            if (size - pos < frameSize) {
+                if (final) { ++bad; pos = size; }
+                break;
+            }
+            const char* record = data + pos + BinaryHeaderSize;
+            for (int i = 0; i < count; ++i, record += BinaryRecordSize) {
+                MonitorSample sample;
+                sample.device_id = static_cast<int>(qFromLittleEndian<quint32>(record));
+                sample.timestamp = qFromLittleEndian<qint64>(record + 4);
+                sample.temperature = readFloat(record + 12);
+                sample.humidity = readFloat(record + 16);
+                sample.light = readFloat(record + 20);
+                if (sample.device_id <= 0 || sample.timestamp < 0) {
+                    ++bad;
+                    continue;
+                }
+                samples.append(sample);
+                ++parsed;
+            }
+            pos += frameSize;
+            continue;
+        }
+
+        const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        int lineEnd;
+        if (newline) {
+            lineEnd = static_cast<int>(newline - data);
+        } else if (final) {
+            lineEnd = size;
+        } else {
+            // 等待剩余部分；超长且没有换行的数据视为垃圾丢弃
+            if (size - pos > MaxLineLength) {
+                ++bad;
+                pos = size;
+            }
+            break;
+        }
+
+        MonitorSample sample;
+        const int result = parseLine(data + pos, data + lineEnd, sample);
+        if (result > 0) {
+            samples.append(sample);
+            ++parsed;
+        } else if (result < 0) {
+            ++bad;
+        }
+        pos = lineEnd + 1;
+    }
+
+    buffer.remove(0, qMin(pos, size));
+    if (malformed) *malformed += bad;
+    return parsed;
+}
+
+void SensorProtocol::appendLine(QByteArray& out, const MonitorSample& sample)
+{
+    out.append(QByteArray::number(sample.device_id));
+    out.append(',');
+    out.append(QByteArray::number(sample.timestamp));
+    out.append(',');
+    out.append(QByteArray::number(sample.temperature, 'f', 2));
+    out.append(',');
+    out.append(QByteArray::number(sample.humidity, 'f', 2));
+    out.append(',');
+    out.append(QByteArray::number(sample.light, 'f', 1));
+    out.append('\n');
+}
+
+void SensorProtocol::appendBinary(QByteArray& out, const MonitorSample* samples, int count)
+{
+    while (count > 0) {
+        const int n = qMin(count, MaxBinaryRecords);
+        char header[BinaryHeaderSize];
+        header[0] = static_cast<char>(BinaryMagic);
+        header[1] = static_cast<char>(BinaryVersion);
+        qToLittleEndian<quint16>(static_cast<quint16>(n), header + 2);
+        out.append(header, BinaryHeaderSize);
+        for (int i = 0; i < n; ++i) {
+            const MonitorSample& sample = samples[i];
+            char buf[12];
+            qToLittleEndian<quint32>(static_cast<quint32>(sample.device_id), buf);
+            qToLittleEndian<qint64>(sample.timestamp, buf + 4);
+            out.append(buf, 12);
+            appendFloat(out, static_cast<float>(sample.temperature));
+            appendFloat(out, static_cast<float>(sample.humidity));
+            appendFloat(out, static_cast<float>(sample.light));
+        }
+        samples += n;
+        count -= n;
+    }
+}
@@ -0,0 +1,98 @@
+#include "statementcache.h"
+
+QAtomicInt StatementCache::sharedCapacity(StatementCache::DefaultCapacity);
+QAtomicInteger<quint64> StatementCache::hitCount;
+QAtomicInteger<quint64> StatementCache::missCount;
+QAtomicInteger<quint64> StatementCache::evictionCount;
+
+StatementCache::StatementCache()
+{
+}
+
+StatementCache::~StatementCache()
+{
+    clear();
+}
+
+QSqlQuery* StatementCache::acquire(const QSqlDriver* driver, const QString& sql)
+{
+    const int limit = capacity();
+    if (limit <= 0) {
+        clear();
+        return nullptr;
+    }
+    auto found = index.constFind(sql);
+    if (found != index.constEnd()) {
+        EntryList::iterator entry = found.value();
+        if (entry->inUse) {
+            return nullptr;
+        }
+        // splice 不会使迭代器失效
+        entries.splice(entries.begin(), entries, entry);
+        entry->inUse = true;
+        hitCount.fetchAndAddRelaxed(1);
+        return &entry->query;
+    }
+
+    QSqlQuery query(driver->createResult());
+    if (!query.prepare(sql)) {
+        return nullptr;
+    }
+    missCount.fetchAndAddRelaxed(1);
+    evict(limit - 1);
+    Entry entry = { sql, query, true };
+    entries.push_front(entry);
+    index.insert(sql, entries.begin());
+    return &entries.front().query;
+}
+
+void StatementCache::release(const QString& sql, bool reusable)
+{
+    // 使用期间被 clear() 移除的语句不再归还
+    auto found = index.find(sql);
+    if (found == index.end()) return;
+    if (reusable) {
+        found.value()->inUse = false;
+    } else {
+        entries.erase(found.value());
+        index.erase(found);
+    }
+}
+
+void StatementCache::clear()
+{
+    entries.clear();
+    index.clear();
+}
+
+void StatementCache::evict(int limit)
+{
+    // 从最久未用的一端开始，跳过正在使用的语句
+    auto it = entries.end();
+    while (int(entries.size()) > limit && it != entries.begin()) {
+        --it;
+        if (it->inUse) continue;
+        index.remove(it->sql);
+        it = entries.erase(it);
+        evictionCount.fetchAndAddRelaxed(1);
+    }
+}
+
+void StatementCache::setCapacity(int capacity)
+{
+    sharedCapacity.storeRelease(qMax(0, capacity));
+}
+
+int StatementCache::capacity()
+{
+    return sharedCapacity.loadAcquire();
+}
+
+StatementCache::Stats StatementCache::stats()
+{
+    Stats stats;
+    stats.hits = hitCount.loadRelaxed();
+    stats.misses = missCount.loadRelaxed();
+    stats.evictions = evictionCount.loadRelaxed();
+    return stats;
+}
@@ -0,0 +1,161 @@
+#include "writebehindqueue.h"
+#include <QMutexLocker>
+
+WriteBehindQueue::WriteBehindQueue(const CommitFunction& commit, int maxRows, int maxDelayMs,
+                                   int maxPending, QObject *parent)
+    : QThread(parent), commit(commit), maxRows(qMax(1, maxRows)), maxDelayMs(qMax(1, maxDelayMs)),
+      maxPending(maxPending), head(&stub), tail(&stub), pending(0), stopping(0),
+      committed(0), failed(0), dropped(0), transactions(0)
+{
+    stub.next.storeRelease(nullptr);
+    clock.start();
+}
+
+WriteBehindQueue::~WriteBehindQueue()
+{
+    stop();
+    // 写线程已退出，释放可能残留的节点
+    while (Node *node = pop()) {
+        delete node;
+    }
+}
+
+bool WriteBehindQueue::enqueue(const PendingWrite& write)
+{
+    const bool barrier = (write.kind == PendingWrite::Barrier);
+    const int count = pending.fetchAndAddOrdered(1) + 1;
+    if (!barrier && maxPending > 0 && count > maxPending) {
+        pending.fetchAndAddOrdered(-1);
+        dropped.fetchAndAddOrdered(1);
+        return false;
+    }
+    Node *node = new Node;
+    node->write = write;
+    node->enqueuedMs = clock.elapsed();
+    push(node);
+    // 只在需要立即提交时唤醒写线程；其余情况写线程最多等待 maxDelayMs 就会取出，
+    // 取出后按入队时刻只再等剩余的时间，一条写入的延迟不超过 maxDelayMs
+    if (barrier || count == maxRows) {
+        wake();
+    }
+    return true;
+}
+
+bool WriteBehindQueue::flush(int timeoutMs)
+{
+    if (QThread::currentThread() == this || !isRunning()) {
+        return true;
+    }
+    PendingWrite barrier;
+    barrier.kind = PendingWrite::Barrier;
+    barrier.done = QSharedPointer<QSemaphore>(new QSemaphore(0));
+    QSharedPointer<QSemaphore> done = barrier.done;
+    enqueue(barrier);
+    return done->tryAcquire(1, timeoutMs);
+}
+
+void WriteBehindQueue::stop()
+{
+    stopping.storeRelease(1);
+    wake();
+    wait();
+}
+
+void WriteBehindQueue::wake()
+{
+    QMutexLocker locker(&wakeMutex);
+    wakeup.wakeOne();
+}
+
+void WriteBehindQueue::push(Node *node)
+{
+    node->next.storeRelease(nullptr);
+    Node *prev = head.fetchAndStoreOrdered(node);
+    prev->next.storeRelease(node);
+}
+
+WriteBehindQueue::Node *WriteBehindQueue::pop()
+{
+    Node *first = tail;
+    Node *next = first->next.loadAcquire();
+    if (first == &stub) {
+        if (!next) return nullptr;
+        tail = next;
+        first = next;
+        next = next->next.loadAcquire();
+    }
+    if (next) {
+        tail = next;
+        return first;
+    }
+    // 生产者已交换 head 但尚未链接 next，稍后再取
+    if (first != head.loadAcquire()) {
+        return nullptr;
+    }
+    push(&stub);
+    next = first->next.loadAcquire();
+    if (next) {
+        tail = next;
+        return first;
+    }
+    return nullptr;
+}
+
+void WriteBehindQueue::commitBatch(QVector<PendingWrite>& batch, QVector<QSharedPointer<QSemaphore>>& barriers)
+{
+    if (!batch.isEmpty()) {
+        const int failedRows = commit(batch);
+        committed.fetchAndAddOrdered(batch.size() - failedRows);
+        failed.fetchAndAddOrdered(failedRows);
+        transactions.fetchAndAddOrdered(1);
+        batch.clear();
+    }
+    for (const QSharedPointer<QSemaphore>& done : barriers) {
+        done->release();
+    }
+    barriers.clear();
+}
+
+void WriteBehindQueue::run()
+{
+    QVector<PendingWrite> batch;
+    QVector<QSharedPointer<QSemaphore>> barriers;
+    qint64 batchStartMs = 0;   // 当前批次最早一条的入队时刻
+    batch.reserve(maxRows);
+
+    forever {
+        Node *node = pop();
+        if (node) {
+            pending.fetchAndAddOrdered(-1);
+            if (node->write.kind == PendingWrite::Barrier) {
+                barriers.append(node->write.done);
+                // 屏障之前的写入立即提交
+                commitBatch(batch, barriers);
+            } else {
+                if (batch.isEmpty()) batchStartMs = node->enqueuedMs;
+                batch.append(node->write);
+                if (batch.size() >= maxRows) {
+                    commitBatch(batch, barriers);
+                }
+            }
+            delete node;
+            continue;
+        }
+
+        // 队列暂时为空
+        const bool stopRequested = stopping.loadAcquire();
+        const qint64 batchAge = clock.elapsed() - batchStartMs;
+        if (!batch.isEmpty() && (stopRequested || batchAge >= maxDelayMs)) {
+            commitBatch(batch, barriers);
+            continue;
+        }
+        if (stopRequested) {
+            if (batch.isEmpty() && pending.loadAcquire() == 0) break;
+            yieldCurrentThread();
+            continue;
+        }
+        QMutexLocker locker(&wakeMutex);
+        const int waitMs = batch.isEmpty() ? maxDelayMs : qMax<qint64>(1, maxDelayMs - batchAge);
+        wakeup.wait(&wakeMutex, static_cast<unsigned long>(waitMs));
+    }
+}